@@ -6,15 +6,42 @@
 
 #include <assert.h>
 #include <string>			
+#include <vector>
 #include <limits>			//for Passivating: set ta(s) to infinity when needed
-#include <random>			//for random number generation
 
 #include "../data_structures/message.hpp"
+#include "../data_structures/order.hpp"
+#include "../data_structures/time_conversion.hpp"
 
 using namespace cadmium;
 using namespace std;
 
 
+/***** Sequencing *****/
+//Order whose materials are prepared next, once the current one is done (an order is not interrupted):
+//	fifo: the first received
+//	spt: the shortest processing time, quantity times the expected time of one material of the product
+//	edd: the earliest due date (the orders without one come last)
+//Ties go to the first received.
+enum Sequencing_Policy {SEQUENCE_FIFO, SEQUENCE_SPT, SEQUENCE_EDD};
+
+inline const char* sequencing_policy_name(int policy){
+	static const char* names[] = {"fifo", "spt", "edd"};
+	return (policy >= 0 && policy <= SEQUENCE_EDD) ? names[policy] : "unknown";
+}
+
+//false if the name is not a policy
+inline bool read_sequencing_policy(const string& name, int& policy){
+	for (int p = SEQUENCE_FIFO; p <= SEQUENCE_EDD; p++){
+		if (name == sequencing_policy_name(p)){
+			policy = p;
+			return true;
+		}
+	}
+	return false;
+}
+
+
 /***** (1)Port Definition *****/
 //Define ports as structures
 struct Control_defs{											//Convention: DevsAtomicModel_defs
@@ -25,6 +52,7 @@ struct Control_defs{											//Convention: DevsAtomicModel_defs
 	struct endOut : public out_port<int>{};
 	//Input ports
 	struct startIn  : public in_port<int>{};					//new batch request
+	struct orderIn  : public in_port<Order_t>{};				//new batch request of one product
 	struct loadedIn  : public in_port<Message_t>{};			//other output ports can handle messages of type "Message_t"
 	struct unloadedIn  : public in_port<Message_t>{};	
 };
@@ -37,7 +65,8 @@ template<typename TIME> class Control{								//typename indicates a data type t
 
 //port assignment	
 public:
-	using input_ports = tuple<typename Control_defs::startIn, Control_defs::loadedIn, Control_defs::unloadedIn>;		//typename overwrites the template class
+	using input_ports = tuple<typename Control_defs::startIn, Control_defs::loadedIn, Control_defs::unloadedIn,
+										Control_defs::orderIn>;		//typename overwrites the template class
 	using output_ports= tuple<typename Control_defs::loadOut, Control_defs::prepOut,
 										Control_defs::matPreparedOut, Control_defs::endOut>;
 	
@@ -51,9 +80,22 @@ public:
 		int total_mats;					//total number of materials to be prepared for processing
 		int num_prepared;				//number of materials prepared up until now
 		bool fin;						//whether a material has been prepared
+		Message_t prepared;				//last prepared material, with the timestamps of its hops
+		TIME clock;						//simulated time of the last transition, to timestamp the requests
 //		TIME next_internal;
+		//orders: a startIn batch is an order of product 0 without due date
+		vector<Order_t> orders;			//received and not started yet, in the order received
+		Order_t current;				//order whose materials are being prepared
+		int current_left = 0;			//materials of the current order not prepared yet
+		bool typed = false;				//an orderIn was received (the orders are then shown in the state log)
+		long long orders_done = 0;
+		double flow_time = 0;			//sum over the orders done of the seconds from arrival to the last material prepared
+		double tardiness = 0;			//sum over the orders done of the seconds past their due date
+		long long late = 0;				//orders done after their due date
 	};	
 	state_type state;
+	int sequencing;
+	vector<double> unit_seconds;		//expected seconds per material of each product, for SPT (the last one for the others)
 	
 	
 	/***** (4)Default Constructor *****/
@@ -64,11 +106,20 @@ public:
 		state.total_mats = 0;
 		state.num_prepared = 0;
 		state.fin = false;
+		state.clock = TIME("00:00:00");
+		sequencing = SEQUENCE_FIFO;
+	}
+	
+	//i_unit_seconds: see MCCS_config::unit_seconds_table
+	Control(int i_sequencing, vector<double> i_unit_seconds) : Control(){
+		sequencing = i_sequencing;
+		unit_seconds = i_unit_seconds;
 	}
 	
 	
 	/***** (5)Internal Transition (dint) *****/
 	void internal_transition(){
+		state.clock += time_advance();
 		state.sending = false;
 		state.fin = false;
 	}
@@ -77,22 +128,24 @@ public:
 	/***** (6)External Transition (dext) *****/
 	//declare a bag of messages as inputs
 	void external_transition(TIME e, typename make_message_bags<input_ports>::type mbs){
-		if ((get_messages<typename Control_defs::startIn>(mbs).size() + 
-			get_messages<typename Control_defs::loadedIn>(mbs).size() +
+		//start requests come from outside the cell (e.g. a generator) and may share a bag with the inventory handler
+		//response; they are processed first, so a new batch is counted before checking whether all materials are prepared
+		if ((get_messages<typename Control_defs::loadedIn>(mbs).size() +
 			get_messages<typename Control_defs::unloadedIn>(mbs).size())>1) 
-			assert(false && "C - Only one message is allowed per time unit");
+			assert(false && "C - Only one message from the inventory handler is allowed per time unit");
+		state.clock += e;
 		
 		for(const auto &x : get_messages<typename Control_defs::startIn>(mbs)){
-			state.message = {state.num_prepared+1, false};		//generate a request message
-			
-			if (state.phase == 0){		//check if system state is idle when "start" request arrives
-				state.phase = 1;		//switch to init mode
-				state.total_mats += x;	//new batch request
-				state.sending = true;
-			} else {
-				state.total_mats += x;	//add new batch request amount to the previous ones
-			}
+			Order_t order;
+			order.quantity = x;
+			receive(order);
+		}
+		for(const auto &x : get_messages<typename Control_defs::orderIn>(mbs)){
+			state.typed = true;
+			receive(x);
 		}
+		if (state.phase == 1 && state.current_left == 0) next_order();		//just out of idle: the policy picks the first order
+		state.message.product = state.current.product;
 		for(const auto &x : get_messages<typename Control_defs::loadedIn>(mbs)){
 			if (state.phase == 1){		//check if system state is init when "loaded" request arrives
 				state.message = x;
@@ -112,15 +165,20 @@ public:
 				if (state.message.ready == 1){		//check if the current material has been prepared
 					state.fin = true;		
 					state.num_prepared++;
+					state.prepared = x;
 				} else {
 					assert(false && "C - invalid input from S, material storage cannot be empty while material has not moved yet");
 				}
 				state.sending = true;
+				if (state.current_left > 0 && --state.current_left == 0) order_done();
 				if (state.num_prepared == state.total_mats){
 					state.phase = 0;		//all materials prepared; switch to idle mode
 				} else {
 					state.phase = 1;	//switch to init mode and keep preparing new materials
+					if (state.current_left == 0) next_order();
 					state.message = {state.num_prepared+1, false};	//also generate a new/same(not prepared) material request
+					state.message.product = state.current.product;
+					if (Message_t::stamping) state.message.set_stamp(Message_t::CREATED, time_to_milliseconds(state.clock));
 				}
 			} else {
 				assert(false && "C - unloaded messages only allowed in prep mode");		//input should not be here, ignore input
@@ -129,6 +187,67 @@ public:
 	}
 	
 	
+	//A new batch request; the orders are sequenced when the current one is done
+	void receive(Order_t order){
+		state.message = {state.num_prepared+1, false};		//generate a request message
+		if (Message_t::stamping) state.message.set_stamp(Message_t::CREATED, time_to_milliseconds(state.clock));
+		
+		if (state.phase == 0){		//check if system state is idle when "start" request arrives
+			state.phase = 1;		//switch to init mode
+			state.total_mats += order.quantity;	//new batch request
+			state.sending = true;
+		} else {
+			state.total_mats += order.quantity;	//add new batch request amount to the previous ones
+		}
+		if (order.quantity > 0){
+			order.arrival = time_to_milliseconds(state.clock);
+			state.orders.push_back(order);
+		}
+	}
+	
+	//The current order becomes the one chosen by the sequencing policy among the orders received
+	void next_order(){
+		if (state.orders.empty()) return;
+		size_t best = 0;
+		for (size_t i = 1; i < state.orders.size(); i++){
+			if (sequence_key(state.orders[i]) < sequence_key(state.orders[best])) best = i;
+		}
+		state.current = state.orders[best];
+		state.current_left = state.current.quantity;
+		state.orders.erase(state.orders.begin() + best);
+	}
+	
+	double sequence_key(const Order_t& order) const{
+		if (sequencing == SEQUENCE_SPT){
+			double unit = (order.product >= 0 && order.product < (int)unit_seconds.size()) ? unit_seconds[order.product] :
+				((unit_seconds.empty()) ? 1.0 : unit_seconds.back());
+			return order.quantity*unit;
+		} else if (sequencing == SEQUENCE_EDD){
+			return (order.has_due()) ? order.arrival/1000.0 + order.due : numeric_limits<double>::infinity();
+		}
+		return 0;				//FIFO: the first received wins the ties
+	}
+	
+	//Flow time and tardiness of the current order, whose last material was just prepared
+	void order_done(){
+		double flow = (time_to_milliseconds(state.clock) - state.current.arrival)/1000.0;
+		state.orders_done++;
+		state.flow_time += flow;
+		if (state.current.has_due() && flow > state.current.due){
+			state.tardiness += flow - state.current.due;
+			state.late++;
+		}
+	}
+	
+	double mean_flow_time() const{
+		return (state.orders_done) ? state.flow_time/state.orders_done : 0.0;
+	}
+	
+	double mean_tardiness() const{
+		return (state.orders_done) ? state.tardiness/state.orders_done : 0.0;
+	}
+	
+	
 	/***** (7)Confluent Transition *****/
 	//Use default implementation: call internal first and then external with zero elapsed time
 	void confluence_transition(TIME e, typename make_message_bags<input_ports>::type mbs){
@@ -187,6 +306,10 @@ public:
 		}
 		os << ":\n\tphase: " << current_phase << "   sending: " << i.sending << "   fin: " << i.fin <<
 		"\n\ttotal requests: " << i.total_mats << "   current prepared materials: " << i.num_prepared;
+		if (i.typed){
+			os << "\n\tcurrent order: product " << i.current.product << " (" << i.current_left << " left)   orders waiting: " <<
+				i.orders.size() << "   orders done: " << i.orders_done << "   late: " << i.late;
+		}
 		return os;
 	}
 };
@@ -0,0 +1,185 @@
+#ifndef _DISPATCHER_HPP__
+#define _DISPATCHER_HPP__
+
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+
+#include <assert.h>
+#include <string>
+#include <vector>
+#include <limits>			//for Passivating: set ta(s) to infinity when needed
+
+#include "../data_structures/dispatch_message.hpp"
+#include "../data_structures/time_conversion.hpp"
+
+using namespace cadmium;
+using namespace std;
+
+
+/***** Policies *****/
+//DISPATCH_NONE: no dispatcher, every line replays its own copy of the input (the plant without this model)
+enum Dispatch_Policy {DISPATCH_NONE, DISPATCH_ROUND_ROBIN, DISPATCH_LEAST_WIP, DISPATCH_EARLIEST_COMPLETION};
+
+inline const char* dispatch_policy_name(int policy){
+	static const char* names[] = {"none", "round_robin", "least_wip", "earliest_completion"};
+	return (policy >= 0 && policy <= DISPATCH_EARLIEST_COMPLETION) ? names[policy] : "unknown";
+}
+
+//false if the name is not a policy
+inline bool read_dispatch_policy(const string& name, int& policy){
+	for (int p = DISPATCH_NONE; p <= DISPATCH_EARLIEST_COMPLETION; p++){
+		if (name == dispatch_policy_name(p)){
+			policy = p;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+/***** (1)Port Definition *****/
+//Define ports as structures
+struct Dispatcher_defs{										//Convention: DevsAtomicModel_defs
+	struct startIn : public in_port<int>{};					//batch request for the plant
+	struct feedbackIn : public in_port<Line_Feedback_t>{};	//from the gates of the lines
+	struct startOut : public out_port<Dispatch_t>{};		//to the gates of the lines
+};
+
+
+/***** (2)Model Definition *****/
+//Sends each batch request of the plant to one of its lines, chosen by the policy:
+//	round_robin: the lines in turn, whatever their load (static assignment)
+//	least_wip: the line with the fewest outstanding materials (dispatched and not yet prepared by its last stage);
+//		a line is idle when all the materials dispatched to it have been prepared, whatever the endOut of its last stage
+//	earliest_completion: the line that would finish the batch first, from its outstanding materials, the progress of
+//		the current one and its time per material, learned from the feedback (the prior comes from the plant description)
+//Ties go to the first line at or after the round-robin position, so that idle lines share the work.
+template<typename TIME> class Dispatcher{
+
+//port assignment
+public:
+	using input_ports = tuple<typename Dispatcher_defs::startIn, Dispatcher_defs::feedbackIn>;
+	using output_ports = tuple<typename Dispatcher_defs::startOut>;
+
+
+	/***** (3)State Definition *****/
+	struct state_type{
+		vector<long long> outstanding;		//materials per line
+		vector<long long> started_ms;		//when the material in progress on each line started
+		vector<double> service_ms;			//time per material of each line
+		int next_line;						//round-robin position
+		vector<Dispatch_t> pending;			//dispatches sent at the next internal event
+		long long dispatched;
+		TIME clock;							//simulated time of the last transition
+	};
+	state_type state;
+	int policy;
+
+
+	/***** (4)Constructors *****/
+	Dispatcher(){
+		policy = DISPATCH_ROUND_ROBIN;
+		state.next_line = 0;
+		state.dispatched = 0;
+		state.clock = TIME("00:00:00");
+	}
+
+	//service_seconds: expected time per material of a line, before any has been prepared
+	Dispatcher(int lines, int i_policy, double service_seconds) : Dispatcher(){
+		assert(lines > 0 && "D - a dispatcher needs at least one line");
+		policy = i_policy;
+		state.outstanding.assign(lines, 0);
+		state.started_ms.assign(lines, 0);
+		state.service_ms.assign(lines, service_seconds*1000.0);
+	}
+
+
+	/***** (5)Internal Transition (dint) *****/
+	void internal_transition(){
+		state.clock += time_advance();
+		state.pending.clear();
+	}
+
+
+	/***** (6)External Transition (dext) *****/
+	//the feedback is processed first, so that a material prepared at the time of a request is not counted as outstanding
+	void external_transition(TIME e, typename make_message_bags<input_ports>::type mbs){
+		state.clock += e;
+		long long now = time_to_milliseconds(state.clock);
+		for (const auto& x : get_messages<typename Dispatcher_defs::feedbackIn>(mbs)){
+			assert(x.line >= 0 && x.line < (int)state.outstanding.size() && "D - feedback from an unknown line");
+			//END: the last stage is idle, not necessarily the line. A last stage faster than the ones before it ends
+			//after every material while they still hold work, so only the materials it prepared leave the count.
+			if (x.kind == Line_Feedback_t::PREPARED && state.outstanding[x.line] > 0){
+				state.service_ms[x.line] = 0.8*state.service_ms[x.line] + 0.2*(now - state.started_ms[x.line]);
+				state.started_ms[x.line] = now;
+				state.outstanding[x.line]--;
+			}
+		}
+		for (int x : get_messages<typename Dispatcher_defs::startIn>(mbs)){
+			int line = choose(x, now);
+			if (state.outstanding[line] == 0) state.started_ms[line] = now;
+			state.outstanding[line] += x;
+			state.next_line = (line + 1) % (int)state.outstanding.size();
+			state.pending.push_back({line, x});
+			state.dispatched++;
+		}
+	}
+
+
+	/***** (7)Confluent Transition *****/
+	void confluence_transition(TIME e, typename make_message_bags<input_ports>::type mbs){
+		internal_transition();
+		external_transition(TIME(), move(mbs));
+	}
+
+
+	/***** (8)Output Function (lambda) *****/
+	typename make_message_bags<output_ports>::type output() const{
+		typename make_message_bags<output_ports>::type bags;
+		get_messages<typename Dispatcher_defs::startOut>(bags) = state.pending;
+		return bags;
+	}
+
+
+	/***** (8)Time Advance ta(s) *****/
+	TIME time_advance() const{
+		return (state.pending.empty()) ? numeric_limits<TIME>::infinity() : TIME("00:00:00");
+	}
+
+
+	/***** (8)Output State Log *****/
+	friend ostringstream& operator<< (ostringstream& os, const typename Dispatcher<TIME>::state_type& i){
+		os << ":\n\tdispatched: " << i.dispatched << "   outstanding:";
+		for (long long n : i.outstanding) os << " " << n;
+		return os;
+	}
+
+
+private:
+	//Estimated time at which the line would finish a batch of "amount" materials dispatched now
+	double completion_ms(int line, int amount, long long now) const{
+		double service = state.service_ms[line];
+		if (state.outstanding[line] == 0) return now + amount*service;
+		double remaining = max(0.0, service - (now - state.started_ms[line]));		//of the material in progress
+		return now + remaining + (state.outstanding[line] - 1 + amount)*service;
+	}
+
+	int choose(int amount, long long now) const{
+		int lines = (int)state.outstanding.size();
+		if (policy == DISPATCH_ROUND_ROBIN) return state.next_line;
+		int best = state.next_line;
+		double best_cost = numeric_limits<double>::infinity();
+		for (int k = 0; k < lines; k++){
+			int line = (state.next_line + k) % lines;
+			double cost = (policy == DISPATCH_LEAST_WIP) ? (double)state.outstanding[line] : completion_ms(line, amount, now);
+			if (cost < best_cost){
+				best = line;
+				best_cost = cost;
+			}
+		}
+		return best;
+	}
+};
+
+#endif //_DISPATCHER_HPP__
\ No newline at end of file
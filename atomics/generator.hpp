@@ -0,0 +1,163 @@
+#ifndef _GENERATOR_HPP__
+#define _GENERATOR_HPP__
+
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+
+#include <assert.h>
+#include <string>
+#include <limits>			//for Passivating: set ta(s) to infinity when needed
+
+#include "../data_structures/rng.hpp"
+#include "../data_structures/time_conversion.hpp"
+
+using namespace cadmium;
+using namespace std;
+
+
+/***** Generator configuration *****/
+//Arrival process and batch-size distribution of the generated start requests
+struct Generator_config{
+	int arrival;					//0 = deterministic, 1 = Poisson, 2 = bursty
+	double mean_interarrival;		//seconds between batches (between bursts when bursty)
+	int burst_size;					//bursty only: batches per burst
+	double burst_gap;				//bursty only: seconds between the batches of a burst
+	int batch_distribution;			//0 = uniform in [batch_min, batch_max], 1 = geometric with mean batch_mean
+	int batch_min;
+	int batch_max;
+	double batch_mean;
+	uint64_t seed;
+	long long max_batches;			//stop (passivate) after this many batches, 0 = never
+
+	Generator_config()
+		: arrival(1), mean_interarrival(30.0), burst_size(5), burst_gap(1.0),
+		  batch_distribution(0), batch_min(1), batch_max(5), batch_mean(3.0),
+		  seed(1), max_batches(0){}
+};
+
+
+/***** (1)Port Definition *****/
+//Define ports as structures
+struct Generator_defs{										//Convention: DevsAtomicModel_defs
+	struct startOut : public out_port<int>{};				//batch request, replaces the input reader output
+};
+
+
+/***** (2)Model Definition *****/
+//Generates startIn batches on the fly: constant memory and no file I/O, whatever the horizon
+template<typename TIME> class Generator{
+
+//port assignment
+public:
+	using input_ports = tuple<>;							//no inputs, the generator only produces
+	using output_ports = tuple<typename Generator_defs::startOut>;
+
+
+	/***** (3)State Definition *****/
+	struct state_type{
+		SplitMix64 rng;
+		int next_batch;					//size of the batch sent at the next internal event
+		TIME next_interval;				//time until the next batch
+		int burst_position;				//batches already sent in the current burst
+		long long generated;			//batches sent up until now
+		bool active;					//false once max_batches have been sent
+		TIME clock;						//simulated time of the last transition
+	};
+	state_type state;
+	Generator_config config;
+
+
+	/***** (4)Constructors *****/
+	Generator(){
+		start();
+	}
+
+	Generator(Generator_config i_config) : config(i_config){
+		start();
+	}
+
+
+	/***** (5)Internal Transition (dint) *****/
+	void internal_transition(){
+		state.clock += time_advance();
+		state.generated++;
+		state.burst_position = (state.burst_position + 1) % max(config.burst_size, 1);
+		if (config.max_batches > 0 && state.generated >= config.max_batches){
+			state.active = false;		//all requested batches generated
+		} else {
+			draw_next();
+		}
+	}
+
+
+	/***** (6)External Transition (dext) *****/
+	void external_transition(TIME e, typename make_message_bags<input_ports>::type mbs){
+		assert(false && "G - the generator has no input ports");
+	}
+
+
+	/***** (7)Confluent Transition *****/
+	void confluence_transition(TIME e, typename make_message_bags<input_ports>::type mbs){
+		internal_transition();
+		external_transition(TIME(), move(mbs));
+	}
+
+
+	/***** (8)Output Function (lambda) *****/
+	typename make_message_bags<output_ports>::type output() const{
+		typename make_message_bags<output_ports>::type bags;
+		get_messages<typename Generator_defs::startOut>(bags).push_back(state.next_batch);
+		return bags;
+	}
+
+
+	/***** (8)Time Advance ta(s) *****/
+	TIME time_advance() const{
+		if (state.active){
+			return state.next_interval;
+		}
+		return numeric_limits<TIME>::infinity();		//PASSIVATE the model
+	}
+
+
+	/***** (8)Output State Log *****/
+	friend ostringstream& operator<< (ostringstream& os, const typename Generator<TIME>::state_type& i){
+		os << ":\n\tphase: " << ((i.active) ? "active" : "passive") << "   next batch: " << i.next_batch <<
+		"   batches generated: " << i.generated;
+		return os;
+	}
+
+
+private:
+	void start(){
+		assert((config.batch_distribution != 0 || (config.batch_min >= 1 && config.batch_min <= config.batch_max)) && "G - invalid batch size range");
+		state.rng = SplitMix64(config.seed);
+		state.burst_position = 0;
+		state.generated = 0;
+		state.active = true;
+		state.clock = TIME("00:00:00");
+		draw_next();
+	}
+
+	//Samples the batch sent at the next internal event and the time until it
+	void draw_next(){
+		double interval = 0;
+		if (config.arrival == 0){
+			interval = config.mean_interarrival;
+		} else if (config.arrival == 1){
+			interval = state.rng.exponential(config.mean_interarrival);
+		} else if (config.arrival == 2){
+			interval = (state.burst_position == 0) ? state.rng.exponential(config.mean_interarrival) : config.burst_gap;
+		} else {
+			assert(false && "G - unknown arrival process");
+		}
+		if (config.batch_distribution == 0){
+			state.next_batch = state.rng.uniform_int(config.batch_min, config.batch_max);
+		} else {
+			state.next_batch = state.rng.geometric(config.batch_mean);
+		}
+		state.next_interval = time_from_seconds<TIME>(interval);
+	}
+};
+
+#endif //_GENERATOR_HPP__
\ No newline at end of file
@@ -6,10 +6,12 @@
 
 #include <assert.h>
 #include <string>			
+#include <map>
 #include <limits>			//for Passivating: set ta(s) to infinity when needed
-#include <random>			//for random number generation
 
 #include "../data_structures/message.hpp"
+#include "../data_structures/timing.hpp"			//constant or random processing times
+#include "../data_structures/time_conversion.hpp"
 
 using namespace cadmium;
 using namespace std;
@@ -38,9 +40,13 @@ public:
 		bool sending;
 		bool active;				//phase active or not
 		int index;
+		TIME operation_time;		//moving time of the current material
+		TIME clock;					//simulated time of the last transition, to timestamp the messages
 	};	
 	state_type state;
-	TIME moving_time;
+	TIME moving_time;				//constant moving time
+	Timing moving;					//moving time distribution, used instead of moving_time when stochastic
+	map<int, Timing> product_moving;	//moving time of the products that have their own
 	
 	/***** (4)Default Constructor *****/
 	//must define a default one "without parameters"
@@ -49,11 +55,28 @@ public:
 		state.sending = false;
 		state.active = false;				//initially in passive phase
 		state.index = 0;					//no messages received yet
+		state.operation_time = moving_time;
+		state.clock = TIME("00:00:00");
+	}
+	
+	//moving time (and the RNG stream of this instance) taken from the configuration, see MCCS_config
+	Handling(Timing i_moving) : Handling(){
+		moving = i_moving;
+		if (!moving.stochastic()){
+			moving_time = time_from_seconds<TIME>(moving.a);
+		}
+		state.operation_time = moving_time;
+	}
+	
+	//and the moving times of the products that have their own, see MCCS_config::handling_product_timings
+	Handling(Timing i_moving, map<int, Timing> i_product_moving) : Handling(i_moving){
+		product_moving = i_product_moving;
 	}
 	
 	
 	/***** (5)Internal Transition (dint) *****/
 	void internal_transition(){
+		state.clock += time_advance();
 		if (!state.active){
 			;				//should never be triggered
 		} else {
@@ -70,6 +93,7 @@ public:
 		bag_port_in = get_messages<typename Handling_defs::prepIn>(mbs);	//retrieve input bag, put into "bag_port_in"
 		if(bag_port_in.size()>1) 
 			assert(false && "H - Only one message at a time"); 
+		state.clock += e;
 		
 		if (!state.active){
 			state.index++;
@@ -81,6 +105,14 @@ public:
 			}
 			state.active = true;				//switch to active/move behavior
 			state.sending = true;
+			//draw number index of this instance's stream (of the product's stream if it has its own time)
+			auto product = product_moving.find(state.message.product);
+			if (product != product_moving.end()){
+				state.operation_time = time_from_seconds<TIME>(product->second.sample(state.index));
+			} else {
+				state.operation_time = (moving.stochastic()) ? time_from_seconds<TIME>(moving.sample(state.index)) : moving_time;
+			}
+			if (Message_t::stamping) state.message.set_stamp(Message_t::MOVED, time_to_milliseconds(state.clock + state.operation_time));		//sent once moved
 		} else {
 				assert(false && "H - invalid input while material preparation still in progress");		//input should not be here, ignore input and stay active
 		}
@@ -111,7 +143,7 @@ public:
 		TIME next_internal;
 		
 		if (state.sending){
-			next_internal = moving_time;			//time required (5s) to move one unit of material
+			next_internal = state.operation_time;			//time required (5s by default) to move one unit of material
 		}
 		else {
 			next_internal = numeric_limits<TIME>::infinity();		//PASSIVATE the model
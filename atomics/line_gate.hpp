@@ -0,0 +1,113 @@
+#ifndef _LINE_GATE_HPP__
+#define _LINE_GATE_HPP__
+
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+
+#include <assert.h>
+#include <string>
+#include <vector>
+#include <limits>			//for Passivating: set ta(s) to infinity when needed
+
+#include "../data_structures/dispatch_message.hpp"
+
+using namespace cadmium;
+using namespace std;
+
+
+/***** (1)Port Definition *****/
+//Define ports as structures
+struct Line_Gate_defs{										//Convention: DevsAtomicModel_defs
+	struct dispatchIn : public in_port<Dispatch_t>{};		//from the dispatcher, for any line
+	struct preparedIn : public in_port<int>{};				//matPreparedOut of the last stage of the line
+	struct endIn : public in_port<int>{};					//endOut of the last stage of the line
+	struct startOut : public out_port<int>{};				//startIn of the first stage of the line
+	struct feedbackOut : public out_port<Line_Feedback_t>{};	//to the dispatcher
+};
+
+
+/***** (2)Model Definition *****/
+//Entry and exit of one line behind a dispatcher: forwards the batches dispatched to its line to the first cell, and
+//tags the outputs of the last cell with the line number so that the dispatcher knows the outstanding work of each line.
+template<typename TIME> class Line_Gate{
+
+//port assignment
+public:
+	using input_ports = tuple<typename Line_Gate_defs::dispatchIn, Line_Gate_defs::preparedIn, Line_Gate_defs::endIn>;
+	using output_ports = tuple<typename Line_Gate_defs::startOut, Line_Gate_defs::feedbackOut>;
+
+
+	/***** (3)State Definition *****/
+	struct state_type{
+		vector<int> batches;					//dispatched to this line, forwarded at the next internal event
+		vector<Line_Feedback_t> feedback;		//and the feedback to send
+		TIME clock;								//simulated time of the last transition
+	};
+	state_type state;
+	int line;
+
+
+	/***** (4)Constructors *****/
+	Line_Gate(){
+		line = 0;
+		state.clock = TIME("00:00:00");
+	}
+
+	Line_Gate(int i_line) : Line_Gate(){
+		line = i_line;
+	}
+
+
+	/***** (5)Internal Transition (dint) *****/
+	void internal_transition(){
+		state.clock += time_advance();
+		state.batches.clear();
+		state.feedback.clear();
+	}
+
+
+	/***** (6)External Transition (dext) *****/
+	void external_transition(TIME e, typename make_message_bags<input_ports>::type mbs){
+		state.clock += e;
+		for (const auto& x : get_messages<typename Line_Gate_defs::dispatchIn>(mbs)){
+			if (x.line == line) state.batches.push_back(x.amount);
+		}
+		for (size_t i = 0; i < get_messages<typename Line_Gate_defs::preparedIn>(mbs).size(); i++){
+			state.feedback.push_back({line, Line_Feedback_t::PREPARED});
+		}
+		for (size_t i = 0; i < get_messages<typename Line_Gate_defs::endIn>(mbs).size(); i++){
+			state.feedback.push_back({line, Line_Feedback_t::END});
+		}
+	}
+
+
+	/***** (7)Confluent Transition *****/
+	void confluence_transition(TIME e, typename make_message_bags<input_ports>::type mbs){
+		internal_transition();
+		external_transition(TIME(), move(mbs));
+	}
+
+
+	/***** (8)Output Function (lambda) *****/
+	typename make_message_bags<output_ports>::type output() const{
+		typename make_message_bags<output_ports>::type bags;
+		get_messages<typename Line_Gate_defs::startOut>(bags) = state.batches;
+		get_messages<typename Line_Gate_defs::feedbackOut>(bags) = state.feedback;
+		return bags;
+	}
+
+
+	/***** (8)Time Advance ta(s) *****/
+	TIME time_advance() const{
+		return (state.batches.empty() && state.feedback.empty()) ? numeric_limits<TIME>::infinity() : TIME("00:00:00");
+	}
+
+
+	/***** (8)Output State Log *****/
+	friend ostringstream& operator<< (ostringstream& os, const typename Line_Gate<TIME>::state_type& i){
+		os << ":\n\tbatches to forward: " << i.batches.size() << "   feedback to send: " << i.feedback.size();
+		return os;
+	}
+};
+
+#endif //_LINE_GATE_HPP__
\ No newline at end of file
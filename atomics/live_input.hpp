@@ -0,0 +1,177 @@
+#ifndef _LIVE_INPUT_HPP__
+#define _LIVE_INPUT_HPP__
+
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+
+#include <assert.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <limits>			//for Passivating: set ta(s) to infinity when needed
+
+#include "../data_structures/mpsc_queue.hpp"
+#include "../data_structures/histogram.hpp"
+
+using namespace cadmium;
+using namespace std;
+
+
+/***** Live feed *****/
+//Start requests pushed by ingestion threads (see engine/live_ingestion.hpp), drained by one Live_Input model.
+//The model records, for every request, the wall-clock time from its push to the simulation step that sends it.
+struct Live_Request{
+	int amount;
+	int64_t pushed_ns;				//steady clock
+};
+
+struct Live_Feed{
+	MPSC_Queue<Live_Request> queue;
+	atomic<long long> pushed;
+	atomic<long long> dropped;		//pushed while the queue was full
+	atomic<bool> closed;			//no more requests will be pushed: the model passivates once the queue is empty
+	Latency_Histogram latency_us;	//push -> startOut, written by the simulation thread only
+	long long injected;
+
+	Live_Feed(size_t capacity = 4096) : queue(capacity), pushed(0), dropped(0), closed(false), injected(0){}
+
+	static int64_t now_ns(){
+		return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	//Any thread; false if the request was dropped
+	bool push(int amount){
+		if (!queue.push({amount, now_ns()})){
+			dropped++;
+			return false;
+		}
+		pushed++;
+		return true;
+	}
+
+	void close(){
+		closed.store(true, memory_order_release);
+	}
+};
+
+
+/***** (1)Port Definition *****/
+//Define ports as structures
+struct Live_Input_defs{										//Convention: DevsAtomicModel_defs
+	struct startOut : public out_port<int>{};				//batch request, replaces the input reader output
+};
+
+
+/***** (2)Model Definition *****/
+//Sends the requests of a live feed as startIn batches: every "poll" of simulated time it drains the queue and sends
+//what it found at once, at the current simulated time. Paced by the wall clock (see engine/real_time.hpp), the cell
+//shadows the real one; with a closed feed, the model passivates once everything has been sent.
+template<typename TIME> class Live_Input{
+
+//port assignment
+public:
+	using input_ports = tuple<>;							//no inputs, the feed is filled by other threads
+	using output_ports = tuple<typename Live_Input_defs::startOut>;
+
+
+	/***** (3)State Definition *****/
+	struct state_type{
+		vector<int> amounts;			//requests drained from the queue, sent at the next internal event
+		vector<int64_t> pushed_ns;		//and when they were pushed
+		bool active;					//false once the feed is closed and empty
+		long long polls;
+		TIME clock;						//simulated time of the last transition
+	};
+	state_type state;
+	shared_ptr<Live_Feed> feed;
+	TIME poll;							//simulated time between two looks at the queue
+
+
+	/***** (4)Constructors *****/
+	Live_Input(){
+		state.active = false;
+		state.polls = 0;
+		state.clock = TIME("00:00:00");
+		poll = TIME("00:00:00:100");
+	}
+
+	Live_Input(shared_ptr<Live_Feed> i_feed, TIME i_poll) : Live_Input(){
+		feed = i_feed;
+		poll = i_poll;
+		state.active = (feed != nullptr);
+	}
+
+
+	/***** (5)Internal Transition (dint) *****/
+	void internal_transition(){
+		state.clock += time_advance();
+		if (!state.amounts.empty()){
+			int64_t now = Live_Feed::now_ns();		//just after the step that sent them
+			for (int64_t pushed : state.pushed_ns) feed->latency_us.record((now > pushed) ? (now - pushed)/1000 : 0);
+			feed->injected += state.amounts.size();
+			state.amounts.clear();
+			state.pushed_ns.clear();
+		}
+		drain();
+	}
+
+
+	/***** (6)External Transition (dext) *****/
+	void external_transition(TIME e, typename make_message_bags<input_ports>::type mbs){
+		assert(false && "L - the live input has no input ports");
+	}
+
+
+	/***** (7)Confluent Transition *****/
+	void confluence_transition(TIME e, typename make_message_bags<input_ports>::type mbs){
+		internal_transition();
+		external_transition(TIME(), move(mbs));
+	}
+
+
+	/***** (8)Output Function (lambda) *****/
+	typename make_message_bags<output_ports>::type output() const{
+		typename make_message_bags<output_ports>::type bags;
+		get_messages<typename Live_Input_defs::startOut>(bags) = state.amounts;		//one message per request
+		return bags;
+	}
+
+
+	/***** (8)Time Advance ta(s) *****/
+	TIME time_advance() const{
+		if (!state.amounts.empty()){
+			return TIME("00:00:00");				//send the drained requests now
+		}
+		if (state.active){
+			return poll;
+		}
+		return numeric_limits<TIME>::infinity();		//PASSIVATE the model
+	}
+
+
+	/***** (8)Output State Log *****/
+	friend ostringstream& operator<< (ostringstream& os, const typename Live_Input<TIME>::state_type& i){
+		os << ":\n\tphase: " << ((i.active) ? "active" : "passive") << "   requests to send: " << i.amounts.size() <<
+		"   polls: " << i.polls;
+		return os;
+	}
+
+
+private:
+	//Takes everything pushed so far; the closed flag is read first, so a request pushed before close() is never lost
+	void drain(){
+		state.polls++;
+		bool closed = feed->closed.load(memory_order_acquire);
+		Live_Request request;
+		while (feed->queue.pop(request)){
+			state.amounts.push_back(request.amount);
+			state.pushed_ns.push_back(request.pushed_ns);
+		}
+		state.active = !(closed && state.amounts.empty());
+	}
+};
+
+#endif //_LIVE_INPUT_HPP__
\ No newline at end of file
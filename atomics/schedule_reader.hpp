@@ -0,0 +1,109 @@
+#ifndef _SCHEDULE_READER_HPP__
+#define _SCHEDULE_READER_HPP__
+
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+
+#include <assert.h>
+#include <memory>
+#include <string>
+#include <limits>			//for Passivating: set ta(s) to infinity when needed
+
+#include "../data_structures/input_schedule.hpp"
+
+using namespace cadmium;
+using namespace std;
+
+
+/***** (1)Port Definition *****/
+//Define ports as structures
+template<typename MSG>
+struct Schedule_Reader_defs{								//Convention: DevsAtomicModel_defs
+	struct out : public out_port<MSG>{};					//same role as iestream_input_defs<MSG>::out
+};
+
+
+/***** (2)Model Definition *****/
+//Replays a shared Input_Schedule: same outputs as an iestream_input reading the file, but the file is parsed once
+//for all the readers and the state is only a cursor. Events at the same time are sent in one bag.
+template<typename MSG, typename TIME> class Schedule_Reader{
+
+//port assignment
+public:
+	using input_ports = tuple<>;							//no inputs, the reader only produces
+	using output_ports = tuple<typename Schedule_Reader_defs<MSG>::out>;
+
+
+	/***** (3)State Definition *****/
+	struct state_type{
+		size_t cursor;					//index of the next event to send
+		TIME clock;						//simulated time of the last transition
+	};
+	state_type state;
+	shared_ptr<const Input_Schedule<MSG, TIME>> schedule;		//read only, shared with the other readers
+
+
+	/***** (4)Constructors *****/
+	Schedule_Reader(){
+		state.cursor = 0;
+		state.clock = TIME("00:00:00");
+	}
+
+	Schedule_Reader(shared_ptr<const Input_Schedule<MSG, TIME>> i_schedule) : Schedule_Reader(){
+		schedule = i_schedule;
+	}
+
+	//Starts at time t with the first event at or after t, without going through the earlier ones
+	void seek(const TIME& t){
+		state.cursor = (schedule) ? schedule->seek(t) : 0;
+		state.clock = t;
+	}
+
+
+	/***** (5)Internal Transition (dint) *****/
+	void internal_transition(){
+		state.clock += time_advance();
+		state.cursor = schedule->same_time_end(state.cursor);
+	}
+
+
+	/***** (6)External Transition (dext) *****/
+	void external_transition(TIME e, typename make_message_bags<input_ports>::type mbs){
+		assert(false && "SR - a schedule reader has no input ports");
+	}
+
+
+	/***** (7)Confluent Transition *****/
+	void confluence_transition(TIME e, typename make_message_bags<input_ports>::type mbs){
+		assert(false && "SR - a schedule reader has no input ports");
+	}
+
+
+	/***** (8)Output Function (lambda) *****/
+	typename make_message_bags<output_ports>::type output() const{
+		typename make_message_bags<output_ports>::type bags;
+		size_t end = schedule->same_time_end(state.cursor);
+		for (size_t i = state.cursor; i < end; i++){
+			get_messages<typename Schedule_Reader_defs<MSG>::out>(bags).push_back(schedule->messages[i]);
+		}
+		return bags;
+	}
+
+
+	/***** (8)Time Advance ta(s) *****/
+	TIME time_advance() const{
+		if (!schedule || state.cursor >= schedule->size()){
+			return numeric_limits<TIME>::infinity();		//PASSIVATE the model, all the events were sent
+		}
+		return schedule->times[state.cursor] - state.clock;
+	}
+
+
+	/***** (8)Output State Log *****/
+	friend ostringstream& operator<< (ostringstream& os, const typename Schedule_Reader<MSG, TIME>::state_type& i){
+		os << ":\n\tnext event: " << i.cursor;
+		return os;
+	}
+};
+
+#endif //_SCHEDULE_READER_HPP__
\ No newline at end of file
@@ -6,10 +6,12 @@
 
 #include <assert.h>
 #include <string>			
+#include <map>
 #include <limits>			//for Passivating: set ta(s) to infinity when needed
-#include <random>			//for random number generation
 
 #include "../data_structures/message.hpp"
+#include "../data_structures/timing.hpp"			//constant or random processing times
+#include "../data_structures/time_conversion.hpp"
 
 using namespace cadmium;
 using namespace std;
@@ -44,9 +46,13 @@ public:
 		bool full;				//phase full or not (empty)
 		int load_request_index;			//keep track of the number of load and unload requests received
 		int unload_request_index;
+		TIME operation_time;			//loading time of the current material
+		TIME clock;						//simulated time of the last transition, to timestamp the messages
 	};	
 	state_type state;
-	TIME loading_time;
+	TIME loading_time;					//constant loading time
+	Timing loading;						//loading time distribution, used instead of loading_time when stochastic
+	map<int, Timing> product_loading;	//loading time of the products that have their own
 	
 	
 	/***** (4)Default Constructor *****/
@@ -57,11 +63,28 @@ public:
 		state.full = false;				//initially in empty phase
 		state.load_request_index = 0;				//no messages received yet
 		state.unload_request_index = 0;
+		state.operation_time = loading_time;
+		state.clock = TIME("00:00:00");
+	}
+	
+	//loading time (and the RNG stream of this instance) taken from the configuration, see MCCS_config
+	Storage(Timing i_loading) : Storage(){
+		loading = i_loading;
+		if (!loading.stochastic()){
+			loading_time = time_from_seconds<TIME>(loading.a);
+		}
+		state.operation_time = loading_time;
+	}
+	
+	//and the loading times of the products that have their own, see MCCS_config::storage_product_timings
+	Storage(Timing i_loading, map<int, Timing> i_product_loading) : Storage(i_loading){
+		product_loading = i_product_loading;
 	}
 	
 	
 	/***** (5)Internal Transition (dint) *****/
 	void internal_transition(){
+		state.clock += time_advance();
 		state.sending = false;
 		if (!state.full){
 			state.full = true;
@@ -77,6 +100,7 @@ public:
 		if ((get_messages<typename Storage_defs::loadIn>(mbs).size() + 
 			get_messages<typename Storage_defs::unloadIn>(mbs).size())>1) 
 			assert(false && "S - Only one message is allowed per time unit");
+		state.clock += e;
 		
 		for(const auto &x : get_messages<typename Storage_defs::loadIn>(mbs)){
 			
@@ -85,6 +109,14 @@ public:
 				state.message = x;
 				if (!state.message.ready){		//check whether material has already been moved
 					state.sending = true;
+					//draw number load_request_index of this instance's stream (of the product's stream if it has its own time)
+					auto product = product_loading.find(state.message.product);
+					if (product != product_loading.end()){
+						state.operation_time = time_from_seconds<TIME>(product->second.sample(state.load_request_index));
+					} else {
+						state.operation_time = (loading.stochastic()) ? time_from_seconds<TIME>(loading.sample(state.load_request_index)) : loading_time;
+					}
+					if (Message_t::stamping) state.message.set_stamp(Message_t::LOADED, time_to_milliseconds(state.clock + state.operation_time));	//sent once loaded
 				} else {
 					assert(false && "S - Cannot load an already moved material");
 				}
@@ -99,6 +131,7 @@ public:
 				state.message = x;
 				if (state.message.ready){		//check whether material has already been moved
 					state.sending = true;
+					if (Message_t::stamping) state.message.set_stamp(Message_t::UNLOADED, time_to_milliseconds(state.clock));		//sent immediately
 				} else {
 					assert(false && "S - unload request without moving the material");
 				}
@@ -139,7 +172,7 @@ public:
 		TIME next_internal;
 		
 		if (!state.full && state.sending){
-			next_internal = loading_time; 			//time required (2s) to load one unit of material
+			next_internal = state.operation_time; 			//time required (2s by default) to load one unit of material
 		} else if (state.full && state.sending){
 			next_internal = TIME("00:00:00");			//immediately trigger lambda and dint
 		} else {
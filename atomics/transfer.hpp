@@ -0,0 +1,92 @@
+#ifndef _TRANSFER_HPP__
+#define _TRANSFER_HPP__
+
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+
+#include <assert.h>
+#include <string>
+#include <limits>			//for Passivating: set ta(s) to infinity when needed
+
+using namespace cadmium;
+using namespace std;
+
+
+/***** (1)Port Definition *****/
+//Define ports as structures
+struct Transfer_defs{										//Convention: DevsAtomicModel_defs
+	struct preparedIn : public in_port<int>{};				//matPreparedOut of the upstream Control
+	struct startOut : public out_port<int>{};				//startIn of the downstream Control
+};
+
+
+/***** (2)Model Definition *****/
+//Links two stages of a line: every material prepared upstream becomes a request for one material downstream.
+//matPreparedOut carries the count of prepared materials, not a batch size, so it cannot feed startIn directly.
+template<typename TIME> class Transfer{
+
+//port assignment
+public:
+	using input_ports = tuple<typename Transfer_defs::preparedIn>;
+	using output_ports = tuple<typename Transfer_defs::startOut>;
+
+
+	/***** (3)State Definition *****/
+	struct state_type{
+		int pending;					//materials received and not forwarded yet
+		TIME clock;						//simulated time of the last transition
+	};
+	state_type state;
+
+
+	/***** (4)Default Constructor *****/
+	Transfer(){
+		state.pending = 0;
+		state.clock = TIME("00:00:00");
+	}
+
+
+	/***** (5)Internal Transition (dint) *****/
+	void internal_transition(){
+		state.clock += time_advance();
+		state.pending = 0;
+	}
+
+
+	/***** (6)External Transition (dext) *****/
+	void external_transition(TIME e, typename make_message_bags<input_ports>::type mbs){
+		state.clock += e;
+		state.pending += get_messages<typename Transfer_defs::preparedIn>(mbs).size();
+	}
+
+
+	/***** (7)Confluent Transition *****/
+	void confluence_transition(TIME e, typename make_message_bags<input_ports>::type mbs){
+		internal_transition();
+		external_transition(TIME(), move(mbs));
+	}
+
+
+	/***** (8)Output Function (lambda) *****/
+	//one batch with all the materials received at the same time
+	typename make_message_bags<output_ports>::type output() const{
+		typename make_message_bags<output_ports>::type bags;
+		get_messages<typename Transfer_defs::startOut>(bags).push_back(state.pending);
+		return bags;
+	}
+
+
+	/***** (8)Time Advance ta(s) *****/
+	TIME time_advance() const{
+		return (state.pending > 0) ? TIME("00:00:00") : numeric_limits<TIME>::infinity();
+	}
+
+
+	/***** (8)Output State Log *****/
+	friend ostringstream& operator<< (ostringstream& os, const typename Transfer<TIME>::state_type& i){
+		os << ":\n\tpending: " << i.pending;
+		return os;
+	}
+};
+
+#endif //_TRANSFER_HPP__
\ No newline at end of file
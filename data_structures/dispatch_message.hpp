@@ -0,0 +1,33 @@
+#ifndef _DISPATCH_MESSAGE_HPP__
+#define _DISPATCH_MESSAGE_HPP__
+
+#include <iostream>
+
+using namespace std;
+
+//=======================DISPATCH MESSAGES=======================
+//Between the plant dispatcher and the gates of its lines (see atomics/dispatcher.hpp and atomics/line_gate.hpp).
+//A dispatch is seen by every gate, which only keeps the ones of its own line.
+struct Dispatch_t{
+	int line;			//from 0
+	int amount;			//batch size
+};
+
+struct Line_Feedback_t{
+	enum Kind {PREPARED, END};		//one material prepared by the last stage of the line, or that stage is idle
+	int line;
+	int kind;
+};
+
+inline ostream& operator<< (ostream& os, const Dispatch_t& msg){
+	os << msg.amount << " to line " << msg.line;
+	return os;
+}
+
+inline ostream& operator<< (ostream& os, const Line_Feedback_t& msg){
+	os << ((msg.kind == Line_Feedback_t::END) ? "end" : "prepared") << " on line " << msg.line;
+	return os;
+}
+//===============================================================
+
+#endif //_DISPATCH_MESSAGE_HPP__
\ No newline at end of file
@@ -0,0 +1,91 @@
+#ifndef _HISTOGRAM_HPP__
+#define _HISTOGRAM_HPP__
+
+#include <assert.h>
+#include <stdint.h>
+#include <vector>
+
+using namespace std;
+
+/***** LATENCY HISTOGRAM *****/
+//HDR-style log-linear histogram of non-negative integer values (milliseconds here).
+//Values below 2*2^SUB_BITS get their own bucket; above that each power of two is split in 2^SUB_BITS buckets,
+//so quantiles have a relative error below 2^-SUB_BITS (0.4%). The bucket array has a fixed size,
+//so memory does not depend on the number of recorded values.
+class Latency_Histogram{
+	static const int SUB_BITS = 8;
+	static const int MAX_BITS = 42;					//values up to 2^42 ms (about 139 years), larger ones are clamped
+	static const int64_t SUB_COUNT = (int64_t)1 << SUB_BITS;
+
+	vector<uint64_t> buckets;
+	uint64_t n;
+	int64_t min_value;
+	int64_t max_value;
+	double sum;
+
+	static int msb(uint64_t v){
+		int b = 0;
+		while (v >>= 1) b++;
+		return b;
+	}
+
+	static size_t index_of(int64_t v){
+		if (v < 2*SUB_COUNT) return (size_t)v;
+		int shift = msb((uint64_t)v) - SUB_BITS;
+		return (size_t)((shift + 1)*SUB_COUNT + ((v >> shift) - SUB_COUNT));
+	}
+
+	//lowest value that falls in bucket i
+	static int64_t value_of(size_t i){
+		if ((int64_t)i < 2*SUB_COUNT) return (int64_t)i;
+		int shift = (int)(i/SUB_COUNT) - 1;
+		return ((int64_t)(i % SUB_COUNT) + SUB_COUNT) << shift;
+	}
+
+public:
+	Latency_Histogram()
+		: buckets(index_of(((int64_t)1 << MAX_BITS) - 1) + 1, 0), n(0), min_value(0), max_value(0), sum(0){}
+
+	void record(int64_t v){
+		assert(v >= 0 && "H - negative latency");
+		const int64_t top = ((int64_t)1 << MAX_BITS) - 1;
+		if (v > top) v = top;
+		buckets[index_of(v)]++;
+		if (n == 0 || v < min_value) min_value = v;
+		if (n == 0 || v > max_value) max_value = v;
+		sum += (double)v;
+		n++;
+	}
+
+	//value below which a fraction q of the recorded values lie (q in [0,1])
+	int64_t quantile(double q) const{
+		if (n == 0) return 0;
+		uint64_t rank = (uint64_t)(q*(double)n);
+		if (rank >= n) rank = n - 1;
+		uint64_t seen = 0;
+		for (size_t i = 0; i < buckets.size(); i++){
+			seen += buckets[i];
+			if (seen > rank){
+				int64_t v = value_of(i);
+				return (v < min_value) ? min_value : ((v > max_value) ? max_value : v);
+			}
+		}
+		return max_value;
+	}
+
+	void merge(const Latency_Histogram& other){
+		if (other.n == 0) return;
+		for (size_t i = 0; i < buckets.size(); i++) buckets[i] += other.buckets[i];
+		if (n == 0 || other.min_value < min_value) min_value = other.min_value;
+		if (n == 0 || other.max_value > max_value) max_value = other.max_value;
+		sum += other.sum;
+		n += other.n;
+	}
+
+	uint64_t count() const{ return n; }
+	int64_t min() const{ return min_value; }
+	int64_t max() const{ return max_value; }
+	double mean() const{ return (n) ? sum/(double)n : 0.0; }
+};
+
+#endif //_HISTOGRAM_HPP__
\ No newline at end of file
@@ -0,0 +1,86 @@
+#ifndef _INPUT_SCHEDULE_HPP__
+#define _INPUT_SCHEDULE_HPP__
+
+#include <stddef.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/***** INPUT SCHEDULE *****/
+//Events of an input file ("time message" per line, the iestream_input format), parsed once and never modified.
+//Input_Schedule::load() keeps one copy per file: any number of readers (one per cell) share it through a cursor,
+//so the startup time and memory do not grow with the number of cells replaying the same schedule.
+template<typename MSG, typename TIME>
+struct Input_Schedule{
+	string path;
+	vector<TIME> times;				//non-decreasing
+	vector<MSG> messages;
+
+	size_t size() const{
+		return times.size();
+	}
+
+	//index of the first event at or after t (binary search)
+	size_t seek(const TIME& t) const{
+		return lower_bound(times.begin(), times.end(), t) - times.begin();
+	}
+
+	//index after the events at the same time as event i
+	size_t same_time_end(size_t i) const{
+		size_t j = i + 1;
+		while (j < times.size() && times[j] == times[i]) j++;
+		return j;
+	}
+
+	//Shared schedule of the file, parsed on the first call; nullptr if the file cannot be opened.
+	//Like iestream_input, the events stop at the first line that cannot be parsed or goes back in time.
+	static shared_ptr<const Input_Schedule> load(const string& file_path){
+		static mutex cache_mutex;
+		static map<string, weak_ptr<const Input_Schedule>> cache;		//freed once no reader uses it
+		lock_guard<mutex> lock(cache_mutex);
+		for (auto e = cache.begin(); e != cache.end();){		//drop the entries of the schedules already freed
+			if (e->second.expired()) e = cache.erase(e);
+			else ++e;
+		}
+		auto entry = cache.find(file_path);
+		shared_ptr<const Input_Schedule> cached = (entry != cache.end()) ? entry->second.lock() : nullptr;
+		if (cached) return cached;
+
+		ifstream file(file_path);
+		if (!file.is_open()) return nullptr;
+		auto schedule = make_shared<Input_Schedule>();
+		schedule->path = file_path;
+		string text;					//the time is read as text first: TIME's operator>> does not stop cleanly at the end
+		MSG m;
+		while (file >> text >> m){
+			TIME t;
+			try {
+				t = TIME(text);
+			} catch (exception& e){
+				break;
+			}
+			if (!schedule->times.empty() && t < schedule->times.back()) break;
+			schedule->times.push_back(t);
+			schedule->messages.push_back(m);
+		}
+		parses()++;
+		cache[file_path] = schedule;
+		return schedule;
+	}
+
+	//number of files parsed by load() for this MSG and TIME, to check that a schedule is parsed only once
+	static atomic<long long>& parses(){
+		static atomic<long long> count(0);
+		return count;
+	}
+};
+
+#endif //_INPUT_SCHEDULE_HPP__
\ No newline at end of file
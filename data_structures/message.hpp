@@ -2,6 +2,7 @@
 #define BOOST_SIMULATION_MESSAGE_HPP
 
 #include <assert.h>
+#include <atomic>
 #include <iostream>
 #include <string>
 
@@ -19,6 +20,24 @@ struct Message_t{
 	//message contents
 	int material;	
 	bool ready;			//material ready for processing
+	int product = 0;	//product of the order the material belongs to (see order.hpp). Not part of the text form
+	
+	//lineage: simulated time (ms) at which the material went through each hop, -1 = not stamped.
+	//Not part of the text form, so input files and logs are unchanged
+	enum Hop {CREATED, LOADED, MOVED, UNLOADED, HOPS};		//request sent by Control, loadedOut, unloadOut, unloadedOut
+	long long stamp[HOPS] = {-1, -1, -1, -1};
+	//number of cycle-time observers alive (MCCS_Cycle_Times); the models stamp the materials only while there is one:
+	//turning TIME into milliseconds is not free and nothing else reads the stamps. Process-wide, so a run without an
+	//observer also stamps while another thread's run has one
+	static inline atomic<int> stamping{0};
+	
+	void set_stamp(Hop hop, long long ms){
+		stamp[hop] = ms;
+	}
+	//time between two hops, -1 if one of them is not stamped
+	long long elapsed(Hop from, Hop to) const{
+		return (stamp[from] < 0 || stamp[to] < 0) ? -1 : stamp[to] - stamp[from];
+	}
 };
 
 istream& operator>> (istream& is, Message_t& msg);
@@ -0,0 +1,75 @@
+#ifndef _MPSC_QUEUE_HPP__
+#define _MPSC_QUEUE_HPP__
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+
+using namespace std;
+
+/***** MULTI-PRODUCER SINGLE-CONSUMER QUEUE *****/
+//Bounded lock-free queue (Vyukov's ring of sequenced cells). Any number of threads push, one thread pops.
+//A producer claims a cell with one compare-and-swap on the enqueue index and publishes it with a release store of
+//the cell sequence; the consumer only reads its own index and the sequence of its next cell, so it never waits for
+//a lock held by a producer. No allocation after construction: push() returns false when the queue is full.
+template<typename T>
+class MPSC_Queue{
+	struct Cell{
+		atomic<size_t> sequence;	//== position when free for the producer of position, position + 1 once written
+		T data;
+	};
+
+	size_t mask;
+	unique_ptr<Cell[]> cells;
+	alignas(64) atomic<size_t> enqueue_position;
+	alignas(64) size_t dequeue_position;			//consumer only
+
+public:
+	//capacity: a power of two
+	MPSC_Queue(size_t capacity = 1024) : mask(capacity - 1), cells(new Cell[capacity]), enqueue_position(0), dequeue_position(0){
+		assert(capacity >= 2 && (capacity & (capacity - 1)) == 0 && "Q - the capacity must be a power of two");
+		for (size_t i = 0; i < capacity; i++) cells[i].sequence.store(i, memory_order_relaxed);
+	}
+
+	MPSC_Queue(const MPSC_Queue&) = delete;
+	MPSC_Queue& operator=(const MPSC_Queue&) = delete;
+
+	//Any thread; false if the queue is full
+	bool push(const T& value){
+		size_t position = enqueue_position.load(memory_order_relaxed);
+		Cell* cell;
+		while (true){
+			cell = &cells[position & mask];
+			size_t sequence = cell->sequence.load(memory_order_acquire);
+			intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+			if (difference == 0){
+				if (enqueue_position.compare_exchange_weak(position, position + 1, memory_order_relaxed)) break;
+			} else if (difference < 0){
+				return false;						//the consumer has not freed this cell yet
+			} else {
+				position = enqueue_position.load(memory_order_relaxed);
+			}
+		}
+		cell->data = value;
+		cell->sequence.store(position + 1, memory_order_release);
+		return true;
+	}
+
+	//Consumer thread only; false if there is nothing to pop
+	bool pop(T& value){
+		Cell* cell = &cells[dequeue_position & mask];
+		if (cell->sequence.load(memory_order_acquire) != dequeue_position + 1) return false;
+		value = cell->data;
+		cell->sequence.store(dequeue_position + mask + 1, memory_order_release);
+		dequeue_position++;
+		return true;
+	}
+
+	size_t capacity() const{
+		return mask + 1;
+	}
+};
+
+#endif //_MPSC_QUEUE_HPP__
\ No newline at end of file
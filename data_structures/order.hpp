@@ -0,0 +1,39 @@
+#ifndef _ORDER_HPP__
+#define _ORDER_HPP__
+
+#include <iostream>
+
+using namespace std;
+
+//=======================ORDERS=======================
+//Typed start request of a cell (see atomics/control.hpp): "quantity" materials of one product, in an input file as
+//	product quantity due
+//with due the seconds allowed after the order arrives (< 0: no due date), e.g. "2 5 600".
+struct Order_t{
+	int product = 0;
+	int quantity = 0;
+	double due = -1;
+
+	//simulated time (ms) at which Control received the order, -1 = not received yet. Not part of the text form
+	long long arrival = -1;
+
+	bool has_due() const{
+		return due >= 0;
+	}
+};
+
+inline ostream& operator<< (ostream& os, const Order_t& msg){
+	os << msg.quantity << " of product " << msg.product;
+	if (msg.has_due()) os << " due in " << msg.due << " s";
+	return os;
+}
+
+inline istream& operator>> (istream& is, Order_t& msg){
+	is >> msg.product;
+	is >> msg.quantity;
+	is >> msg.due;
+	return is;
+}
+//====================================================
+
+#endif //_ORDER_HPP__
\ No newline at end of file
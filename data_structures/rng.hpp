@@ -0,0 +1,85 @@
+#ifndef _RNG_HPP__
+#define _RNG_HPP__
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+
+/***** RANDOM NUMBER GENERATION *****/
+//Small, fast and seedable generators. They are implemented here (instead of using the <random> distributions)
+//so that a seed gives the same sequence with every compiler and standard library.
+
+//SplitMix64: 8 bytes of state, one addition and three xor-shift-multiply rounds per number
+struct SplitMix64{
+	uint64_t state;
+
+	SplitMix64(uint64_t seed = 0) : state(seed){}
+
+	uint64_t next(){
+		uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	//uniform in [0,1)
+	double uniform(){
+		return (next() >> 11) * (1.0/9007199254740992.0);
+	}
+
+	//uniform integer in [lo,hi]
+	int uniform_int(int lo, int hi){
+		assert(lo <= hi);
+		return lo + (int)(next() % (uint64_t)(hi - lo + 1));
+	}
+
+	double exponential(double mean){
+		return -mean * log(1.0 - uniform());
+	}
+
+	//number of trials until the first success (>= 1) with the given mean
+	int geometric(double mean){
+		assert(mean >= 1.0);
+		if (mean == 1.0) return 1;
+		double p = 1.0/mean;
+		return 1 + (int)floor(log(1.0 - uniform()) / log(1.0 - p));
+	}
+};
+
+//Counter-based generator: the i-th number of a stream is a pure function of (key, i), so there is no generator
+//state to share, lock or save. split() derives an independent stream, e.g. one per model instance or replication.
+struct CounterRng{
+	uint64_t key;
+
+	CounterRng(uint64_t i_key = 0) : key(i_key){}
+
+	static uint64_t mix(uint64_t z){
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	uint64_t at(uint64_t counter) const{
+		return mix(key ^ mix(counter * 0x9E3779B97F4A7C15ULL + 0xD1B54A32D192ED03ULL));
+	}
+
+	//uniform in [0,1)
+	double uniform(uint64_t counter) const{
+		return (at(counter) >> 11) * (1.0/9007199254740992.0);
+	}
+
+	CounterRng split(uint64_t stream) const{
+		return CounterRng(mix(key + 0x9E3779B97F4A7C15ULL * (stream + 1)));
+	}
+
+	//stream number of a named entity (FNV-1a), e.g. split(CounterRng::stream_of("storage1"))
+	//h continues the hash of a prefix: stream_of("1", stream_of("storage")) == stream_of("storage1")
+	static uint64_t stream_of(const char* name, uint64_t h = 0xCBF29CE484222325ULL){
+		for (; *name; name++){
+			h = (h ^ (unsigned char)*name) * 0x100000001B3ULL;
+		}
+		return h;
+	}
+};
+
+#endif //_RNG_HPP__
\ No newline at end of file
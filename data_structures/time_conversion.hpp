@@ -0,0 +1,86 @@
+#ifndef _TIME_CONVERSION_HPP__
+#define _TIME_CONVERSION_HPP__
+
+#include <assert.h>
+#include <math.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <limits>
+
+using namespace std;
+
+/***** TIME <-> NUMBER CONVERSIONS *****/
+//The models only rely on TIME("hh:mm:ss:mmm") and on operator<<, so the conversions go through that text form.
+//The resolution is one millisecond, which is what the loggers print.
+
+const long long TIME_INFINITE_MS = numeric_limits<long long>::max();
+
+//"hh:mm:ss:mmm" text of a number of milliseconds
+inline string milliseconds_to_string(long long ms){
+	ostringstream os;
+	if (ms < 0){
+		os << "-";
+		ms = -ms;
+	}
+	os << ms/3600000 << ":" << (ms/60000)%60 << ":" << (ms/1000)%60 << ":" << ms%1000;
+	return os.str();
+}
+
+template<typename TIME>
+TIME time_from_milliseconds(long long ms){
+	if (ms == TIME_INFINITE_MS){
+		return numeric_limits<TIME>::infinity();
+	}
+	return TIME(milliseconds_to_string(ms));
+}
+
+//Returns TIME_INFINITE_MS for infinity; sets *exact to false if the value has a finer resolution than 1ms
+template<typename TIME>
+long long time_to_milliseconds(const TIME& t, bool* exact = nullptr){
+	ostringstream os;
+	os << t;
+	string text = os.str();
+	if (exact) *exact = true;
+	if (text.find("inf") != string::npos){
+		return TIME_INFINITE_MS;
+	}
+	bool negative = (!text.empty() && text[0] == '-');
+	if (negative) text = text.substr(1);
+
+	vector<long long> fields;					//hh, mm, ss, mmm and, in deep view, finer units
+	stringstream ss(text);
+	string field;
+	while (getline(ss, field, ':')){
+		fields.push_back(stoll(field));
+	}
+	const long long scale[4] = {3600000, 60000, 1000, 1};
+	long long ms = 0;
+	for (size_t i = 0; i < fields.size(); i++){
+		if (i < 4){
+			ms += fields[i]*scale[i];
+		} else if (fields[i] != 0 && exact){
+			*exact = false;
+		}
+	}
+	return (negative) ? -ms : ms;
+}
+
+template<typename TIME>
+TIME time_from_seconds(double s){
+	if (isinf(s)){
+		return numeric_limits<TIME>::infinity();
+	}
+	return time_from_milliseconds<TIME>(llround(s*1000.0));
+}
+
+template<typename TIME>
+double time_to_seconds(const TIME& t){
+	long long ms = time_to_milliseconds(t);
+	if (ms == TIME_INFINITE_MS){
+		return numeric_limits<double>::infinity();
+	}
+	return ms/1000.0;
+}
+
+#endif //_TIME_CONVERSION_HPP__
\ No newline at end of file
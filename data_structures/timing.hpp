@@ -0,0 +1,200 @@
+#ifndef _TIMING_HPP__
+#define _TIMING_HPP__
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "rng.hpp"
+
+using namespace std;
+
+/***** PROCESSING TIMES *****/
+//Time of one Storage load or Handling move: a constant or a draw from a distribution.
+//Draw number i of a model is taken from its own counter-based stream, so a run is reproducible
+//whatever the order in which models (or replications) are executed.
+struct Timing{
+	int distribution;			//0 = constant, 1 = uniform, 2 = triangular, 3 = exponential
+	double a, b, c;				//seconds. constant: a   uniform: [a,b]   triangular: [a,c] with mode b   exponential: mean a
+	CounterRng stream;			//stream of the model instance using this timing
+
+	Timing(double constant = 0) : distribution(0), a(constant), b(constant), c(constant){}
+
+	bool stochastic() const{
+		return distribution != 0;
+	}
+
+	//Expected seconds per operation
+	double mean() const{
+		if (distribution == 1) return (a + b)/2;
+		if (distribution == 2) return (a + b + c)/3;
+		return a;
+	}
+
+	//Seconds taken by operation number "counter"
+	double sample(uint64_t counter) const{
+		double u = stream.uniform(counter);
+		double x;
+		if (distribution == 0){
+			x = a;
+		} else if (distribution == 1){
+			x = a + (b - a)*u;
+		} else if (distribution == 2){
+			double f = (b - a)/(c - a);
+			x = (u < f) ? a + sqrt(u*(c - a)*(b - a)) : c - sqrt((1.0 - u)*(c - a)*(c - b));
+		} else if (distribution == 3){
+			x = -a * log(1.0 - u);
+		} else {
+			assert(false && "T - unknown distribution");
+			x = a;
+		}
+		return x;
+	}
+
+	//"constant 2", "uniform 1.5 2.5", "triangular 1 2 4" or "exponential 2"
+	bool read(istream& is){
+		string name;
+		is >> name;
+		if (name == "constant"){
+			distribution = 0;
+			is >> a;
+			b = c = a;
+		} else if (name == "uniform"){
+			distribution = 1;
+			is >> a >> b;
+		} else if (name == "triangular"){
+			distribution = 2;
+			is >> a >> b >> c;
+		} else if (name == "exponential"){
+			distribution = 3;
+			is >> a;
+		} else {
+			return false;
+		}
+		return !is.fail() && a >= 0 && (distribution != 1 || a <= b) && (distribution != 2 || (a <= b && b <= c && a < c));
+	}
+};
+
+
+/***** MCCS CONFIGURATION *****/
+//Timings of the MCCS cell, optionally loaded from a file with one "key value..." per line, e.g.
+//	seed 42
+//	loading_time uniform 1.5 2.5
+//	moving_time constant 5
+//	product 2 loading_time constant 4
+//	product 2 moving_time triangular 8 10 14
+//The "product P" lines give the times of the materials of product P (see data_structures/order.hpp); the products
+//without them take loading_time and moving_time.
+struct MCCS_config{
+	Timing loading;				//Storage, default 2s
+	Timing moving;				//Handling, default 5s
+	map<int, Timing> product_loading;
+	map<int, Timing> product_moving;
+	uint64_t seed;
+
+	MCCS_config() : loading(2.0), moving(5.0), seed(0){}
+
+	bool read(const char* file_path){
+		ifstream file(file_path);
+		if (!file.is_open()) return false;
+		string line;
+		while (getline(file, line)){
+			istringstream is(line);
+			string key;
+			if (!(is >> key) || key[0] == '#') continue;
+			bool ok;
+			if (key == "seed"){
+				ok = !(is >> seed).fail();
+			} else if (key == "loading_time"){
+				ok = loading.read(is);
+			} else if (key == "moving_time"){
+				ok = moving.read(is);
+			} else if (key == "product"){
+				int product;
+				string time;
+				ok = !(is >> product >> time).fail() && product >= 0;
+				if (ok && time == "loading_time") ok = product_loading[product].read(is);
+				else if (ok && time == "moving_time") ok = product_moving[product].read(is);
+				else ok = false;
+			} else {
+				ok = false;
+			}
+			if (!ok) return false;
+		}
+		return true;
+	}
+
+	bool stochastic() const{
+		bool products = false;
+		for (auto& p : product_loading) products = products || p.second.stochastic();
+		for (auto& p : product_moving) products = products || p.second.stochastic();
+		return loading.stochastic() || moving.stochastic() || products;
+	}
+
+	//Timings with the RNG stream of the named model instance (and replication)
+	Timing storage_timing(const char* model_name, uint64_t replication = 0) const{
+		Timing t = loading;
+		t.stream = CounterRng(seed).split(replication).split(CounterRng::stream_of(model_name));
+		return t;
+	}
+
+	Timing handling_timing(const char* model_name, uint64_t replication = 0) const{
+		Timing t = moving;
+		t.stream = CounterRng(seed).split(replication).split(CounterRng::stream_of(model_name));
+		return t;
+	}
+
+	//Per-product timings of the named instance, each product on its own stream of the instance
+	map<int, Timing> storage_product_timings(const char* model_name, uint64_t replication = 0) const{
+		return product_timings(product_loading, model_name, replication);
+	}
+
+	map<int, Timing> handling_product_timings(const char* model_name, uint64_t replication = 0) const{
+		return product_timings(product_moving, model_name, replication);
+	}
+
+	//Loading and moving times of the materials of the product: its own or loading_time/moving_time.
+	//The materials of plain startIn batches are of product 0.
+	const Timing& loading_of(int product) const{
+		auto l = product_loading.find(product);
+		return (l != product_loading.end()) ? l->second : loading;
+	}
+
+	const Timing& moving_of(int product) const{
+		auto m = product_moving.find(product);
+		return (m != product_moving.end()) ? m->second : moving;
+	}
+
+	//Expected seconds to load and move one material of the product
+	double unit_seconds(int product) const{
+		return loading_of(product).mean() + moving_of(product).mean();
+	}
+
+	//unit_seconds of the products 0 to the highest one configured, then of the products without their own times,
+	//for the sequencing of Control
+	vector<double> unit_seconds_table() const{
+		int products = 0;
+		if (!product_loading.empty()) products = max(products, product_loading.rbegin()->first + 1);
+		if (!product_moving.empty()) products = max(products, product_moving.rbegin()->first + 1);
+		vector<double> table(products + 1);
+		for (int p = 0; p < products; p++) table[p] = unit_seconds(p);
+		table[products] = loading.mean() + moving.mean();
+		return table;
+	}
+
+private:
+	map<int, Timing> product_timings(const map<int, Timing>& timings, const char* model_name, uint64_t replication) const{
+		map<int, Timing> result = timings;
+		CounterRng instance = CounterRng(seed).split(replication).split(CounterRng::stream_of(model_name));
+		for (auto& p : result) p.second.stream = instance.split(p.first + 1);
+		return result;
+	}
+};
+
+#endif //_TIMING_HPP__
\ No newline at end of file
@@ -0,0 +1,151 @@
+#ifndef _ANALYTIC_HPP__
+#define _ANALYTIC_HPP__
+
+#include "batch_engine.hpp"			//Batch_Output, and the per-object engine used as the fallback
+
+#include "../data_structures/input_schedule.hpp"
+#include "../data_structures/timing.hpp"
+
+//C++ libraries
+#include <chrono>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+/**
+ * Analytic evaluation of a deterministic MCCS cell
+ *
+ * With constant loading and moving times, Control prepares the materials one after the other and every hand-off
+ * (loadOut, loadedOut, prepOut, unloadedOut) takes no time, so each material takes exactly loading + moving.
+ * A batch received while the cell is idle starts at once; one received while busy only adds to the requests,
+ * including a batch received at the instant of a completion (startIn is processed before unloadedIn). Hence:
+ *   - material k of a busy period started at s is prepared (matPreparedOut k) at s + k*(loading + moving)
+ *   - endOut goes with the matPreparedOut that reaches the requested total
+ * The outputs follow in one pass over the schedule, without running the DEVS engine.
+ *
+ * The closed form only holds for constant timings and positive batch sizes (a batch of 0 received while idle still
+ * starts a material, which is never counted as the last one); otherwise evaluate_mccs() runs the models instead.
+ */
+
+
+/***** (1) Closed form *****/
+template<typename TIME>
+struct MCCS_Analytic{
+	//True if the closed form applies; otherwise why not
+	static bool applicable(const MCCS_config& config, const Input_Schedule<int, TIME>& schedule, string* reason = nullptr){
+		auto fail = [reason](const string& why){
+			if (reason) *reason = why;
+			return false;
+		};
+		if (config.stochastic()) return fail("stochastic processing times");
+		for (size_t i = 0; i < schedule.size(); i++){
+			if (schedule.messages[i] <= 0) return fail("batch of " + to_string(schedule.messages[i]) + " materials");
+		}
+		return true;
+	}
+
+	//matPreparedOut and endOut of the cell (as cell 0) before "until", in the order the engine sends them.
+	//The times are added as TIME values, like the clocks of the models, so no conversion is needed per output.
+	static vector<Batch_Output<TIME>> evaluate(const MCCS_config& config, const Input_Schedule<int, TIME>& schedule,
+			const TIME& until){
+		TIME cycle = Storage<TIME>(config.loading_of(0)).loading_time +		//startIn materials are of product 0
+			Handling<TIME>(config.moving_of(0)).moving_time;
+		vector<Batch_Output<TIME>> outputs;
+		size_t next = 0;					//next start request
+		long long total = 0;				//materials requested, and prepared, as counted by Control
+		long long prepared = 0;
+		bool busy = false;
+		TIME done;							//completion of the material in progress
+		while (true){
+			if (!busy){
+				if (next == schedule.size()) break;
+				done = schedule.times[next] + cycle;
+				total += schedule.messages[next++];
+				busy = true;
+			}
+			if (!(done < until)) break;
+			while (next < schedule.size() && !(done < schedule.times[next])){
+				total += schedule.messages[next++];
+			}
+			prepared++;
+			outputs.push_back({done, 0, BATCH_MAT_PREPARED, (int)prepared});
+			if (prepared == total){
+				outputs.push_back({done, 0, BATCH_END, 1});
+				busy = false;
+			} else {
+				done += cycle;
+			}
+		}
+		return outputs;
+	}
+};
+
+
+/***** (2) Evaluator with fallback and self-check *****/
+enum Analytic_Mode {ANALYTIC_AUTO = 0, ANALYTIC_SIMULATE, ANALYTIC_CHECK};
+
+struct Analytic_Report{
+	bool analytic = false;				//outputs from the closed form
+	string reason;						//why the models were run instead
+	bool checked = false;				//ANALYTIC_CHECK: both were computed and compared
+	bool matched = false;
+	size_t first_mismatch = 0;			//index of the first differing output (or the shorter length)
+	double analytic_seconds = 0;
+	double simulation_seconds = 0;
+
+	void print(ostream& os) const{
+		if (analytic){
+			os << "Analytic evaluation in " << analytic_seconds << " s" << endl;
+		} else {
+			os << "Simulated (" << reason << ") in " << simulation_seconds << " s" << endl;
+		}
+		if (checked){
+			os << "Self-check against the engine (" << simulation_seconds << " s): " <<
+				((matched) ? "identical outputs" : "MISMATCH at output " + to_string(first_mismatch)) << endl;
+		}
+	}
+};
+
+//Outputs of one MCCS cell replaying a start file up to "until": from the closed form when it applies (ANALYTIC_AUTO),
+//from the Cadmium models otherwise or when asked (ANALYTIC_SIMULATE). ANALYTIC_CHECK computes both and compares them.
+template<typename TIME>
+vector<Batch_Output<TIME>> evaluate_mccs(const char* start_file, const MCCS_config& config, const TIME& until,
+		int mode = ANALYTIC_AUTO, Analytic_Report* report = nullptr){
+	Analytic_Report local;
+	Analytic_Report& r = (report) ? *report : local;
+	r = Analytic_Report();
+
+	vector<Batch_Output<TIME>> analytic_outputs;
+	shared_ptr<const Input_Schedule<int, TIME>> schedule = Input_Schedule<int, TIME>::load(start_file);
+	if (!schedule){
+		r.reason = "cannot open " + string(start_file);
+	} else if (mode == ANALYTIC_SIMULATE){
+		r.reason = "simulation requested";
+	} else if (MCCS_Analytic<TIME>::applicable(config, *schedule, &r.reason)){
+		auto begin = chrono::steady_clock::now();
+		analytic_outputs = MCCS_Analytic<TIME>::evaluate(config, *schedule, until);
+		r.analytic_seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		r.analytic = true;
+		if (mode != ANALYTIC_CHECK) return analytic_outputs;
+	}
+
+	auto begin = chrono::steady_clock::now();
+	MCCS_BatchEngine<TIME> engine(1, start_file, true, config);		//the per-object Cadmium models
+	engine.run_until(until);
+	vector<Batch_Output<TIME>> simulated = engine.outputs();
+	r.simulation_seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+	if (!r.analytic) return simulated;
+
+	r.checked = true;
+	size_t n = min(analytic_outputs.size(), simulated.size());
+	r.first_mismatch = 0;
+	while (r.first_mismatch < n && analytic_outputs[r.first_mismatch] == simulated[r.first_mismatch]) r.first_mismatch++;
+	r.matched = (analytic_outputs.size() == simulated.size() && r.first_mismatch == n);
+	return analytic_outputs;
+}
+
+#endif //_ANALYTIC_HPP__
\ No newline at end of file
@@ -0,0 +1,533 @@
+#ifndef _BATCH_ENGINE_HPP__
+#define _BATCH_ENGINE_HPP__
+
+//Cadmium Simulator headers
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include <cadmium/basic_model/pdevs/iestream.hpp> 	//Atomic model for inputs (and its Parser)
+
+//Messages structures
+#include "../data_structures/message.hpp"
+#include "../data_structures/time_conversion.hpp"
+#include "../data_structures/timing.hpp"
+
+//Atomic model headers
+#include "../atomics/control.hpp"
+#include "../atomics/storage.hpp"
+#include "../atomics/handling.hpp"
+
+//C++ libraries
+#include <assert.h>
+#include <stdint.h>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace cadmium;
+using namespace cadmium::basic_models::pdevs;
+
+
+/**
+ * MCCS batch engine
+ *
+ * Simulates N identical MCCS cells (Control + Storage + Handling) that all replay the same startIn schedule.
+ * The states of the three atomic models are stored in structure-of-arrays form and every simulation step
+ * runs lambda, routing and the transitions of all cells as straight loops over those arrays, so the
+ * compiler can vectorise them. A cell that is not imminent and receives no input is masked out.
+ *
+ * The step structure is the one of the PDEVS coordinator: all outputs of the imminent models first,
+ * then the couplings, then dint/dext/dconf. Outputs (matPreparedOut and endOut of every cell) are
+ * therefore identical to running the dynamic models.
+ *
+ * If the timings are stochastic, or the timings or the schedule are not exactly representable in milliseconds,
+ * the engine falls back to building the per-object dynamic models and running them with the Cadmium runner.
+ */
+
+
+/***** (1) Ports and helper models used by the per-object fallback *****/
+struct BatchEngine_defs{
+	//ports for the Inventory handler
+	struct ih_in_load: public in_port<Message_t>{};
+	struct ih_in_prep: public in_port<Message_t>{};
+	struct ih_out_loaded: public out_port<Message_t>{};
+	struct ih_out_unloaded: public out_port<Message_t>{};
+	//ports for each MCCS cell
+	struct mccs_in_start: public in_port<int>{};
+	struct mccs_out_mat_prepared: public out_port<int>{};
+	struct mccs_out_end: public out_port<int>{};
+};
+
+//Logger that discards everything (no stream formatting at all)
+struct Batch_No_Logger{
+	template<typename DECLARED_SOURCE, typename LOG_TYPE, typename... PARAMs>
+	static void log(const PARAMs&... ps){}
+};
+
+template<typename TIME>
+struct Batch_Output{
+	TIME time;
+	int cell;				//0-based cell index
+	int port;				//Batch_Output_Port
+	int value;
+};
+enum Batch_Output_Port {BATCH_MAT_PREPARED = 0, BATCH_END = 1};
+
+template<typename TIME>
+bool operator== (const Batch_Output<TIME>& a, const Batch_Output<TIME>& b){
+	return a.time == b.time && a.cell == b.cell && a.port == b.port && a.value == b.value;
+}
+
+//Sink for the outputs of one cell in the per-object fallback
+struct Output_Recorder_defs{
+	struct matPreparedIn : public in_port<int>{};
+	struct endIn : public in_port<int>{};
+};
+
+template<typename TIME> class Output_Recorder{
+public:
+	using input_ports = tuple<typename Output_Recorder_defs::matPreparedIn, Output_Recorder_defs::endIn>;
+	using output_ports = tuple<>;
+
+	struct state_type{
+		vector<Batch_Output<TIME>>* outputs;
+		int cell;
+		TIME clock;				//absolute time, accumulated from the elapsed times
+	};
+	state_type state;
+
+	Output_Recorder(){
+		state.outputs = nullptr;
+		state.cell = 0;
+	}
+	Output_Recorder(vector<Batch_Output<TIME>>* i_outputs, int i_cell){
+		state.outputs = i_outputs;
+		state.cell = i_cell;
+	}
+
+	void internal_transition(){
+		assert(false && "R - recorder never schedules internal events");
+	}
+
+	void external_transition(TIME e, typename make_message_bags<input_ports>::type mbs){
+		state.clock += e;
+		for(const auto &x : get_messages<typename Output_Recorder_defs::matPreparedIn>(mbs)){
+			state.outputs->push_back({state.clock, state.cell, BATCH_MAT_PREPARED, x});
+		}
+		for(const auto &x : get_messages<typename Output_Recorder_defs::endIn>(mbs)){
+			state.outputs->push_back({state.clock, state.cell, BATCH_END, x});
+		}
+	}
+
+	void confluence_transition(TIME e, typename make_message_bags<input_ports>::type mbs){
+		internal_transition();
+		external_transition(TIME(), move(mbs));
+	}
+
+	typename make_message_bags<output_ports>::type output() const{
+		return typename make_message_bags<output_ports>::type();
+	}
+
+	TIME time_advance() const{
+		return numeric_limits<TIME>::infinity();
+	}
+
+	friend ostringstream& operator<< (ostringstream& os, const typename Output_Recorder<TIME>::state_type& i){
+		os << "cell: " << i.cell << "   recorded outputs: " << i.outputs->size();
+		return os;
+	}
+};
+
+template<typename T>
+class InputReader_Batch_Int : public iestream_input<int,T> {
+	public:
+		InputReader_Batch_Int () = default;
+		InputReader_Batch_Int (const char* file_path) : iestream_input<int,T>(file_path) {}
+};
+
+//Reads the whole startIn schedule with the same parser iestream_input uses, grouped by time (same as the bags
+//produced by iestream_input); false if a time is not exactly representable in milliseconds
+template<typename TIME>
+bool read_start_schedule(const char* file_path, vector<int64_t>& input_time, vector<int>& input_amount, vector<int>& input_count){
+	Parser<TIME, int> parser(file_path);
+	int64_t last = 0;
+	while (true){
+		pair<TIME, int> line;
+		try {
+			line = parser.next_timed_input();
+		} catch(std::exception& e) {
+			break;
+		}
+		bool exact;
+		int64_t t = time_to_milliseconds(line.first, &exact);
+		if (!exact) return false;
+		if (t < last) break;						//iestream_input stops reading at a time in the past
+		if (!input_time.empty() && input_time.back() == t){
+			input_amount.back() += line.second;
+			input_count.back()++;
+		} else {
+			input_time.push_back(t);
+			input_amount.push_back(line.second);
+			input_count.push_back(1);
+		}
+		last = t;
+	}
+	return true;
+}
+
+
+/***** (2) Batch engine *****/
+template<typename TIME> class MCCS_BatchEngine{
+	using tick_t = int64_t;
+	static constexpr tick_t INF_TICK = numeric_limits<tick_t>::max();
+
+public:
+	MCCS_BatchEngine(int i_num_cells, const char* i_start_file, bool i_force_fallback = false, MCCS_config i_config = MCCS_config())
+		: num_cells(i_num_cells), config(i_config), next_input(0){
+		assert(num_cells > 0 && "B - at least one cell is required");
+
+		//the timings are taken from the models themselves so both paths always agree. The materials of startIn
+		//batches are of product 0, which may have its own times (constant here: the fallback runs stochastic ones)
+		Storage<TIME> storage_model(config.loading_of(0));
+		Handling<TIME> handling_model(config.moving_of(0));
+		bool exact_loading, exact_moving;
+		loading_ticks = time_to_milliseconds(storage_model.loading_time, &exact_loading);
+		moving_ticks = time_to_milliseconds(handling_model.moving_time, &exact_moving);
+		batchable = exact_loading && exact_moving && !config.stochastic() && !i_force_fallback;
+
+		if (batchable){
+			batchable = read_start_schedule<TIME>(i_start_file, input_time, input_amount, input_count);
+		}
+		if (batchable){
+			allocate();
+		} else {
+			build_fallback(i_start_file);
+		}
+	}
+
+	//Runs every cell up to (not including) t, like dynamic::engine::runner::run_until
+	TIME run_until(const TIME& t){
+		if (!batchable){
+			fallback_runner->run_until(t);
+			return t;
+		}
+		tick_t until = time_to_milliseconds(t);
+		tick_t next = next_event();
+		while (next < until){
+			step(next);
+			next = next_event();
+		}
+		return time_from_milliseconds<TIME>(next);
+	}
+
+	//True when the structure-of-arrays path is used, false when running the per-object models
+	bool vectorised() const{
+		return batchable;
+	}
+
+	int cells() const{
+		return num_cells;
+	}
+
+	const vector<Batch_Output<TIME>>& outputs() const{
+		return output_log;
+	}
+
+	typename Control<TIME>::state_type control_state(int i) const{
+		if (!batchable) return fallback_control[i]->state;
+		typename Control<TIME>::state_type s;
+		s.message = {c_mat[i], (bool)c_ready[i]};
+		s.sending = c_sending[i];
+		s.phase = c_phase[i];
+		s.total_mats = c_total[i];
+		s.num_prepared = c_prepared[i];
+		s.fin = c_fin[i];
+		return s;
+	}
+
+	typename Storage<TIME>::state_type storage_state(int i) const{
+		if (!batchable) return fallback_storage[i]->state;
+		typename Storage<TIME>::state_type s;
+		s.message = {s_mat[i], (bool)s_ready[i]};
+		s.sending = s_sending[i];
+		s.full = s_full[i];
+		s.load_request_index = s_load[i];
+		s.unload_request_index = s_unload[i];
+		s.operation_time = time_from_milliseconds<TIME>(loading_ticks);
+		return s;
+	}
+
+	typename Handling<TIME>::state_type handling_state(int i) const{
+		if (!batchable) return fallback_handling[i]->state;
+		typename Handling<TIME>::state_type s;
+		s.message = {h_mat[i], (bool)h_ready[i]};
+		s.sending = h_sending[i];
+		s.active = h_active[i];
+		s.index = h_index[i];
+		s.operation_time = time_from_milliseconds<TIME>(moving_ticks);
+		return s;
+	}
+
+private:
+	int num_cells;
+	MCCS_config config;
+	bool batchable;
+	tick_t loading_ticks;
+	tick_t moving_ticks;
+	vector<Batch_Output<TIME>> output_log;
+
+	//start schedule, grouped by time (same as the bags produced by iestream_input)
+	vector<tick_t> input_time;
+	vector<int> input_amount;
+	vector<int> input_count;
+	size_t next_input;
+
+	//Control state
+	vector<int32_t> c_phase, c_sending, c_fin, c_total, c_prepared, c_mat, c_ready;
+	vector<tick_t> c_next;
+	//Storage state
+	vector<int32_t> s_full, s_sending, s_load, s_unload, s_mat, s_ready;
+	vector<tick_t> s_next;
+	//Handling state
+	vector<int32_t> h_active, h_sending, h_index, h_mat, h_ready;
+	vector<tick_t> h_next;
+	//outputs of the current step, indexed by cell
+	vector<int32_t> y_prepared, y_end;								//Control -> top
+	vector<int32_t> y_load, y_prep, y_c_mat, y_c_ready;				//Control -> Storage / Handling
+	vector<int32_t> y_loaded, y_unloaded, y_s_mat, y_s_ready;		//Storage -> Control
+	vector<int32_t> y_unload, y_h_mat, y_h_ready;					//Handling -> Storage
+
+	//per-object fallback
+	shared_ptr<dynamic::engine::runner<TIME, Batch_No_Logger>> fallback_runner;
+	vector<shared_ptr<dynamic::modeling::atomic<Control, TIME>>> fallback_control;
+	vector<shared_ptr<dynamic::modeling::atomic<Storage, TIME, Timing, map<int, Timing>>>> fallback_storage;
+	vector<shared_ptr<dynamic::modeling::atomic<Handling, TIME, Timing, map<int, Timing>>>> fallback_handling;
+
+	void allocate(){
+		size_t n = num_cells;
+		for (auto v : {&c_phase, &c_sending, &c_fin, &c_total, &c_prepared, &c_mat, &c_ready,
+				&s_full, &s_sending, &s_load, &s_unload, &s_mat, &s_ready,
+				&h_active, &h_sending, &h_index, &h_mat, &h_ready,
+				&y_prepared, &y_end, &y_load, &y_prep, &y_c_mat, &y_c_ready,
+				&y_loaded, &y_unloaded, &y_s_mat, &y_s_ready, &y_unload, &y_h_mat, &y_h_ready}){
+			v->assign(n, 0);
+		}
+		c_next.assign(n, INF_TICK);
+		s_next.assign(n, INF_TICK);
+		h_next.assign(n, INF_TICK);
+	}
+
+	tick_t next_event() const{
+		tick_t next = (next_input < input_time.size()) ? input_time[next_input] : INF_TICK;
+		const tick_t* cn = c_next.data();
+		const tick_t* sn = s_next.data();
+		const tick_t* hn = h_next.data();
+		for (int i = 0; i < num_cells; i++){
+			tick_t m = (cn[i] < sn[i]) ? cn[i] : sn[i];
+			m = (m < hn[i]) ? m : hn[i];
+			next = (m < next) ? m : next;
+		}
+		return next;
+	}
+
+	/***** One PDEVS step for every cell at time t *****/
+	void step(tick_t t){
+		const int n = num_cells;
+
+		//startIn is the same for every cell
+		int32_t start_count = 0;
+		int32_t start_amount = 0;
+		if (next_input < input_time.size() && input_time[next_input] == t){
+			start_count = input_count[next_input];
+			start_amount = input_amount[next_input];
+			next_input++;
+		}
+
+		/***** Output functions (lambda) of the imminent models *****/
+		for (int i = 0; i < n; i++){
+			int32_t ci = (c_next[i] == t);
+			int32_t si = (s_next[i] == t);
+			int32_t hi = (h_next[i] == t);
+			int32_t cs = ci & c_sending[i];
+			y_prepared[i] = ci & c_fin[i];
+			y_end[i] = cs & (c_phase[i] == 0);
+			y_load[i] = cs & (c_phase[i] == 1);
+			y_prep[i] = cs & (c_phase[i] == 2);
+			y_c_mat[i] = c_mat[i];
+			y_c_ready[i] = c_ready[i];
+			int32_t ss = si & s_sending[i];
+			y_loaded[i] = ss & (s_full[i] == 0);
+			y_unloaded[i] = ss & (s_full[i] != 0);
+			y_s_mat[i] = s_mat[i];
+			y_s_ready[i] = s_ready[i];
+			y_unload[i] = hi;
+			y_h_mat[i] = h_mat[i];
+			y_h_ready[i] = h_ready[i];
+		}
+		record_outputs(t);
+
+		/***** Transitions (dint, dext, dconf) *****/
+		int32_t control_invalid = 0;
+		int32_t storage_invalid = 0;
+		int32_t handling_invalid = 0;
+		for (int i = 0; i < n; i++){
+			//Control: startIn (schedule), loadedIn and unloadedIn (Storage)
+			int32_t ci = (c_next[i] == t);
+			int32_t st = (start_count > 0);
+			int32_t ld = y_loaded[i];
+			int32_t ul = y_unloaded[i];
+			int32_t phase = c_phase[i];
+			int32_t sending = ci ? 0 : c_sending[i];			//dint (also first half of dconf)
+			int32_t fin = ci ? 0 : c_fin[i];
+			int32_t total = c_total[i] + start_amount;
+			int32_t prepared = c_prepared[i];
+			int32_t mat = st ? prepared + 1 : c_mat[i];
+			int32_t ready = st ? 0 : c_ready[i];
+			sending = (st & (phase == 0)) ? 1 : sending;
+			phase = (st & (phase == 0)) ? 1 : phase;
+			control_invalid |= (ld + ul > 1) | (ld & ((phase != 1) | y_s_ready[i])) | (ul & ((phase != 2) | !y_s_ready[i]));
+			mat = ld ? y_s_mat[i] : mat;
+			ready = ld ? y_s_ready[i] : ready;
+			phase = ld ? 2 : phase;
+			sending = (ld | ul) ? 1 : sending;
+			prepared += ul;
+			int32_t done = (prepared == total);
+			fin = ul ? 1 : fin;
+			phase = ul ? (done ? 0 : 1) : phase;
+			mat = ul ? (done ? y_s_mat[i] : prepared + 1) : mat;
+			ready = ul ? (done ? y_s_ready[i] : 0) : ready;
+			int32_t c_changed = ci | st | ld | ul;
+			c_phase[i] = phase;
+			c_sending[i] = sending;
+			c_fin[i] = fin;
+			c_total[i] = total;
+			c_prepared[i] = prepared;
+			c_mat[i] = mat;
+			c_ready[i] = ready;
+			c_next[i] = c_changed ? (sending ? t : INF_TICK) : c_next[i];
+
+			//Storage: loadIn (Control) and unloadIn (Handling)
+			int32_t si = (s_next[i] == t);
+			int32_t li = y_load[i];
+			int32_t ui = y_unload[i];
+			int32_t full = si ? !s_full[i] : s_full[i];
+			int32_t s_send = si ? 0 : s_sending[i];
+			storage_invalid |= (li + ui > 1) | (li & (full | y_c_ready[i])) | (ui & (!full | !y_h_ready[i]));
+			s_load[i] += li;
+			s_unload[i] += ui;
+			s_mat[i] = li ? y_c_mat[i] : (ui ? y_h_mat[i] : s_mat[i]);
+			s_ready[i] = li ? y_c_ready[i] : (ui ? y_h_ready[i] : s_ready[i]);
+			s_send = (li | ui) ? 1 : s_send;
+			s_full[i] = full;
+			s_sending[i] = s_send;
+			tick_t s_ta = s_send ? (full ? 0 : loading_ticks) : INF_TICK;
+			s_next[i] = (si | li | ui) ? ((s_ta == INF_TICK) ? INF_TICK : t + s_ta) : s_next[i];
+
+			//Handling: prepIn (Control)
+			int32_t hi = (h_next[i] == t);
+			int32_t pi = y_prep[i];
+			int32_t active = hi ? 0 : h_active[i];
+			int32_t h_send = (hi & h_active[i]) ? 0 : h_sending[i];
+			handling_invalid |= pi & (active | y_c_ready[i]);
+			h_index[i] += pi;
+			h_mat[i] = pi ? y_c_mat[i] : h_mat[i];
+			h_ready[i] = pi ? 1 : h_ready[i];
+			active = pi ? 1 : active;
+			h_send = pi ? 1 : h_send;
+			h_active[i] = active;
+			h_sending[i] = h_send;
+			h_next[i] = (hi | pi) ? (h_send ? t + moving_ticks : INF_TICK) : h_next[i];
+		}
+		assert(!control_invalid && "C - invalid input (see Control::external_transition)");
+		assert(!storage_invalid && "S - invalid input (see Storage::external_transition)");
+		assert(!handling_invalid && "H - invalid input (see Handling::external_transition)");
+	}
+
+	//matPreparedOut goes before endOut, as in the Control output bags
+	void record_outputs(tick_t t){
+		bool any = false;
+		for (int i = 0; i < num_cells; i++){
+			any |= (y_prepared[i] | y_end[i]) != 0;
+		}
+		if (!any) return;
+		TIME time = time_from_milliseconds<TIME>(t);
+		for (int i = 0; i < num_cells; i++){
+			if (y_prepared[i]) output_log.push_back({time, i, BATCH_MAT_PREPARED, c_prepared[i]});
+			if (y_end[i]) output_log.push_back({time, i, BATCH_END, 1});
+		}
+	}
+
+	/***** Per-object fallback: N dynamic MCCS cells fed by one input reader *****/
+	void build_fallback(const char* file_path){
+		using defs = BatchEngine_defs;
+		dynamic::modeling::Models submodels_TOP;
+		dynamic::modeling::ICs ics_TOP;
+		shared_ptr<dynamic::modeling::model> input_reader = dynamic::translate::make_dynamic_atomic_model
+						<InputReader_Batch_Int, TIME, const char*>("input_reader", move(file_path));
+		submodels_TOP.push_back(input_reader);
+
+		for (int i = 0; i < num_cells; i++){
+			string n = to_string(i+1);
+			string control_name = "control" + n, storage_name = "storage" + n, handling_name = "handling" + n;
+			string ih_name = "IH" + n, mccs_name = "MCCS" + n, recorder_name = "recorder" + n;
+
+			shared_ptr<dynamic::modeling::model> handling = dynamic::translate::make_dynamic_atomic_model
+							<Handling, TIME, Timing, map<int, Timing>>(handling_name, config.handling_timing(handling_name.c_str()),
+							config.handling_product_timings(handling_name.c_str()));
+			shared_ptr<dynamic::modeling::model> storage = dynamic::translate::make_dynamic_atomic_model
+							<Storage, TIME, Timing, map<int, Timing>>(storage_name, config.storage_timing(storage_name.c_str()),
+							config.storage_product_timings(storage_name.c_str()));
+			shared_ptr<dynamic::modeling::model> control = dynamic::translate::make_dynamic_atomic_model<Control, TIME>(control_name);
+			vector<Batch_Output<TIME>>* sink = &output_log;
+			int cell = i;
+			shared_ptr<dynamic::modeling::model> recorder = dynamic::translate::make_dynamic_atomic_model
+							<Output_Recorder, TIME, vector<Batch_Output<TIME>>*, int>(recorder_name, move(sink), move(cell));
+			fallback_control.push_back(dynamic_pointer_cast<dynamic::modeling::atomic<Control, TIME>>(control));
+			fallback_storage.push_back(dynamic_pointer_cast<dynamic::modeling::atomic<Storage, TIME, Timing, map<int, Timing>>>(storage));
+			fallback_handling.push_back(dynamic_pointer_cast<dynamic::modeling::atomic<Handling, TIME, Timing, map<int, Timing>>>(handling));
+
+			//INVENTORY HANDLER
+			shared_ptr<dynamic::modeling::coupled<TIME>> IH = make_shared<dynamic::modeling::coupled<TIME>>(ih_name,
+				dynamic::modeling::Models{storage, handling},
+				dynamic::modeling::Ports{typeid(defs::ih_in_load), typeid(defs::ih_in_prep)},
+				dynamic::modeling::Ports{typeid(defs::ih_out_loaded), typeid(defs::ih_out_unloaded)},
+				dynamic::modeling::EICs{dynamic::translate::make_EIC<defs::ih_in_load, Storage_defs::loadIn>(storage_name),
+					dynamic::translate::make_EIC<defs::ih_in_prep, Handling_defs::prepIn>(handling_name)},
+				dynamic::modeling::EOCs{dynamic::translate::make_EOC<Storage_defs::loadedOut, defs::ih_out_loaded>(storage_name),
+					dynamic::translate::make_EOC<Storage_defs::unloadedOut, defs::ih_out_unloaded>(storage_name)},
+				dynamic::modeling::ICs{dynamic::translate::make_IC<Handling_defs::unloadOut, Storage_defs::unloadIn>(handling_name, storage_name)});
+
+			//MCCS
+			shared_ptr<dynamic::modeling::coupled<TIME>> MCCS = make_shared<dynamic::modeling::coupled<TIME>>(mccs_name,
+				dynamic::modeling::Models{control, IH},
+				dynamic::modeling::Ports{typeid(defs::mccs_in_start)},
+				dynamic::modeling::Ports{typeid(defs::mccs_out_mat_prepared), typeid(defs::mccs_out_end)},
+				dynamic::modeling::EICs{dynamic::translate::make_EIC<defs::mccs_in_start, Control_defs::startIn>(control_name)},
+				dynamic::modeling::EOCs{dynamic::translate::make_EOC<Control_defs::matPreparedOut, defs::mccs_out_mat_prepared>(control_name),
+					dynamic::translate::make_EOC<Control_defs::endOut, defs::mccs_out_end>(control_name)},
+				dynamic::modeling::ICs{dynamic::translate::make_IC<Control_defs::loadOut, defs::ih_in_load>(control_name, ih_name),
+					dynamic::translate::make_IC<Control_defs::prepOut, defs::ih_in_prep>(control_name, ih_name),
+					dynamic::translate::make_IC<defs::ih_out_loaded, Control_defs::loadedIn>(ih_name, control_name),
+					dynamic::translate::make_IC<defs::ih_out_unloaded, Control_defs::unloadedIn>(ih_name, control_name)});
+
+			submodels_TOP.push_back(MCCS);
+			submodels_TOP.push_back(recorder);
+			ics_TOP.push_back(dynamic::translate::make_IC<iestream_input_defs<int>::out, defs::mccs_in_start>("input_reader", mccs_name));
+			ics_TOP.push_back(dynamic::translate::make_IC<defs::mccs_out_mat_prepared, Output_Recorder_defs::matPreparedIn>(mccs_name, recorder_name));
+			ics_TOP.push_back(dynamic::translate::make_IC<defs::mccs_out_end, Output_Recorder_defs::endIn>(mccs_name, recorder_name));
+		}
+
+		shared_ptr<dynamic::modeling::coupled<TIME>> TOP = make_shared<dynamic::modeling::coupled<TIME>>("TOP",
+			submodels_TOP, dynamic::modeling::Ports{}, dynamic::modeling::Ports{},
+			dynamic::modeling::EICs{}, dynamic::modeling::EOCs{}, ics_TOP);
+		fallback_runner = make_shared<dynamic::engine::runner<TIME, Batch_No_Logger>>(TOP, TIME());
+	}
+};
+
+#endif //_BATCH_ENGINE_HPP__
\ No newline at end of file
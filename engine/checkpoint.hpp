@@ -0,0 +1,574 @@
+#ifndef _CHECKPOINT_HPP__
+#define _CHECKPOINT_HPP__
+
+//Cadmium Simulator headers
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/basic_model/pdevs/iestream.hpp>
+
+//Atomic model headers
+#include "../atomics/control.hpp"
+#include "../atomics/storage.hpp"
+#include "../atomics/handling.hpp"
+#include "../atomics/generator.hpp"
+#include "../atomics/transfer.hpp"
+#include "../atomics/schedule_reader.hpp"
+
+#include "../data_structures/message.hpp"
+#include "../data_structures/order.hpp"
+#include "../data_structures/time_conversion.hpp"
+
+//C++ libraries
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+using namespace cadmium;
+using namespace cadmium::basic_models::pdevs;
+
+
+/***** CHECKPOINT / RESTORE *****/
+//A checkpoint file is a sequence of segments, each one closed by a checksum:
+//	"MCCSCKPT" | version | full | time (ms) | records | payload size | payload | FNV-1a of the payload
+//and each record is: model id | state bytes | next event time (ms).
+//The first segment is full; the next ones only hold the models whose state changed (incremental). Every save still
+//serialises and hashes the state of every model to find the changed ones, so the cost of a checkpoint is O(all states)
+//in memory plus the bytes written for what changed. A torn last segment (crash while writing) is ignored on restore.
+//
+//Cadmium keeps the last/next times of its simulators private, so a restore works on a freshly built model tree:
+//the saved states are put back and the runner is created at the checkpoint time T. Each model then sets its clock
+//to T and shortens its pending time advance by the time elapsed since its last transition, so every model is
+//scheduled at the same next event time as in the original run (this is checked against the saved next times).
+//The same restore path serves in-memory snapshots (Checkpoint_Snapshot), used to fork a run (engine/what_if.hpp).
+
+const uint32_t CHECKPOINT_VERSION = 2;				//2: products and orders
+
+inline uint64_t checkpoint_hash(const string& bytes){
+	uint64_t h = 0xCBF29CE484222325ULL;
+	for (unsigned char c : bytes){
+		h = (h ^ c) * 0x100000001B3ULL;
+	}
+	return h;
+}
+
+
+/***** (1) Binary buffer *****/
+class Checkpoint_Buffer{
+public:
+	string bytes;
+	size_t pos = 0;
+	bool ok = true;				//false after reading past the end
+
+	Checkpoint_Buffer() = default;
+	Checkpoint_Buffer(const string& i_bytes) : bytes(i_bytes){}
+
+	template<typename T>
+	void put(const T& v){
+		static_assert(is_trivially_copyable<T>::value, "CK - only plain values can be copied");
+		bytes.append((const char*)&v, sizeof(T));
+	}
+
+	template<typename T>
+	void get(T& v){
+		static_assert(is_trivially_copyable<T>::value, "CK - only plain values can be copied");
+		if (pos + sizeof(T) > bytes.size()){
+			ok = false;
+			v = T();
+			return;
+		}
+		memcpy(&v, bytes.data() + pos, sizeof(T));
+		pos += sizeof(T);
+	}
+
+	void put_string(const string& s){
+		put((uint64_t)s.size());
+		bytes.append(s);
+	}
+
+	void get_string(string& s){
+		uint64_t n;
+		get(n);
+		if (!ok || pos + n > bytes.size()){
+			ok = false;
+			s.clear();
+			return;
+		}
+		s = bytes.substr(pos, n);
+		pos += n;
+	}
+
+	//times are stored in milliseconds, the resolution of the models
+	template<typename TIME>
+	void put_time(const TIME& t){
+		bool exact;
+		long long ms = time_to_milliseconds(t, &exact);
+		assert(exact && "CK - time finer than 1ms");
+		put(ms);
+	}
+
+	long long get_ms(){
+		long long ms;
+		get(ms);
+		return ms;
+	}
+
+	void put_message(const Message_t& m){
+		put(m.material);
+		put(m.ready);
+		put(m.product);
+		for (int h = 0; h < Message_t::HOPS; h++) put(m.stamp[h]);
+	}
+
+	void get_message(Message_t& m){
+		get(m.material);
+		get(m.ready);
+		get(m.product);
+		for (int h = 0; h < Message_t::HOPS; h++) get(m.stamp[h]);
+	}
+
+	void put_orders(const vector<Order_t>& orders){
+		put((uint64_t)orders.size());
+		for (const Order_t& o : orders) put(o);
+	}
+
+	void get_orders(vector<Order_t>& orders){
+		uint64_t n;
+		get(n);
+		orders.clear();
+		for (uint64_t k = 0; ok && k < n; k++){
+			Order_t o;
+			get(o);
+			if (ok) orders.push_back(o);
+		}
+	}
+};
+
+//t + remaining (both in ms), infinity stays infinity
+inline long long checkpoint_add_ms(long long t, long long d){
+	return (t == TIME_INFINITE_MS || d == TIME_INFINITE_MS) ? TIME_INFINITE_MS : t + d;
+}
+
+
+/***** (2) States of the models *****/
+//save_state writes the state, restore_state reads it back at time t and next_event_ms gives the next internal event
+
+//CONTROL: ta is 0 or infinity, nothing to shorten
+template<typename TIME>
+void save_state(Checkpoint_Buffer& b, const Control<TIME>& m){
+	b.put_message(m.state.message);
+	b.put(m.state.sending);
+	b.put(m.state.phase);
+	b.put(m.state.total_mats);
+	b.put(m.state.num_prepared);
+	b.put(m.state.fin);
+	b.put_message(m.state.prepared);
+	b.put_time(m.state.clock);
+	b.put_orders(m.state.orders);
+	b.put(m.state.current);
+	b.put(m.state.current_left);
+	b.put(m.state.typed);
+	b.put(m.state.orders_done);
+	b.put(m.state.flow_time);
+	b.put(m.state.tardiness);
+	b.put(m.state.late);
+}
+
+template<typename TIME>
+void restore_state(Checkpoint_Buffer& b, Control<TIME>& m, const TIME& t){
+	b.get_message(m.state.message);
+	b.get(m.state.sending);
+	b.get(m.state.phase);
+	b.get(m.state.total_mats);
+	b.get(m.state.num_prepared);
+	b.get(m.state.fin);
+	b.get_message(m.state.prepared);
+	b.get_ms();
+	m.state.clock = t;
+	b.get_orders(m.state.orders);
+	b.get(m.state.current);
+	b.get(m.state.current_left);
+	b.get(m.state.typed);
+	b.get(m.state.orders_done);
+	b.get(m.state.flow_time);
+	b.get(m.state.tardiness);
+	b.get(m.state.late);
+}
+
+template<typename TIME>
+long long next_event_ms(const Control<TIME>& m){
+	return checkpoint_add_ms(time_to_milliseconds(m.state.clock), time_to_milliseconds(m.time_advance()));
+}
+
+//STORAGE: the loading time in progress is shortened
+template<typename TIME>
+void save_state(Checkpoint_Buffer& b, const Storage<TIME>& m){
+	b.put_message(m.state.message);
+	b.put(m.state.sending);
+	b.put(m.state.full);
+	b.put(m.state.load_request_index);
+	b.put(m.state.unload_request_index);
+	b.put_time(m.state.operation_time);
+	b.put_time(m.state.clock);
+}
+
+template<typename TIME>
+void restore_state(Checkpoint_Buffer& b, Storage<TIME>& m, const TIME& t){
+	b.get_message(m.state.message);
+	b.get(m.state.sending);
+	b.get(m.state.full);
+	b.get(m.state.load_request_index);
+	b.get(m.state.unload_request_index);
+	long long operation = b.get_ms();
+	long long elapsed = time_to_milliseconds(t) - b.get_ms();
+	if (m.state.sending && !m.state.full) operation -= elapsed;			//loading in progress
+	m.state.operation_time = time_from_milliseconds<TIME>(operation);
+	m.state.clock = t;
+}
+
+template<typename TIME>
+long long next_event_ms(const Storage<TIME>& m){
+	return checkpoint_add_ms(time_to_milliseconds(m.state.clock), time_to_milliseconds(m.time_advance()));
+}
+
+//HANDLING: the moving time in progress is shortened
+template<typename TIME>
+void save_state(Checkpoint_Buffer& b, const Handling<TIME>& m){
+	b.put_message(m.state.message);
+	b.put(m.state.sending);
+	b.put(m.state.active);
+	b.put(m.state.index);
+	b.put_time(m.state.operation_time);
+	b.put_time(m.state.clock);
+}
+
+template<typename TIME>
+void restore_state(Checkpoint_Buffer& b, Handling<TIME>& m, const TIME& t){
+	b.get_message(m.state.message);
+	b.get(m.state.sending);
+	b.get(m.state.active);
+	b.get(m.state.index);
+	long long operation = b.get_ms();
+	long long elapsed = time_to_milliseconds(t) - b.get_ms();
+	if (m.state.sending) operation -= elapsed;								//moving in progress
+	m.state.operation_time = time_from_milliseconds<TIME>(operation);
+	m.state.clock = t;
+}
+
+template<typename TIME>
+long long next_event_ms(const Handling<TIME>& m){
+	return checkpoint_add_ms(time_to_milliseconds(m.state.clock), time_to_milliseconds(m.time_advance()));
+}
+
+//GENERATOR: the random generator is saved with the rest of the state, the interval in progress is shortened
+template<typename TIME>
+void save_state(Checkpoint_Buffer& b, const Generator<TIME>& m){
+	b.put(m.state.rng.state);
+	b.put(m.state.next_batch);
+	b.put_time(m.state.next_interval);
+	b.put(m.state.burst_position);
+	b.put(m.state.generated);
+	b.put(m.state.active);
+	b.put_time(m.state.clock);
+}
+
+template<typename TIME>
+void restore_state(Checkpoint_Buffer& b, Generator<TIME>& m, const TIME& t){
+	b.get(m.state.rng.state);
+	b.get(m.state.next_batch);
+	long long interval = b.get_ms();
+	b.get(m.state.burst_position);
+	b.get(m.state.generated);
+	b.get(m.state.active);
+	long long elapsed = time_to_milliseconds(t) - b.get_ms();
+	if (m.state.active) interval -= elapsed;
+	m.state.next_interval = time_from_milliseconds<TIME>(interval);
+	m.state.clock = t;
+}
+
+template<typename TIME>
+long long next_event_ms(const Generator<TIME>& m){
+	return checkpoint_add_ms(time_to_milliseconds(m.state.clock), time_to_milliseconds(m.time_advance()));
+}
+
+//TRANSFER: ta is 0 or infinity, nothing to shorten
+template<typename TIME>
+void save_state(Checkpoint_Buffer& b, const Transfer<TIME>& m){
+	b.put(m.state.pending);
+	b.put_time(m.state.clock);
+}
+
+template<typename TIME>
+void restore_state(Checkpoint_Buffer& b, Transfer<TIME>& m, const TIME& t){
+	b.get(m.state.pending);
+	b.get_ms();
+	m.state.clock = t;
+}
+
+template<typename TIME>
+long long next_event_ms(const Transfer<TIME>& m){
+	return checkpoint_add_ms(time_to_milliseconds(m.state.clock), time_to_milliseconds(m.time_advance()));
+}
+
+//INPUT READER: its file position is private to the parser, so the freshly opened file is read again up to the saved
+//time (parsing only, no simulation), then both lookahead times are shortened
+template<typename MSG, typename TIME>
+void save_state(Checkpoint_Buffer& b, const iestream_input<MSG, TIME>& m){
+	b.put(m.state._initialization);
+	b.put_time(m.state._simulation_time);
+	b.put_time(m.state._next_time);
+}
+
+template<typename MSG, typename TIME>
+void restore_state(Checkpoint_Buffer& b, iestream_input<MSG, TIME>& m, const TIME& t){
+	bool initialization;
+	b.get(initialization);
+	long long simulation_time = b.get_ms();
+	long long next_time = b.get_ms();
+	const TIME infinity = numeric_limits<TIME>::infinity();
+	while (m.state._next_time != infinity && (m.state._initialization != initialization ||
+			time_to_milliseconds(m.state._simulation_time) < simulation_time)){
+		m.internal_transition();
+	}
+	if (time_to_milliseconds(m.state._next_time) != next_time){
+		b.ok = false;							//the input file is not the one of the checkpointed run
+		return;
+	}
+	long long elapsed = time_to_milliseconds(t) - simulation_time;
+	if (m.state._next_time != infinity){
+		m.state._next_time = time_from_milliseconds<TIME>(next_time - elapsed);
+	}
+	if (m.state._next_time2 != infinity){
+		m.state._next_time2 = time_from_milliseconds<TIME>(time_to_milliseconds(m.state._next_time2) - elapsed);
+	}
+	m.state._simulation_time = t;
+}
+
+template<typename MSG, typename TIME>
+long long next_event_ms(const iestream_input<MSG, TIME>& m){
+	return checkpoint_add_ms(time_to_milliseconds(m.state._simulation_time), time_to_milliseconds(m.time_advance()));
+}
+
+//SCHEDULE READER: the cursor is enough, the schedule is checked by its size (no re-scan of the events)
+template<typename MSG, typename TIME>
+void save_state(Checkpoint_Buffer& b, const Schedule_Reader<MSG, TIME>& m){
+	b.put((uint64_t)((m.schedule) ? m.schedule->size() : 0));
+	b.put((uint64_t)m.state.cursor);
+	b.put_time(m.state.clock);
+}
+
+template<typename MSG, typename TIME>
+void restore_state(Checkpoint_Buffer& b, Schedule_Reader<MSG, TIME>& m, const TIME& t){
+	uint64_t size, cursor;
+	b.get(size);
+	b.get(cursor);
+	b.get_ms();
+	if (size != (uint64_t)((m.schedule) ? m.schedule->size() : 0)){
+		b.ok = false;							//the input file is not the one of the checkpointed run
+		return;
+	}
+	m.state.cursor = cursor;
+	m.state.clock = t;
+}
+
+template<typename MSG, typename TIME>
+long long next_event_ms(const Schedule_Reader<MSG, TIME>& m){
+	return checkpoint_add_ms(time_to_milliseconds(m.state.clock), time_to_milliseconds(m.time_advance()));
+}
+
+//Models that are not in the checkpoint (e.g. added in a what-if branch) keep their initial state and start at time t
+template<typename MODEL, typename TIME>
+void start_at(MODEL& m, const TIME& t){
+	m.state.clock = t;
+}
+
+template<typename MSG, typename TIME>
+void start_at(iestream_input<MSG, TIME>& m, const TIME& t){
+	m.state._simulation_time = t;
+}
+
+template<typename MSG, typename TIME>
+void start_at(Schedule_Reader<MSG, TIME>& m, const TIME& t){
+	m.seek(t);
+}
+
+
+/***** (3) Snapshot *****/
+//States of all the models at one time, in memory. It is never modified once taken, so any number of model trees
+//(e.g. what-if branches on several threads) can be restored from the same shared snapshot.
+struct Checkpoint_Snapshot{
+	long long time = -1;								//ms
+	map<string, pair<string, long long>> states;		//id -> (state bytes, next event time in ms)
+};
+
+
+/***** (4) Checkpointer *****/
+template<typename TIME>
+class Checkpointer{
+	struct Entry{
+		string id;
+		function<void(Checkpoint_Buffer&)> save;
+		function<void(Checkpoint_Buffer&, const TIME&)> restore;
+		function<void(const TIME&)> start;
+		function<long long()> next;
+		uint64_t hash;				//hash of the state bytes in the file, to skip unchanged models
+		bool written;
+	};
+	vector<Entry> entries;
+	string written_path;			//file the hashes refer to
+
+	template<typename MODEL>
+	bool bind(dynamic::modeling::model* model, Entry& e){
+		MODEL* typed = dynamic_cast<MODEL*>(model);
+		if (!typed) return false;
+		e.save = [typed](Checkpoint_Buffer& b){ save_state(b, *typed); };
+		e.restore = [typed](Checkpoint_Buffer& b, const TIME& t){ restore_state(b, *typed, t); };
+		e.start = [typed](const TIME& t){ start_at(*typed, t); };
+		e.next = [typed](){ return next_event_ms(*typed); };
+		return true;
+	}
+
+	void add(shared_ptr<dynamic::modeling::model> model){
+		auto coupled = dynamic_pointer_cast<dynamic::modeling::coupled<TIME>>(model);
+		if (coupled){
+			for (auto& m : coupled->_models) add(m);
+			return;
+		}
+		Entry e;
+		e.id = model->get_id();
+		e.hash = 0;
+		e.written = false;
+		bool known = bind<Control<TIME>>(model.get(), e) || bind<Storage<TIME>>(model.get(), e) ||
+			bind<Handling<TIME>>(model.get(), e) || bind<Generator<TIME>>(model.get(), e) || bind<Transfer<TIME>>(model.get(), e) ||
+			bind<Schedule_Reader<int, TIME>>(model.get(), e) || bind<Schedule_Reader<Message_t, TIME>>(model.get(), e) ||
+			bind<iestream_input<int, TIME>>(model.get(), e) || bind<iestream_input<Message_t, TIME>>(model.get(), e) ||
+			bind<iestream_input<Order_t, TIME>>(model.get(), e);
+		assert(known && "CK - atomic model without checkpoint support");
+		entries.push_back(e);
+	}
+
+public:
+	//Every atomic model of the tree must be a Control, Storage, Handling, Generator, Transfer, schedule reader or input reader (possibly profiled)
+	Checkpointer(shared_ptr<dynamic::modeling::coupled<TIME>> top){
+		add(top);
+	}
+
+	//Saves the states after the transitions of time t (MCCS_Runner::last()).
+	//Appends the models changed since the last save to the same file, or writes them all (full or another file).
+	bool save(const string& path, const TIME& t, bool full = false){
+		if (path != written_path) full = true;
+		Checkpoint_Buffer payload;
+		uint32_t records = 0;
+		for (auto& e : entries){
+			Checkpoint_Buffer state;
+			e.save(state);
+			uint64_t h = checkpoint_hash(state.bytes);
+			if (!full && e.written && h == e.hash) continue;
+			payload.put_string(e.id);
+			payload.put_string(state.bytes);
+			payload.put(e.next());
+			e.hash = h;
+			e.written = true;
+			records++;
+		}
+		Checkpoint_Buffer segment;
+		segment.bytes = "MCCSCKPT";
+		segment.put(CHECKPOINT_VERSION);
+		segment.put((uint8_t)full);
+		segment.put_time(t);
+		segment.put(records);
+		segment.put((uint64_t)payload.bytes.size());
+		segment.bytes += payload.bytes;
+		segment.put(checkpoint_hash(payload.bytes));
+
+		ofstream out(path, ios::binary | ((full) ? ios::trunc : ios::app));
+		out.write(segment.bytes.data(), segment.bytes.size());
+		out.flush();
+		if (!out) return false;
+		written_path = path;
+		return true;
+	}
+
+	//Puts back the states of the last complete segment of the file into the (freshly built) model tree.
+	//t is set to the checkpoint time: create the runner with it, e.g. MCCS_Runner<TIME, LOGGER> r(TOP, t)
+	bool restore(const string& path, TIME& t){
+		ifstream in(path, ios::binary);
+		if (!in) return false;
+		string file((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+		Checkpoint_Buffer b(file);
+
+		Checkpoint_Snapshot snapshot;
+		while (b.pos < b.bytes.size()){
+			if (b.bytes.compare(b.pos, 8, "MCCSCKPT") != 0) break;
+			b.pos += 8;
+			uint32_t version, records;
+			uint8_t full;
+			uint64_t size, checksum;
+			b.get(version);
+			b.get(full);
+			long long segment_time = b.get_ms();
+			b.get(records);
+			b.get(size);
+			if (!b.ok || version != CHECKPOINT_VERSION || b.pos + size + sizeof(checksum) > b.bytes.size()) break;
+			Checkpoint_Buffer payload(b.bytes.substr(b.pos, size));
+			b.pos += size;
+			b.get(checksum);
+			if (checksum != checkpoint_hash(payload.bytes)) break;		//torn segment
+			if (full) snapshot.states.clear();
+			for (uint32_t i = 0; i < records; i++){
+				string id, state;
+				long long next;
+				payload.get_string(id);
+				payload.get_string(state);
+				payload.get(next);
+				snapshot.states[id] = make_pair(state, next);
+			}
+			if (!payload.ok) break;
+			snapshot.time = segment_time;
+		}
+		if (snapshot.time < 0 || !restore(snapshot, t)) return false;
+		written_path = path;			//later saves are appended to the restored file
+		return true;
+	}
+
+	//In-memory snapshot of the states after the transitions of time t
+	shared_ptr<const Checkpoint_Snapshot> snapshot(const TIME& t) const{
+		auto s = make_shared<Checkpoint_Snapshot>();
+		s->time = time_to_milliseconds(t);
+		for (auto& e : entries){
+			Checkpoint_Buffer state;
+			e.save(state);
+			s->states[e.id] = make_pair(state.bytes, e.next());
+		}
+		return s;
+	}
+
+	//Puts back the states of a snapshot. With allow_new, the models of this tree that are not in the snapshot
+	//keep their initial state and start at the snapshot time; otherwise both trees must have the same models.
+	bool restore(const Checkpoint_Snapshot& snapshot, TIME& t, bool allow_new = false){
+		t = time_from_milliseconds<TIME>(snapshot.time);
+		for (auto& e : entries){
+			auto saved = snapshot.states.find(e.id);
+			if (saved == snapshot.states.end()){
+				if (!allow_new) return false;
+				e.start(t);
+				continue;
+			}
+			Checkpoint_Buffer state(saved->second.first);
+			e.restore(state, t);
+			if (!state.ok || e.next() != saved->second.second) return false;
+			e.hash = checkpoint_hash(saved->second.first);
+			e.written = true;
+		}
+		return true;
+	}
+};
+
+#endif //_CHECKPOINT_HPP__
\ No newline at end of file
@@ -0,0 +1,265 @@
+#ifndef _CHUNKED_LOG_HPP__
+#define _CHUNKED_LOG_HPP__
+
+//C++ libraries
+#include <zlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+/***** (1) Format *****/
+//A chunked log is the text of a Cadmium log (state or messages) cut in chunks of about chunk_bytes, each one compressed
+//on its own with zlib and appended to "path". Chunks are only cut before a time line ("hh:mm:ss:mmm" alone, written
+//by the global_time loggers before the logs of every step), so each chunk holds whole steps. The sidecar index
+//"path.idx" has one line per chunk:
+//	first_ms last_ms offset compressed_bytes raw_bytes
+//with the first and last step times of the chunk, and is appended once the chunk is on disk, so after a crash the
+//index describes a readable prefix of the log. A reader only decompresses the chunks that overlap the requested times.
+struct Chunk_Entry{
+	long long first_ms;				//-1: no time line in the chunk (log text before the first step)
+	long long last_ms;
+	long long offset;
+	long long compressed_bytes;
+	long long raw_bytes;
+};
+
+//Milliseconds of a time line, -1 if the line is not one
+inline long long log_time_line_ms(const char* line, size_t size){
+	long long fields[4] = {0, 0, 0, 0};
+	int field = 0;
+	bool digit = false;
+	for (size_t i = 0; i < size; i++){
+		char c = line[i];
+		if (c >= '0' && c <= '9'){
+			fields[field] = fields[field]*10 + (c - '0');
+			digit = true;
+		} else if (c == ':' && digit && field < 3){
+			field++;
+			digit = false;
+		} else if (c == '\r' && i + 1 == size){
+			break;
+		} else {
+			return -1;
+		}
+	}
+	if (field != 3 || !digit) return -1;
+	return ((fields[0]*60 + fields[1])*60 + fields[2])*1000 + fields[3];
+}
+
+
+/***** (2) Writer *****/
+//Stream buffer behind Chunked_Log_Stream: collects the text, and compresses and writes a chunk when a time line
+//starts once chunk_bytes have been collected
+class Chunked_Log_Buffer : public streambuf{
+	ofstream data;
+	ofstream index;
+	string pending;					//text of the current chunk
+	size_t line_start = 0;			//start of the incomplete line in pending
+	size_t chunk_bytes;
+	int level;
+	long long offset = 0;
+	long long first_ms = -1, last_ms = -1;
+	vector<Bytef> compressed;
+	long long raw_total = 0, compressed_total = 0, chunks = 0;
+
+	//The line of pending ending at "end" is complete: a time line may close the chunk before it.
+	//Returns the number of bytes written out from the front of pending.
+	size_t end_of_line(size_t end){
+		size_t written = 0;
+		long long ms = log_time_line_ms(pending.data() + line_start, end - line_start);
+		if (ms >= 0){
+			if (line_start >= chunk_bytes){
+				string rest = pending.substr(line_start);
+				pending.resize(line_start);
+				written = line_start;
+				write_chunk();
+				pending = rest;
+			}
+			if (first_ms < 0) first_ms = ms;
+			last_ms = ms;
+		}
+		line_start = end - written + 1;
+		return written;
+	}
+
+	void write_chunk(){
+		if (pending.empty()) return;
+		uLongf size = compressBound(pending.size());
+		compressed.resize(size);
+		compress2(compressed.data(), &size, (const Bytef*)pending.data(), pending.size(), level);
+		data.write((const char*)compressed.data(), size);
+		data.flush();
+		index << first_ms << " " << last_ms << " " << offset << " " << size << " " << pending.size() << "\n";
+		index.flush();
+		offset += size;
+		raw_total += pending.size();
+		compressed_total += size;
+		chunks++;
+		pending.clear();
+		line_start = 0;
+		first_ms = last_ms = -1;
+	}
+
+protected:
+	int overflow(int c) override{
+		if (c == EOF) return 0;
+		char ch = (char)c;
+		xsputn(&ch, 1);
+		return c;
+	}
+
+	streamsize xsputn(const char* s, streamsize n) override{
+		size_t i = pending.size();
+		pending.append(s, n);
+		const char* newline;
+		while ((newline = (const char*)memchr(pending.data() + i, '\n', pending.size() - i)) != nullptr){
+			i = newline - pending.data();
+			i -= end_of_line(i);
+			i++;
+		}
+		return n;
+	}
+
+public:
+	//level: zlib level, 1 (fastest) to 9 (smallest)
+	Chunked_Log_Buffer(const string& path, size_t i_chunk_bytes = 1 << 20, int i_level = 1)
+		: data(path, ios::binary | ios::trunc), index(path + ".idx", ios::trunc), chunk_bytes(i_chunk_bytes), level(i_level){
+		pending.reserve(chunk_bytes + 4096);
+	}
+
+	~Chunked_Log_Buffer(){
+		close();
+	}
+
+	bool is_open() const{
+		return data.is_open() && index.is_open();
+	}
+
+	//Writes the last chunk
+	void close(){
+		if (!data.is_open()) return;
+		write_chunk();
+		data.close();
+		index.close();
+	}
+
+	long long raw_bytes() const{ return raw_total; }
+	long long compressed_bytes() const{ return compressed_total; }
+	long long chunk_count() const{ return chunks; }
+};
+
+//Output stream writing a chunked log; it can be the sink of any Cadmium logger
+class Chunked_Log_Stream : public ostream{
+	Chunked_Log_Buffer buffer;
+
+public:
+	Chunked_Log_Stream(const string& path, size_t chunk_bytes = 1 << 20, int level = 1)
+		: ostream(nullptr), buffer(path, chunk_bytes, level){
+		rdbuf(&buffer);
+		if (!buffer.is_open()) setstate(ios::failbit);
+	}
+
+	void close(){
+		flush();
+		buffer.close();
+	}
+
+	const Chunked_Log_Buffer& chunks() const{
+		return buffer;
+	}
+};
+
+
+/***** (3) Reader *****/
+struct Log_Query_Report{
+	long long chunks_read = 0;
+	long long compressed_bytes = 0;		//read from the disk
+	long long raw_bytes = 0;			//decompressed
+	long long steps = 0;				//time lines written
+	double seconds = 0;
+
+	void print(ostream& os, size_t index_chunks) const{
+		os << "read " << chunks_read << " of " << index_chunks << " chunks (" << compressed_bytes/1024 << " KiB, " <<
+			raw_bytes/1024 << " KiB decompressed), " << steps << " steps in " << fixed << setprecision(3) << seconds*1000 <<
+			defaultfloat << " ms" << endl;
+	}
+};
+
+class Chunked_Log_Reader{
+	mutable ifstream data;
+
+public:
+	vector<Chunk_Entry> index;
+	string error;
+
+	//false if the log or its index cannot be read
+	bool open(const string& path){
+		index.clear();
+		ifstream in(path + ".idx");
+		data.open(path, ios::binary);
+		if (!in.is_open() || !data.is_open()){
+			error = "cannot open " + path + " or its index";
+			return false;
+		}
+		Chunk_Entry e;
+		while (in >> e.first_ms >> e.last_ms >> e.offset >> e.compressed_bytes >> e.raw_bytes) index.push_back(e);
+		return true;
+	}
+
+	//Text of chunk i, empty if it cannot be read
+	string chunk(size_t i) const{
+		const Chunk_Entry& e = index[i];
+		vector<Bytef> compressed(e.compressed_bytes);
+		data.clear();
+		data.seekg(e.offset);
+		if (!data.read((char*)compressed.data(), compressed.size())) return string();
+		string text(e.raw_bytes, '\0');
+		uLongf size = e.raw_bytes;
+		if (uncompress((Bytef*)&text[0], &size, compressed.data(), compressed.size()) != Z_OK || (long long)size != e.raw_bytes){
+			return string();
+		}
+		return text;
+	}
+
+	//Writes the steps with a time in [from_ms, to_ms] (and their logs), decompressing only the chunks that hold them
+	Log_Query_Report read_range(long long from_ms, long long to_ms, ostream& os) const{
+		auto begin = chrono::steady_clock::now();
+		Log_Query_Report report;
+		for (size_t i = 0; i < index.size(); i++){
+			const Chunk_Entry& e = index[i];
+			if (e.first_ms > to_ms) break;					//chunks are in time order
+			if (e.first_ms < 0 || e.last_ms < from_ms) continue;	//before the first step or the range
+			string text = chunk(i);
+			bool inside = false;							//the last time line was in the range
+			report.chunks_read++;
+			report.compressed_bytes += e.compressed_bytes;
+			report.raw_bytes += text.size();
+			size_t start = 0;
+			while (start < text.size()){
+				size_t end = text.find('\n', start);
+				if (end == string::npos) end = text.size();
+				long long ms = log_time_line_ms(text.data() + start, end - start);
+				if (ms >= 0){
+					inside = (ms >= from_ms && ms <= to_ms);
+					if (inside) report.steps++;
+				}
+				if (inside) os.write(text.data() + start, min(end + 1, text.size()) - start);
+				start = end + 1;
+			}
+		}
+		report.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		return report;
+	}
+};
+
+#endif //_CHUNKED_LOG_HPP__
\ No newline at end of file
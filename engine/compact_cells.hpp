@@ -0,0 +1,508 @@
+#ifndef _COMPACT_CELLS_HPP__
+#define _COMPACT_CELLS_HPP__
+
+//Batch engine: start schedule, output ports and the atomic models (their state types)
+#include "batch_engine.hpp"
+
+//Messages structures
+#include "../data_structures/time_conversion.hpp"
+#include "../data_structures/timing.hpp"
+#include "../data_structures/rng.hpp"
+
+//C++ libraries
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+
+/**
+ * MCCS compact cells
+ *
+ * Memory footprint mode for a million (or more) MCCS cells replaying the same startIn schedule. Per-object models
+ * take kilobytes per cell (names, shared pointers, port maps and message bags of every atomic and coupled model);
+ * here a cell is one packed record:
+ *  - names are interned once in a string table; the name of a model of cell i is built on demand (control7 ...)
+ *    and never stored per cell,
+ *  - the phases and flags of Control, Storage and Handling are bitfields, the counters 32-bit integers,
+ *  - cells are referenced by their index (in the event queue and the outputs), never by pointers,
+ *  - the couplings are one immutable template shared by all the cells.
+ *
+ * Unlike the structure-of-arrays batch engine, cells do not have to stay in step: the timings may be stochastic
+ * (each Storage and Handling draws from the stream of its model name, as the per-object models do) and only the
+ * imminent cells are visited, taken from an event queue ordered by time and cell index. The transitions are those
+ * of MCCS_BatchEngine, so outputs and states are identical to the per-object models.
+ */
+
+
+/***** (1) String table *****/
+//Each distinct string is stored once and referred to by its index
+class String_Table{
+public:
+	uint32_t intern(const string& s){
+		auto found = ids.find(s);
+		if (found != ids.end()) return found->second;
+		uint32_t id = strings.size();
+		strings.push_back(s);
+		ids.emplace(s, id);
+		return id;
+	}
+
+	const string& name(uint32_t id) const{
+		return strings[id];
+	}
+
+	size_t size() const{
+		return strings.size();
+	}
+
+	//approximate heap taken by the table
+	size_t bytes() const{
+		size_t b = strings.capacity()*sizeof(string) + ids.bucket_count()*sizeof(void*);
+		for (auto& s : strings){
+			b += 2*(s.capacity() + 1) + sizeof(pair<const string, uint32_t>) + sizeof(void*);
+		}
+		return b;
+	}
+
+private:
+	vector<string> strings;
+	unordered_map<string, uint32_t> ids;
+};
+
+
+/***** (2) Cell template *****/
+//Models and couplings of one MCCS cell (the MCCS and Inventory handler coupled models flattened), shared by all cells
+enum Compact_Role {COMPACT_CONTROL = 0, COMPACT_STORAGE = 1, COMPACT_HANDLING = 2, COMPACT_CELL = 3};
+
+struct Cell_Template{
+	struct Coupling{
+		uint8_t from_role;			//Compact_Role, COMPACT_CELL for the input ports of the cell
+		uint8_t to_role;			//Compact_Role, COMPACT_CELL for the output ports of the cell
+		uint32_t from_port;			//port names in the string table
+		uint32_t to_port;
+	};
+
+	String_Table names;
+	uint32_t role_name[4];
+	uint64_t role_stream[4];		//FNV-1a of the role name, continued with the cell number to get the RNG stream
+	vector<Coupling> couplings;
+
+	//The MCCS cell, as built by the batch engine fallback and the top model
+	static shared_ptr<const Cell_Template> mccs(){
+		static shared_ptr<const Cell_Template> shared = make_shared<const Cell_Template>(make_mccs());
+		return shared;
+	}
+
+	//e.g. model_name(6, COMPACT_STORAGE) is storage7
+	string model_name(uint32_t cell, int role) const{
+		return names.name(role_name[role]) + to_string(cell + 1);
+	}
+
+	//stream of the model of that role in cell, same as CounterRng::stream_of(model_name(cell, role).c_str())
+	uint64_t stream_of(uint32_t cell, int role) const{
+		char digits[12];
+		int n = 0;
+		for (uint32_t k = cell + 1; k > 0; k /= 10){
+			digits[n++] = '0' + k%10;
+		}
+		uint64_t h = role_stream[role];
+		while (n > 0){
+			h = (h ^ (unsigned char)digits[--n]) * 0x100000001B3ULL;
+		}
+		return h;
+	}
+
+	void print(ostream& os, uint32_t cell) const{
+		for (auto& c : couplings){
+			os << ((c.from_role == COMPACT_CELL) ? "MCCS" + to_string(cell + 1) : model_name(cell, c.from_role)) << "::" <<
+				names.name(c.from_port) << " -> " <<
+				((c.to_role == COMPACT_CELL) ? "MCCS" + to_string(cell + 1) : model_name(cell, c.to_role)) << "::" <<
+				names.name(c.to_port) << endl;
+		}
+	}
+
+	size_t bytes() const{
+		return sizeof(Cell_Template) + names.bytes() + couplings.capacity()*sizeof(Coupling);
+	}
+
+private:
+	static Cell_Template make_mccs(){
+		Cell_Template t;
+		const char* roles[4] = {"control", "storage", "handling", "MCCS"};
+		for (int r = 0; r < 4; r++){
+			t.role_name[r] = t.names.intern(roles[r]);
+			t.role_stream[r] = CounterRng::stream_of(roles[r]);
+		}
+		auto couple = [&t](int from_role, const char* from_port, int to_role, const char* to_port){
+			t.couplings.push_back({(uint8_t)from_role, (uint8_t)to_role, t.names.intern(from_port), t.names.intern(to_port)});
+		};
+		couple(COMPACT_CELL, "startIn", COMPACT_CONTROL, "startIn");
+		couple(COMPACT_CONTROL, "loadOut", COMPACT_STORAGE, "loadIn");
+		couple(COMPACT_CONTROL, "prepOut", COMPACT_HANDLING, "prepIn");
+		couple(COMPACT_HANDLING, "unloadOut", COMPACT_STORAGE, "unloadIn");
+		couple(COMPACT_STORAGE, "loadedOut", COMPACT_CONTROL, "loadedIn");
+		couple(COMPACT_STORAGE, "unloadedOut", COMPACT_CONTROL, "unloadedIn");
+		couple(COMPACT_CONTROL, "matPreparedOut", COMPACT_CELL, "matPreparedOut");
+		couple(COMPACT_CONTROL, "endOut", COMPACT_CELL, "endOut");
+		return t;
+	}
+};
+
+
+/***** (3) Packed cell *****/
+//States of the Control, Storage and Handling of one cell. Control is only ever scheduled right away (ta 0 while
+//sending), so its next event is implied by c_sending. The message contents are the material id and the ready flag.
+struct Compact_Cell{
+	uint32_t c_phase : 2;			//0 = Idle, 1 = Init, 2 = Prep
+	uint32_t c_sending : 1;
+	uint32_t c_fin : 1;
+	uint32_t c_ready : 1;
+	uint32_t s_full : 1;
+	uint32_t s_sending : 1;
+	uint32_t s_ready : 1;
+	uint32_t h_active : 1;
+	uint32_t h_sending : 1;
+	uint32_t h_ready : 1;
+	int32_t c_total;
+	int32_t c_prepared;
+	int32_t c_mat;
+	int32_t s_load;
+	int32_t s_unload;
+	int32_t s_mat;
+	int32_t h_index;
+	int32_t h_mat;
+	int64_t s_next;					//ms, INT64_MAX when passive
+	int64_t h_next;
+};
+
+struct Compact_Output{
+	int64_t ms;
+	uint32_t cell;					//0-based cell index
+	int32_t port;					//Batch_Output_Port
+	int32_t value;
+};
+
+
+/***** (4) Compact engine *****/
+template<typename TIME> class MCCS_CompactCells{
+	using tick_t = int64_t;
+	static constexpr tick_t INF_TICK = numeric_limits<tick_t>::max();
+
+	struct Cell_Event{
+		tick_t time;
+		uint32_t cell;
+		bool operator> (const Cell_Event& b) const{
+			return time > b.time || (time == b.time && cell > b.cell);
+		}
+	};
+
+public:
+	string error;					//empty unless the schedule could not be read
+
+	//i_keep_outputs false only counts the outputs (a million cells write millions of them)
+	MCCS_CompactCells(uint32_t i_num_cells, const char* i_start_file, MCCS_config i_config = MCCS_config(),
+		uint64_t i_replication = 0, bool i_keep_outputs = true)
+		: num_cells(i_num_cells), shape(Cell_Template::mccs()), config(i_config), keep_outputs(i_keep_outputs),
+		next_input(0), now(0), prepared_count(0), end_count(0){
+		assert(num_cells > 0 && "K - at least one cell is required");
+		streams = CounterRng(config.seed).split(i_replication);
+		loading_ms = llround(config.loading_of(0).a*1000.0);		//same rounding as time_from_seconds
+		moving_ms = llround(config.moving_of(0).a*1000.0);
+		if (!read_start_schedule<TIME>(i_start_file, input_time, input_amount, input_count)){
+			error = "startIn times must be whole milliseconds";
+		}
+		Compact_Cell idle = {};
+		idle.s_next = INF_TICK;
+		idle.h_next = INF_TICK;
+		cells.assign(num_cells, idle);
+		events.reserve(num_cells);
+	}
+
+	//Runs every cell up to (not including) t, like dynamic::engine::runner::run_until
+	TIME run_until(const TIME& t){
+		tick_t until = time_to_milliseconds(t);
+		tick_t next = next_event();
+		while (error.empty() && next < until){
+			step(next);
+			next = next_event();
+		}
+		return time_from_milliseconds<TIME>(next);
+	}
+
+	uint32_t cells_count() const{
+		return num_cells;
+	}
+
+	const Cell_Template& cell_template() const{
+		return *shape;
+	}
+
+	const vector<Compact_Output>& outputs() const{
+		return output_log;
+	}
+
+	long long prepared() const{
+		return prepared_count;
+	}
+
+	long long ends() const{
+		return end_count;
+	}
+
+	//Heap taken by the cells and the event queue, and the share of the template (outputs not included)
+	double bytes_per_cell() const{
+		size_t b = cells.capacity()*sizeof(Compact_Cell) + events.capacity()*sizeof(Cell_Event) + imminent.capacity()*sizeof(uint32_t) +
+			shape->bytes();
+		return (double)b/num_cells;
+	}
+
+	typename Control<TIME>::state_type control_state(uint32_t i) const{
+		const Compact_Cell& c = cells[i];
+		typename Control<TIME>::state_type s;
+		s.message = {c.c_mat, (bool)c.c_ready};
+		s.sending = c.c_sending;
+		s.phase = c.c_phase;
+		s.total_mats = c.c_total;
+		s.num_prepared = c.c_prepared;
+		s.fin = c.c_fin;
+		return s;
+	}
+
+	typename Storage<TIME>::state_type storage_state(uint32_t i) const{
+		const Compact_Cell& c = cells[i];
+		typename Storage<TIME>::state_type s;
+		s.message = {c.s_mat, (bool)c.s_ready};
+		s.sending = c.s_sending;
+		s.full = c.s_full;
+		s.load_request_index = c.s_load;
+		s.unload_request_index = c.s_unload;
+		s.operation_time = time_from_milliseconds<TIME>(loading_time(i, c.s_load));
+		return s;
+	}
+
+	typename Handling<TIME>::state_type handling_state(uint32_t i) const{
+		const Compact_Cell& c = cells[i];
+		typename Handling<TIME>::state_type s;
+		s.message = {c.h_mat, (bool)c.h_ready};
+		s.sending = c.h_sending;
+		s.active = c.h_active;
+		s.index = c.h_index;
+		s.operation_time = time_from_milliseconds<TIME>(moving_time(i, c.h_index));
+		return s;
+	}
+
+private:
+	uint32_t num_cells;
+	shared_ptr<const Cell_Template> shape;
+	MCCS_config config;
+	bool keep_outputs;
+	CounterRng streams;				//streams of the replication; a model's stream is split from it by name
+	tick_t loading_ms;				//constant timings
+	tick_t moving_ms;
+
+	vector<int64_t> input_time;
+	vector<int> input_amount;
+	vector<int> input_count;
+	size_t next_input;
+
+	vector<Compact_Cell> cells;
+	vector<Cell_Event> events;		//min-heap of the next internal event of each scheduled cell
+	vector<uint32_t> imminent;
+	tick_t now;						//time of the last step
+	vector<Compact_Output> output_log;
+	long long prepared_count;
+	long long end_count;
+
+	//Loading time of load number counter of Storage i (the draw Storage::external_transition takes). The materials
+	//are of product 0: with times of its own, they are drawn from the product's stream (see MCCS_config::product_timings)
+	tick_t loading_time(uint32_t i, int32_t counter) const{
+		const Timing& loading = config.loading_of(0);
+		if (!loading.stochastic()) return loading_ms;
+		Timing t = loading;
+		t.stream = streams.split(shape->stream_of(i, COMPACT_STORAGE));
+		if (config.product_loading.count(0)) t.stream = t.stream.split(1);
+		return llround(t.sample(counter)*1000.0);
+	}
+
+	tick_t moving_time(uint32_t i, int32_t counter) const{
+		const Timing& moving = config.moving_of(0);
+		if (!moving.stochastic()) return moving_ms;
+		Timing t = moving;
+		t.stream = streams.split(shape->stream_of(i, COMPACT_HANDLING));
+		if (config.product_moving.count(0)) t.stream = t.stream.split(1);
+		return llround(t.sample(counter)*1000.0);
+	}
+
+	tick_t cell_next(const Compact_Cell& c) const{
+		tick_t next = (c.s_next < c.h_next) ? c.s_next : c.h_next;
+		return (c.c_sending) ? now : next;
+	}
+
+	tick_t next_event(){
+		while (!events.empty() && events.front().time != cell_next(cells[events.front().cell])){
+			pop_heap(events.begin(), events.end(), greater<Cell_Event>());		//left behind by a start input
+			events.pop_back();
+		}
+		tick_t next = (next_input < input_time.size()) ? input_time[next_input] : INF_TICK;
+		return (!events.empty() && events.front().time < next) ? events.front().time : next;
+	}
+
+	/***** One PDEVS step at time t for the imminent cells (every cell at a start input) *****/
+	void step(tick_t t){
+		now = t;
+		int32_t start_count = 0;
+		int32_t start_amount = 0;
+		if (next_input < input_time.size() && input_time[next_input] == t){
+			start_count = input_count[next_input];
+			start_amount = input_amount[next_input];
+			next_input++;
+		}
+
+		if (start_count > 0){
+			events.clear();
+			for (uint32_t i = 0; i < num_cells; i++){
+				step_cell(i, t, start_count, start_amount);
+				tick_t next = cell_next(cells[i]);
+				if (next != INF_TICK) events.push_back({next, i});
+			}
+			make_heap(events.begin(), events.end(), greater<Cell_Event>());
+			return;
+		}
+
+		imminent.clear();
+		while (!events.empty() && events.front().time == t){
+			imminent.push_back(events.front().cell);
+			pop_heap(events.begin(), events.end(), greater<Cell_Event>());
+			events.pop_back();
+		}
+		//the heap is ordered by cell index at equal times, so the outputs come in the order of the other engines
+		for (uint32_t i : imminent){
+			step_cell(i, t, 0, 0);
+			tick_t next = cell_next(cells[i]);
+			if (next != INF_TICK){
+				events.push_back({next, i});
+				push_heap(events.begin(), events.end(), greater<Cell_Event>());
+			}
+		}
+	}
+
+	//lambda, couplings and dint/dext/dconf of the three models of cell i (see MCCS_BatchEngine::step)
+	void step_cell(uint32_t i, tick_t t, int32_t start_count, int32_t start_amount){
+		Compact_Cell& c = cells[i];
+
+		/***** Output functions (lambda) *****/
+		bool ci = c.c_sending;
+		bool si = (c.s_next == t);
+		bool hi = (c.h_next == t);
+		bool y_load = ci && c.c_phase == 1;
+		bool y_prep = ci && c.c_phase == 2;
+		int32_t y_c_mat = c.c_mat;
+		bool y_c_ready = c.c_ready;
+		bool y_loaded = si && c.s_sending && !c.s_full;
+		bool y_unloaded = si && c.s_sending && c.s_full;
+		int32_t y_s_mat = c.s_mat;
+		bool y_s_ready = c.s_ready;
+		bool y_unload = hi;
+		int32_t y_h_mat = c.h_mat;
+		bool y_h_ready = c.h_ready;
+		if (ci && c.c_fin){
+			prepared_count++;
+			if (keep_outputs) output_log.push_back({t, i, BATCH_MAT_PREPARED, c.c_prepared});
+		}
+		if (ci && c.c_phase == 0){
+			end_count++;
+			if (keep_outputs) output_log.push_back({t, i, BATCH_END, 1});
+		}
+
+		/***** Control: startIn (schedule), loadedIn and unloadedIn (Storage) *****/
+		bool st = (start_count > 0);
+		int32_t phase = c.c_phase;
+		bool sending = (ci) ? false : (bool)c.c_sending;			//dint (also first half of dconf)
+		bool fin = (ci) ? false : (bool)c.c_fin;
+		int32_t total = c.c_total + start_amount;
+		int32_t prepared = c.c_prepared;
+		int32_t mat = (st) ? prepared + 1 : c.c_mat;
+		bool ready = (st) ? false : (bool)c.c_ready;
+		if (st && phase == 0){
+			phase = 1;
+			sending = true;
+		}
+		assert(!(y_loaded && y_unloaded) && "C - Only one message from the inventory handler is allowed per time unit");
+		if (y_loaded){
+			assert(phase == 1 && !y_s_ready && "C - invalid loaded input (see Control::external_transition)");
+			mat = y_s_mat;
+			ready = y_s_ready;
+			phase = 2;
+			sending = true;
+		}
+		if (y_unloaded){
+			assert(phase == 2 && y_s_ready && "C - invalid unloaded input (see Control::external_transition)");
+			prepared++;
+			fin = true;
+			sending = true;
+			bool done = (prepared == total);
+			phase = (done) ? 0 : 1;
+			mat = (done) ? y_s_mat : prepared + 1;
+			ready = (done) ? y_s_ready : false;
+		}
+		c.c_phase = phase;
+		c.c_sending = sending;
+		c.c_fin = fin;
+		c.c_total = total;
+		c.c_prepared = prepared;
+		c.c_mat = mat;
+		c.c_ready = ready;
+
+		/***** Storage: loadIn (Control) and unloadIn (Handling) *****/
+		if (si || y_load || y_unload){
+			bool full = (si) ? !c.s_full : (bool)c.s_full;
+			bool s_send = (si) ? false : (bool)c.s_sending;
+			assert(!(y_load && y_unload) && "S - Only one message is allowed per time unit");
+			if (y_load){
+				assert(!full && !y_c_ready && "S - invalid load request (see Storage::external_transition)");
+				c.s_load++;
+				c.s_mat = y_c_mat;
+				c.s_ready = y_c_ready;
+				s_send = true;
+			}
+			if (y_unload){
+				assert(full && y_h_ready && "S - invalid unload request (see Storage::external_transition)");
+				c.s_unload++;
+				c.s_mat = y_h_mat;
+				c.s_ready = y_h_ready;
+				s_send = true;
+			}
+			c.s_full = full;
+			c.s_sending = s_send;
+			c.s_next = (!s_send) ? INF_TICK : ((full) ? t : t + loading_time(i, c.s_load));
+		}
+
+		/***** Handling: prepIn (Control) *****/
+		if (hi || y_prep){
+			if (hi){
+				c.h_active = false;
+				c.h_sending = false;
+			}
+			if (y_prep){
+				assert(!c.h_active && !y_c_ready && "H - invalid input (see Handling::external_transition)");
+				c.h_index++;
+				c.h_mat = y_c_mat;
+				c.h_ready = true;
+				c.h_active = true;
+				c.h_sending = true;
+			}
+			c.h_next = (c.h_sending) ? t + moving_time(i, c.h_index) : INF_TICK;
+		}
+	}
+};
+
+#endif //_COMPACT_CELLS_HPP__
\ No newline at end of file
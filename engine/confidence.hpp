@@ -0,0 +1,78 @@
+#ifndef _CONFIDENCE_HPP__
+#define _CONFIDENCE_HPP__
+
+//C++ libraries
+#include <assert.h>
+#include <math.h>
+#include <limits>
+
+using namespace std;
+
+
+/***** CONFIDENCE INTERVALS *****/
+//Shared by the replications (engine/replications.hpp) and the steady-state detection (engine/steady_state.hpp)
+
+//Quantile p of the standard normal distribution (Acklam's rational approximation, relative error below 1.2e-9)
+inline double normal_quantile(double p){
+	assert(p > 0 && p < 1 && "R - quantile of a probability outside (0,1)");
+	static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+		1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+	static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+		6.680131188771972e+01, -1.328068155288572e+01};
+	static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+		-2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+	static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00, 3.754408661907416e+00};
+	double q, r;
+	if (p < 0.02425){
+		q = sqrt(-2*log(p));
+		return (((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5]) / ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1);
+	}
+	if (p > 1 - 0.02425){
+		q = sqrt(-2*log(1 - p));
+		return -(((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5]) / ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1);
+	}
+	q = p - 0.5;
+	r = q*q;
+	return (((((a[0]*r + a[1])*r + a[2])*r + a[3])*r + a[4])*r + a[5])*q / (((((b[0]*r + b[1])*r + b[2])*r + b[3])*r + b[4])*r + 1);
+}
+
+//Quantile p of Student's t with df degrees of freedom (Cornish-Fisher expansion around the normal quantile,
+//within 0.01 of the tables from 3 degrees of freedom; exact for 1 and 2)
+inline double student_t_quantile(double p, long long df){
+	assert(df >= 1 && "R - Student's t needs at least one degree of freedom");
+	if (df == 1) return tan(M_PI*(p - 0.5));
+	if (df == 2) return (2*p - 1)/sqrt(2*p*(1 - p));
+	double z = normal_quantile(p);
+	double z2 = z*z, n = (double)df;
+	double g1 = (z2 + 1)*z/4;
+	double g2 = ((5*z2 + 16)*z2 + 3)*z/96;
+	double g3 = (((3*z2 + 19)*z2 + 17)*z2 - 15)*z/384;
+	double g4 = ((((79*z2 + 776)*z2 + 1482)*z2 - 1920)*z2 - 945)*z/92160;
+	return z + g1/n + g2/(n*n) + g3/(n*n*n) + g4/(n*n*n*n);
+}
+
+//Mean and variance of a sample, updated one value at a time (Welford)
+struct Running_Estimate{
+	long long n = 0;
+	double mean = 0;
+	double m2 = 0;				//sum of the squared deviations from the mean
+
+	void add(double x){
+		n++;
+		double delta = x - mean;
+		mean += delta/n;
+		m2 += delta*(x - mean);
+	}
+
+	double variance() const{
+		return (n > 1) ? m2/(n - 1) : 0.0;
+	}
+
+	//half width of the two-sided confidence interval of the mean, infinite with less than 2 values
+	double half_width(double confidence) const{
+		if (n < 2) return numeric_limits<double>::infinity();
+		return student_t_quantile(0.5 + confidence/2, n - 1)*sqrt(variance()/n);
+	}
+};
+
+#endif //_CONFIDENCE_HPP__
\ No newline at end of file
@@ -0,0 +1,118 @@
+#ifndef _CYCLE_TIMES_HPP__
+#define _CYCLE_TIMES_HPP__
+
+//Cadmium Simulator headers
+#include <cadmium/modeling/dynamic_model.hpp>
+
+//Atomic model headers
+#include "../atomics/control.hpp"
+
+#include "../data_structures/message.hpp"
+#include "../data_structures/histogram.hpp"
+#include "mccs_runner.hpp"
+
+//C++ libraries
+#include <assert.h>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace cadmium;
+
+
+/***** Cycle time observer *****/
+//Every time a watched Control receives a prepared material, the timestamps carried by the material
+//give the time spent in each stage. One fixed-size histogram per stage, whatever the number of materials.
+template<typename TIME>
+class MCCS_Cycle_Times : public Run_Observer<TIME>{
+public:
+	enum Stage {LOAD, MOVE, UNLOAD, END_TO_END, STAGES};
+
+private:
+	struct Watched{
+		shared_ptr<Control<TIME>> control;
+		int last_prepared;				//num_prepared when last seen, a new material is recorded when it grows
+	};
+	vector<Watched> controls;
+	Latency_Histogram histograms[STAGES];
+	long long unstamped = 0;			//prepared materials without a complete lineage (e.g. read from a file)
+
+public:
+	//the models stamp the materials they send while at least one observer exists (see Message_t::stamping)
+	MCCS_Cycle_Times(){
+		Message_t::stamping++;
+	}
+
+	MCCS_Cycle_Times(const MCCS_Cycle_Times& other) : controls(other.controls), unstamped(other.unstamped){
+		for (int s = 0; s < STAGES; s++) histograms[s] = other.histograms[s];
+		Message_t::stamping++;
+	}
+
+	MCCS_Cycle_Times& operator=(const MCCS_Cycle_Times& other) = default;
+
+	~MCCS_Cycle_Times(){
+		Message_t::stamping--;
+	}
+
+	static const char* stage_name(int stage){
+		static const char* names[STAGES] = {"load", "move", "unload", "end-to-end"};
+		return names[stage];
+	}
+
+	void watch_control(shared_ptr<dynamic::modeling::model> model){
+		auto control = dynamic_pointer_cast<Control<TIME>>(model);
+		assert(control && "CT - not a Control model");
+		controls.push_back({control, control->state.num_prepared});
+	}
+
+	void step(const TIME& t) override{
+		for (auto& w : controls){
+			if (w.control->state.num_prepared == w.last_prepared) continue;
+			w.last_prepared = w.control->state.num_prepared;
+			const Message_t& m = w.control->state.prepared;
+			long long stages[STAGES] = {m.elapsed(Message_t::CREATED, Message_t::LOADED),
+				m.elapsed(Message_t::LOADED, Message_t::MOVED),
+				m.elapsed(Message_t::MOVED, Message_t::UNLOADED),
+				m.elapsed(Message_t::CREATED, Message_t::UNLOADED)};
+			if (stages[END_TO_END] < 0){
+				unstamped++;
+				continue;
+			}
+			for (int s = 0; s < STAGES; s++){
+				if (stages[s] >= 0) histograms[s].record(stages[s]);
+			}
+		}
+	}
+
+	const Latency_Histogram& histogram(Stage stage) const{
+		return histograms[stage];
+	}
+
+
+	/***** Reports (seconds) *****/
+	void print_summary(ostream& os) const{
+		os << left << setw(14) << "stage" << setw(10) << "count" << setw(10) << "mean" <<
+			setw(10) << "p50" << setw(10) << "p99" << setw(10) << "max" << endl;
+		for (int s = 0; s < STAGES; s++){
+			const Latency_Histogram& h = histograms[s];
+			os << left << setw(14) << stage_name(s) << setw(10) << h.count() << setw(10) << h.mean()/1000.0 <<
+				setw(10) << h.quantile(0.5)/1000.0 << setw(10) << h.quantile(0.99)/1000.0 << setw(10) << h.max()/1000.0 << endl;
+		}
+		if (unstamped) os << unstamped << " materials without timestamps" << endl;
+	}
+
+	void print_json(ostream& os) const{
+		os << "{\n  \"unit\": \"s\",\n  \"unstamped\": " << unstamped << ",\n  \"stages\": [";
+		for (int s = 0; s < STAGES; s++){
+			const Latency_Histogram& h = histograms[s];
+			os << ((s) ? "," : "") << "\n    {\"stage\": \"" << stage_name(s) << "\", \"count\": " << h.count() <<
+				", \"mean\": " << h.mean()/1000.0 << ", \"p50\": " << h.quantile(0.5)/1000.0 <<
+				", \"p99\": " << h.quantile(0.99)/1000.0 << ", \"max\": " << h.max()/1000.0 << "}";
+		}
+		os << "\n  ]\n}" << endl;
+	}
+};
+
+#endif //_CYCLE_TIMES_HPP__
\ No newline at end of file
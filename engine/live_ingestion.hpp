@@ -0,0 +1,151 @@
+#ifndef _LIVE_INGESTION_HPP__
+#define _LIVE_INGESTION_HPP__
+
+#include "../atomics/live_input.hpp"
+
+//C++ libraries
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+
+/***** (1) Ingestion thread *****/
+//Reads start requests ("amount" per line, as in the input files without the time) from a local producer and pushes
+//them to a live feed: standard input or a named pipe (read until the writer closes it), or a Unix socket (every
+//connection is read until it closes, and the socket accepts new ones until stop()). The reads wait at most 50 ms
+//so that stop() is seen promptly; the feed is closed when the source ends or on stop().
+class Live_Ingestion{
+	shared_ptr<Live_Feed> feed;
+	thread reader;
+	atomic<bool> stopping;
+	int listen_fd = -1;
+	string socket_path;
+
+	//Waits until fd is readable, stop() is called (false) or the timeout elapses (true, nothing read)
+	bool wait_readable(int fd, bool& readable){
+		pollfd p = {fd, POLLIN, 0};
+		int r = ::poll(&p, 1, 50);
+		readable = (r > 0);
+		return !stopping.load();
+	}
+
+	//Pushes the requests read from fd until its end; false if stop() was called
+	bool read_requests(int fd){
+		string pending;
+		char buffer[4096];
+		while (true){
+			bool readable;
+			if (!wait_readable(fd, readable)) return false;
+			if (!readable) continue;
+			ssize_t n = ::read(fd, buffer, sizeof(buffer));
+			if (n < 0 && (errno == EAGAIN || errno == EINTR)) continue;		//a named pipe without writer yet
+			if (n <= 0) break;
+			pending.append(buffer, n);
+			size_t begin = 0, end;
+			while ((end = pending.find('\n', begin)) != string::npos){
+				push_line(pending.substr(begin, end - begin));
+				begin = end + 1;
+			}
+			pending.erase(0, begin);
+		}
+		if (!pending.empty()) push_line(pending);
+		return true;
+	}
+
+	void push_line(const string& line){
+		try {
+			size_t used;
+			int amount = stoi(line, &used);
+			feed->push(amount);
+		} catch (exception& e){
+			;		//not a request (empty line or comment), skip it
+		}
+	}
+
+public:
+	Live_Ingestion(shared_ptr<Live_Feed> i_feed) : feed(i_feed), stopping(false){}
+
+	~Live_Ingestion(){
+		stop();
+	}
+
+	//"-" for standard input, otherwise a named pipe or a file; false if it cannot be opened
+	bool start_stream(const string& path){
+		int fd = (path == "-") ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY | O_NONBLOCK);
+		if (fd < 0) return false;
+		reader = thread([this, fd, path](){
+			read_requests(fd);
+			if (path != "-") ::close(fd);
+			feed->close();
+		});
+		return true;
+	}
+
+	//Listens on a Unix socket at path (removed first if it exists); false if it cannot be created
+	bool start_socket(const string& path){
+		sockaddr_un address;
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		if (path.size() >= sizeof(address.sun_path)) return false;
+		strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+		listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if (listen_fd < 0) return false;
+		::unlink(path.c_str());
+		if (::bind(listen_fd, (sockaddr*)&address, sizeof(address)) < 0 || ::listen(listen_fd, 8) < 0){
+			::close(listen_fd);
+			listen_fd = -1;
+			return false;
+		}
+		socket_path = path;
+		reader = thread([this](){
+			while (true){
+				bool readable;
+				if (!wait_readable(listen_fd, readable)) break;
+				if (!readable) continue;
+				int connection = ::accept(listen_fd, nullptr, nullptr);
+				if (connection < 0) continue;
+				bool more = read_requests(connection);
+				::close(connection);
+				if (!more) break;
+			}
+			feed->close();
+		});
+		return true;
+	}
+
+	void stop(){
+		stopping.store(true);
+		if (reader.joinable()) reader.join();
+		if (listen_fd >= 0){
+			::close(listen_fd);
+			::unlink(socket_path.c_str());
+			listen_fd = -1;
+		}
+		feed->close();
+	}
+};
+
+
+/***** (2) Report *****/
+//Push -> startOut latency of the requests sent so far
+inline void print_live_latency(ostream& os, const Live_Feed& feed){
+	const Latency_Histogram& h = feed.latency_us;
+	os << "requests: " << feed.pushed.load() << " pushed, " << feed.injected << " injected, " << feed.dropped.load() <<
+		" dropped" << endl;
+	os << "ingestion -> startIn latency (ms): mean " << fixed << setprecision(3) << h.mean()/1000.0 << "   p50 " <<
+		h.quantile(0.5)/1000.0 << "   p99 " << h.quantile(0.99)/1000.0 << "   max " << h.max()/1000.0 << defaultfloat << endl;
+}
+
+#endif //_LIVE_INGESTION_HPP__
\ No newline at end of file
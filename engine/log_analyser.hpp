@@ -0,0 +1,464 @@
+#ifndef _LOG_ANALYSER_HPP__
+#define _LOG_ANALYSER_HPP__
+
+//C++ libraries
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "chunked_log.hpp"
+#include "../data_structures/histogram.hpp"
+
+using namespace std;
+
+
+/***** (1) Mapped log files *****/
+//Read-only memory map of a whole file: the pages are read by the kernel as the scan reaches them, without a copy
+class Mapped_File{
+	const char* bytes = nullptr;
+	size_t length = 0;
+
+public:
+	string error;
+
+	Mapped_File() = default;
+	Mapped_File(const Mapped_File&) = delete;
+	Mapped_File& operator=(const Mapped_File&) = delete;
+
+	~Mapped_File(){
+		if (bytes != nullptr) munmap((void*)bytes, length);
+	}
+
+	//false if the file cannot be mapped (an empty file is mapped as no bytes)
+	bool open(const string& path){
+		int fd = ::open(path.c_str(), O_RDONLY);
+		struct stat info;
+		if (fd < 0 || fstat(fd, &info) != 0){
+			if (fd >= 0) ::close(fd);
+			error = "cannot open " + path;
+			return false;
+		}
+		length = (size_t)info.st_size;
+		if (length > 0){
+			void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (p == MAP_FAILED){
+				::close(fd);
+				length = 0;
+				error = "cannot map " + path;
+				return false;
+			}
+			madvise(p, length, MADV_SEQUENTIAL);
+			bytes = (const char*)p;
+		}
+		::close(fd);
+		return true;
+	}
+
+	const char* data() const{ return bytes; }
+	size_t size() const{ return length; }
+};
+
+
+/***** (2) Aggregates of a part of a log *****/
+//A part is a range of a log that starts at a time line (or at the start of the log), so that every part can be scanned
+//on its own thread. What cannot be finished inside a part (the loadOut of a material unloaded in a later part, the
+//phase of a model until its next state) is kept in order and completed when the parts are merged.
+struct Log_Event{
+	string cell;				//model name without "control" or "storage": control_l0_s1 and storage_l0_s1 are cell "_l0_s1"
+	long long material;
+	long long ms;
+	bool load;					//loadOut of the control model, otherwise unloadedOut of the storage model (its unloadedIn)
+};
+
+struct Phase_Track{
+	long long first_ms = -1;	//first state of the model in the part
+	string first_phase;
+	long long since_ms = -1;	//last state of the model in the part
+	string phase;
+	map<string, long long> residency_ms;	//between states inside the part
+};
+
+struct Log_Part{
+	map<string, map<string, long long>> messages;		//model -> port -> messages
+	vector<Log_Event> events;							//in log order
+	map<string, Phase_Track> phases;					//model -> phases
+	long long first_ms = -1, last_ms = -1;
+	long long lines = 0;
+	long long bytes = 0;
+};
+
+//Scans [begin, end) line by line. The lines are found with memchr (vectorised by the C library), and only the first
+//bytes of a line decide whether it is parsed: a time line, a message line "[port: {...}, ...] generated by model X",
+//"State for model X is ..." or the "\tphase: ..." line that follows it. Names point into the text until the part ends.
+inline void scan_log_part(const char* begin, const char* end, Log_Part& part){
+	struct Port_Count{
+		string_view name;
+		long long messages;
+	};
+	struct Phase_View{
+		long long first_ms = -1;
+		string_view first_phase;
+		long long since_ms = -1;
+		string_view phase;
+		vector<pair<string_view, long long>> residency_ms;
+	};
+	unordered_map<string_view, vector<Port_Count>> ports;
+	unordered_map<string_view, Phase_View> phases;
+	string_view state_model;						//model of the last "State for model" line
+	long long ms = -1;
+	static const string_view GENERATED = "] generated by model ";
+	static const string_view STATE = "State for model ";
+	static const string_view PHASE = "\tphase: ";
+	static const string_view MATERIAL = "Material unit ";
+
+	const char* line = begin;
+	while (line < end){
+		const char* newline = (const char*)memchr(line, '\n', end - line);
+		const char* line_end = (newline != nullptr) ? newline : end;
+		const char* next = (newline != nullptr) ? newline + 1 : end;
+		if (line_end > line && line_end[-1] == '\r') line_end--;
+		size_t size = line_end - line;
+		part.lines++;
+		string_view model_after_state = state_model;
+		state_model = string_view();
+		if (size == 0){
+			line = next;
+			continue;
+		}
+		char first = line[0];
+
+		if (first >= '0' && first <= '9'){
+			long long t = log_time_line_ms(line, size);
+			if (t >= 0){
+				ms = t;
+				if (part.first_ms < 0) part.first_ms = t;
+				part.last_ms = t;
+			}
+
+		} else if (first == '['){
+			//the model is after the last ']'
+			string_view text(line, size);
+			size_t close = text.rfind(']');
+			if (close == string_view::npos || text.compare(close, GENERATED.size(), GENERATED) != 0){
+				line = next;
+				continue;
+			}
+			string_view model = text.substr(close + GENERATED.size());
+			vector<Port_Count>& counts = ports[model];
+			bool control = model.compare(0, 7, "control") == 0, storage = model.compare(0, 7, "storage") == 0;
+			size_t pos = 1, index = 0;
+			while (pos < close){
+				size_t colon = text.find(": {", pos);
+				if (colon == string_view::npos || colon > close) break;
+				string_view port = text.substr(pos, colon - pos);
+				size_t short_start = port.rfind("::");
+				string_view short_port = (short_start == string_view::npos) ? port : port.substr(short_start + 2);
+				//messages: items at depth 1 separated by ", "
+				size_t i = colon + 3, item = i;
+				int depth = 1;
+				long long messages = 0;
+				bool empty = true;
+				bool events = (control && short_port == "loadOut") || (storage && short_port == "unloadedOut");
+				for (; i < close && depth > 0; i++){
+					char c = text[i];
+					if (depth == 1 && (c == '}' || (c == ',' && i + 1 < close && text[i + 1] == ' '))){
+						if (!empty){
+							messages++;
+							if (events && text.compare(item, MATERIAL.size(), MATERIAL) == 0){
+								long long material = 0;
+								for (size_t d = item + MATERIAL.size(); d < i && text[d] >= '0' && text[d] <= '9'; d++){
+									material = material*10 + (text[d] - '0');
+								}
+								part.events.push_back({string(model.substr(7)), material, ms, control});
+							}
+						}
+						if (c == '}'){
+							depth = 0;
+						} else {
+							item = i + 2;
+							i++;
+						}
+						empty = true;
+						continue;
+					}
+					if (c == '{') depth++;
+					else if (c == '}') depth--;
+					if (c != ' ') empty = false;
+				}
+				//the ports of a model come in the same order on every line
+				if (index < counts.size() && counts[index].name == short_port){
+					counts[index].messages += messages;
+				} else {
+					auto found = find_if(counts.begin(), counts.end(), [&](const Port_Count& p){ return p.name == short_port; });
+					if (found == counts.end()) counts.push_back({short_port, messages});
+					else found->messages += messages;
+				}
+				index++;
+				pos = i;
+				if (pos + 1 < close && text[pos] == ',' && text[pos + 1] == ' ') pos += 2;
+			}
+
+		} else if (first == 'S' && size > STATE.size() && string_view(line, STATE.size()) == STATE){
+			string_view rest(line + STATE.size(), size - STATE.size());
+			state_model = rest.substr(0, rest.find(' '));
+
+		} else if (first == '\t' && !model_after_state.empty() && size > PHASE.size() && string_view(line, PHASE.size()) == PHASE){
+			string_view rest(line + PHASE.size(), size - PHASE.size());
+			string_view phase = rest.substr(0, rest.find(' '));
+			Phase_View& p = phases[model_after_state];
+			if (p.first_ms < 0){
+				p.first_ms = ms;
+				p.first_phase = phase;
+			} else {
+				auto found = find_if(p.residency_ms.begin(), p.residency_ms.end(), [&](const pair<string_view, long long>& r){ return r.first == p.phase; });
+				if (found == p.residency_ms.end()) p.residency_ms.push_back({p.phase, ms - p.since_ms});
+				else found->second += ms - p.since_ms;
+			}
+			p.since_ms = ms;
+			p.phase = phase;
+		}
+		line = next;
+	}
+	part.bytes += end - begin;
+
+	//names are copied out of the text before it goes away
+	for (auto& m : ports){
+		map<string, long long>& counts = part.messages[string(m.first)];
+		for (auto& p : m.second) counts[string(p.name)] += p.messages;
+	}
+	for (auto& m : phases){
+		Phase_Track& t = part.phases[string(m.first)];
+		t.first_ms = m.second.first_ms;
+		t.first_phase = string(m.second.first_phase);
+		t.since_ms = m.second.since_ms;
+		t.phase = string(m.second.phase);
+		for (auto& r : m.second.residency_ms) t.residency_ms[string(r.first)] += r.second;
+	}
+}
+
+//Offsets at which the text is cut in about "parts" parts, each one starting at a time line
+inline vector<size_t> split_at_time_lines(const char* data, size_t size, size_t parts){
+	vector<size_t> cuts(1, 0);
+	for (size_t k = 1; k < parts; k++){
+		size_t target = max(cuts.back() + 1, size*k/parts);
+		const char* p = (target < size) ? (const char*)memchr(data + target, '\n', size - target) : nullptr;
+		while (p != nullptr){
+			const char* line = p + 1;
+			const char* line_end = (const char*)memchr(line, '\n', data + size - line);
+			if (line_end == nullptr) line_end = data + size;
+			if (log_time_line_ms(line, line_end - line) >= 0) break;
+			p = (line_end < data + size) ? line_end : nullptr;
+		}
+		if (p == nullptr) break;
+		cuts.push_back(p + 1 - data);
+	}
+	cuts.push_back(size);
+	return cuts;
+}
+
+
+/***** (3) Analysis of whole logs *****/
+struct Log_Analysis{
+	map<string, map<string, long long>> messages;		//model -> port -> messages
+	Latency_Histogram load_to_unload_ms;				//loadOut of a material to the unloadedIn of the same material
+	long long unmatched_loads = 0;						//loadOut without its unloadedIn before the end of the log
+	map<string, map<string, long long>> residency_ms;	//model -> phase -> time in the phase
+	long long first_ms = -1, last_ms = -1;
+	long long lines = 0, bytes = 0, parts = 0;
+	unsigned threads = 0;
+	double seconds = 0;
+	string error;
+
+	//size of the logs and speed of the scan
+	void print_scan(ostream& os) const{
+		os << bytes/(1024*1024) << " MiB, " << lines << " lines in " << parts << " parts on " << threads << " threads: " <<
+			seconds*1000 << " ms (" << ((seconds > 0) ? bytes/seconds/(1024*1024) : 0.0) << " MiB/s)" << endl;
+	}
+
+	void print(ostream& os) const{
+		print_scan(os);
+		os << "MESSAGES PER PORT" << endl;
+		for (auto& m : messages){
+			for (auto& p : m.second) os << "\t" << m.first << "." << p.first << " " << p.second << endl;
+		}
+		os << "LOADOUT TO UNLOADEDIN (ms)" << endl;
+		os << "\tmaterials " << load_to_unload_ms.count() << "   not unloaded " << unmatched_loads << "   mean " <<
+			load_to_unload_ms.mean() << "   min " << load_to_unload_ms.min() << "   p50 " << load_to_unload_ms.quantile(0.5) <<
+			"   p95 " << load_to_unload_ms.quantile(0.95) << "   p99 " << load_to_unload_ms.quantile(0.99) << "   max " <<
+			load_to_unload_ms.max() << endl;
+		os << "PHASE RESIDENCY (ms, share of the model's logged time)" << endl;
+		for (auto& m : residency_ms){
+			long long total = 0;
+			for (auto& p : m.second) total += p.second;
+			os << "\t" << m.first;
+			for (auto& p : m.second) os << "   " << p.first << " " << p.second << " (" << ((total > 0) ? 100.0*p.second/total : 0.0) << "%)";
+			os << endl;
+		}
+	}
+
+	void print_json(ostream& os) const{
+		os << "{\n  \"bytes\": " << bytes << ",\n  \"lines\": " << lines << ",\n  \"first_ms\": " << first_ms << ",\n  \"last_ms\": " <<
+			last_ms << ",\n  \"ports\": [";
+		bool first = true;
+		for (auto& m : messages){
+			for (auto& p : m.second){
+				os << ((first) ? "" : ",") << "\n    {\"model\": \"" << m.first << "\", \"port\": \"" << p.first << "\", \"messages\": " << p.second << "}";
+				first = false;
+			}
+		}
+		os << "\n  ],\n  \"load_to_unload_ms\": {\"count\": " << load_to_unload_ms.count() << ", \"unmatched\": " << unmatched_loads <<
+			", \"mean\": " << load_to_unload_ms.mean() << ", \"min\": " << load_to_unload_ms.min() << ", \"p50\": " <<
+			load_to_unload_ms.quantile(0.5) << ", \"p95\": " << load_to_unload_ms.quantile(0.95) << ", \"p99\": " <<
+			load_to_unload_ms.quantile(0.99) << ", \"max\": " << load_to_unload_ms.max() << "},\n  \"residency_ms\": [";
+		first = true;
+		for (auto& m : residency_ms){
+			for (auto& p : m.second){
+				os << ((first) ? "" : ",") << "\n    {\"model\": \"" << m.first << "\", \"phase\": \"" << p.first << "\", \"ms\": " << p.second << "}";
+				first = false;
+			}
+		}
+		os << "\n  ]\n}" << endl;
+	}
+};
+
+//Analyses one or more logs of the same run (typically its messages and state logs) in one pass: each text log is
+//memory-mapped and cut at time lines, each chunked log (".mclog") is taken chunk by chunk, and the parts are scanned on
+//"threads" threads. The parts of each log are then merged in log order.
+inline Log_Analysis analyse_logs(const vector<string>& paths, unsigned threads = thread::hardware_concurrency()){
+	auto begin = chrono::steady_clock::now();
+	Log_Analysis a;
+	if (threads == 0) threads = 1;
+	a.threads = threads;
+
+	struct Job{
+		size_t log;
+		const char* data;			//text, or compressed chunk
+		size_t size;
+		long long raw_bytes;		//-1: text
+	};
+	vector<unique_ptr<Mapped_File>> files;
+	vector<Job> jobs;
+	vector<size_t> first_job;		//of each log
+	for (size_t l = 0; l < paths.size(); l++){
+		const string& path = paths[l];
+		first_job.push_back(jobs.size());
+		files.emplace_back(new Mapped_File());
+		Mapped_File& file = *files.back();
+		if (!file.open(path)){
+			a.error = file.error;
+			return a;
+		}
+		bool chunked = path.size() > 6 && path.compare(path.size() - 6, 6, ".mclog") == 0;
+		if (chunked){
+			Chunked_Log_Reader reader;
+			if (!reader.open(path)){
+				a.error = reader.error;
+				return a;
+			}
+			for (auto& e : reader.index){
+				if (e.offset + e.compressed_bytes > (long long)file.size()){
+					a.error = path + " is shorter than its index";
+					return a;
+				}
+				jobs.push_back({l, file.data() + e.offset, (size_t)e.compressed_bytes, e.raw_bytes});
+			}
+		} else {
+			//a few parts per thread, of at least 1 MiB, so that threads finishing early take the remaining ones
+			size_t parts = max((size_t)1, min((size_t)threads*4, file.size() >> 20));
+			vector<size_t> cuts = split_at_time_lines(file.data(), file.size(), parts);
+			for (size_t k = 0; k + 1 < cuts.size(); k++) jobs.push_back({l, file.data() + cuts[k], cuts[k + 1] - cuts[k], -1});
+		}
+	}
+	first_job.push_back(jobs.size());
+
+	vector<Log_Part> parts(jobs.size());
+	vector<string> errors(jobs.size());
+	atomic<size_t> next(0);
+	auto worker = [&](){
+		string text;
+		for (size_t i = next++; i < jobs.size(); i = next++){
+			const Job& j = jobs[i];
+			if (j.raw_bytes < 0){
+				scan_log_part(j.data, j.data + j.size, parts[i]);
+				continue;
+			}
+			text.resize(j.raw_bytes);
+			uLongf size = j.raw_bytes;
+			if (uncompress((Bytef*)&text[0], &size, (const Bytef*)j.data, j.size) != Z_OK || (long long)size != j.raw_bytes){
+				errors[i] = "corrupt chunk in " + paths[j.log];
+				continue;
+			}
+			scan_log_part(text.data(), text.data() + text.size(), parts[i]);
+		}
+	};
+	unsigned pool_size = (unsigned)min((size_t)threads, max((size_t)1, jobs.size()));
+	vector<thread> pool;
+	for (unsigned t = 1; t < pool_size; t++) pool.emplace_back(worker);
+	worker();
+	for (auto& t : pool) t.join();
+	for (auto& e : errors){
+		if (!e.empty()){
+			a.error = e;
+			return a;
+		}
+	}
+
+	//merge in log order
+	map<pair<string, long long>, deque<long long>> loaded;		//(cell, material) -> loadOut times not yet unloaded
+	for (size_t l = 0; l + 1 < first_job.size(); l++){
+		map<string, Phase_Track> open;							//phase of each model at the end of the previous parts
+		long long log_last_ms = -1;
+		for (size_t i = first_job[l]; i < first_job[l + 1]; i++){
+			Log_Part& p = parts[i];
+			a.parts++;
+			a.lines += p.lines;
+			a.bytes += p.bytes;
+			if (p.first_ms >= 0 && (a.first_ms < 0 || p.first_ms < a.first_ms)) a.first_ms = p.first_ms;
+			a.last_ms = max(a.last_ms, p.last_ms);
+			if (p.last_ms >= 0) log_last_ms = p.last_ms;
+			for (auto& m : p.messages){
+				for (auto& c : m.second) a.messages[m.first][c.first] += c.second;
+			}
+			for (auto& e : p.events){
+				if (e.load){
+					loaded[{e.cell, e.material}].push_back(e.ms);
+					continue;
+				}
+				auto found = loaded.find({e.cell, e.material});
+				if (found == loaded.end() || found->second.empty()) continue;
+				a.load_to_unload_ms.record(max(0LL, e.ms - found->second.front()));
+				found->second.pop_front();
+			}
+			for (auto& m : p.phases){
+				map<string, long long>& residency = a.residency_ms[m.first];
+				Phase_Track& t = m.second;
+				auto previous = open.find(m.first);
+				if (previous != open.end()) residency[previous->second.phase] += t.first_ms - previous->second.since_ms;
+				for (auto& r : t.residency_ms) residency[r.first] += r.second;
+				open[m.first] = {t.first_ms, t.first_phase, t.since_ms, t.phase, {}};
+			}
+		}
+		//the last phase of every model lasts until the last step of the log
+		for (auto& m : open) a.residency_ms[m.first][m.second.phase] += max(0LL, log_last_ms - m.second.since_ms);
+	}
+	for (auto& l : loaded) a.unmatched_loads += l.second.size();
+	a.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+	return a;
+}
+
+#endif //_LOG_ANALYSER_HPP__
\ No newline at end of file
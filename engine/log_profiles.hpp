@@ -0,0 +1,150 @@
+#ifndef _LOG_PROFILES_HPP__
+#define _LOG_PROFILES_HPP__
+
+//Cadmium Simulator headers
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_message_bag.hpp>
+#include <cadmium/engine/pdevs_dynamic_engine.hpp>
+#include <cadmium/engine/pdevs_dynamic_simulator.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+//C++ libraries
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+using namespace std;
+using namespace cadmium;
+
+
+/***** (1) Profiles *****/
+//LOG_FULL: state and messages logs (the Cadmium loggers as they are)
+//LOG_MESSAGES: messages log only
+//LOG_SUMMARY: no logs, the statistics of the run at the end
+//LOG_NONE: no logs at all
+enum Log_Profile {LOG_FULL, LOG_MESSAGES, LOG_SUMMARY, LOG_NONE};
+
+inline const char* log_profile_name(int profile){
+	static const char* names[] = {"full", "messages", "summary", "none"};
+	return (profile >= 0 && profile <= LOG_NONE) ? names[profile] : "unknown";
+}
+
+//false if the name is not a profile
+inline bool read_log_profile(const string& name, int& profile){
+	for (int p = LOG_FULL; p <= LOG_NONE; p++){
+		if (name == log_profile_name(p)){
+			profile = p;
+			return true;
+		}
+	}
+	return false;
+}
+
+//Type carrier, to pick a logger at run time and instantiate the run with it: run(Logger_Type<L>())
+template<typename LOGGER>
+struct Logger_Type{
+	using type = LOGGER;
+};
+
+
+/***** (2) Profile logger *****/
+//LOGGER with the state and/or messages sources switched off at compile time. The Cadmium simulator turns the state
+//and the outputs of a model into strings before it calls the logger, whatever the logger keeps; the simulator below
+//is used with this logger instead, and only builds the strings of the sources that are on. With both off no string is
+//built and every call is empty.
+template<typename LOGGER, bool STATES, bool MESSAGES>
+struct Profile_Logger{
+	template<typename SOURCE>
+	static constexpr bool enabled(){
+		if (is_same<SOURCE, logger::logger_state>::value) return STATES;
+		if (is_same<SOURCE, logger::logger_messages>::value) return MESSAGES;
+		return STATES || MESSAGES;			//global time, and the info/debug sources LOGGER filters out anyway
+	}
+
+	template<typename DECLARED_SOURCE, typename LOG_TYPE, typename... PARAMs>
+	static void log(const PARAMs&... ps){
+		if constexpr (enabled<DECLARED_SOURCE>()) LOGGER::template log<DECLARED_SOURCE, LOG_TYPE>(ps...);
+	}
+};
+
+//No logs
+using Quiet_Logger = Profile_Logger<logger::not_logger, false, false>;
+
+namespace cadmium{ namespace dynamic{ namespace engine{
+
+//Same transitions as the Cadmium simulator; the state and output strings are only built for the sources that are on
+template<typename TIME, typename LOGGER, bool STATES, bool MESSAGES>
+class simulator<TIME, Profile_Logger<LOGGER, STATES, MESSAGES>> : public engine<TIME>{
+	using profile_logger = Profile_Logger<LOGGER, STATES, MESSAGES>;
+	shared_ptr<cadmium::dynamic::modeling::atomic_abstract<TIME>> _model;
+	TIME _last;
+	TIME _next;
+	cadmium::dynamic::message_bags _inbox;
+	cadmium::dynamic::message_bags _outbox;
+
+	void log_state(const TIME& t) const{
+		if constexpr (STATES){
+			profile_logger::template log<cadmium::logger::logger_state, cadmium::logger::sim_state>(t, _model->get_id(), _model->model_state_as_string());
+		}
+	}
+
+public:
+	explicit simulator(shared_ptr<cadmium::dynamic::modeling::atomic_abstract<TIME>> model) : _model(model){}
+
+	void init(TIME initial_time) override{
+		_last = initial_time;
+		_next = initial_time + _model->time_advance();
+		log_state(initial_time);
+	}
+
+	string get_model_id() const override{
+		return _model->get_id();
+	}
+
+	TIME next() const noexcept override{
+		return _next;
+	}
+
+	void collect_outputs(const TIME& t) override{
+		_outbox = cadmium::dynamic::message_bags();
+		if (_next < t) throw domain_error("Trying to obtain output in a higher time than the next scheduled internal event");
+		if (_next == t){
+			_outbox = _model->output();
+			if constexpr (MESSAGES){
+				profile_logger::template log<cadmium::logger::logger_messages, cadmium::logger::sim_messages_collect>(t, _model->get_id(),
+					_model->messages_by_port_as_string(_outbox));
+			}
+		}
+	}
+
+	cadmium::dynamic::message_bags& outbox() override{
+		return _outbox;
+	}
+
+	cadmium::dynamic::message_bags& inbox() override{
+		return _inbox;
+	}
+
+	void advance_simulation(const TIME& t) override{
+		_outbox = cadmium::dynamic::message_bags();
+		if (t < _last) throw domain_error("Event received for executing in the past of current simulation time");
+		if (_next < t) throw domain_error("Event received for executing after next internal event");
+		if (!_inbox.empty()){
+			if (t == _next) _model->confluence_transition(t - _last, _inbox);
+			else _model->external_transition(t - _last, _inbox);
+			_last = t;
+			_next = _last + _model->time_advance();
+			_inbox = cadmium::dynamic::message_bags();
+		} else if (t == _next){
+			_model->internal_transition();
+			_last = t;
+			_next = _last + _model->time_advance();
+		}
+		log_state(t);
+	}
+};
+
+}}}
+
+#endif //_LOG_PROFILES_HPP__
\ No newline at end of file
@@ -0,0 +1,157 @@
+#ifndef _MCCS_RUNNER_HPP__
+#define _MCCS_RUNNER_HPP__
+
+//Cadmium Simulator headers
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_message_bag.hpp>
+#include <cadmium/engine/pdevs_dynamic_coordinator.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+#include "profiler.hpp"
+
+//C++ libraries
+#include <limits>
+#include <memory>
+#include <vector>
+
+using namespace std;
+using namespace cadmium;
+
+
+/***** (1) Observer interface *****/
+//Attached to an MCCS_Runner, an observer sees the top model outputs and the time of every step,
+//so it can read the model states it is interested in without any state logging
+template<typename TIME>
+class Run_Observer{
+public:
+	virtual ~Run_Observer() = default;
+	virtual void start(const TIME& t){}													//attached at time t
+	virtual void outputs(const TIME& t, const dynamic::message_bags& top_outbox){}		//outputs of the TOP model at t
+	virtual void step(const TIME& t){}														//all transitions at t done
+};
+
+//Observer that can end a run early (see engine/stop_conditions.hpp). Checked after every step, so it must be O(1).
+template<typename TIME>
+class Stop_Condition : public Run_Observer<TIME>{
+public:
+	virtual bool reached(const TIME& next) = 0;			//next: time of the next scheduled event
+};
+
+//Holds each step until its time has come, e.g. on the wall clock (see engine/real_time.hpp)
+template<typename TIME>
+class Run_Pacer{
+public:
+	virtual ~Run_Pacer() = default;
+	virtual void start(const TIME& t){}					//set at time t
+	virtual void wait(const TIME& t) = 0;				//returns when the step at t may run
+};
+
+//Runs the output and transition functions of the atomic models of a step itself, e.g. on a thread pool, while the
+//coordinators still route the messages (see engine/parallel_step.hpp)
+template<typename TIME>
+class Step_Executor{
+public:
+	virtual ~Step_Executor() = default;
+	virtual void outputs(const TIME& t) = 0;			//before the coordinators collect the outputs at t
+	virtual bool transitions(const TIME& t) = 0;		//after they routed the messages; true: advance once more to commit
+};
+
+
+/***** (2) Runner *****/
+//Same loop as dynamic::engine::runner, with observers called at every step
+template<typename TIME, typename LOGGER>
+class MCCS_Runner{
+	TIME _last;				//time of the last step (initial time before the first one)
+	TIME _next;				//next scheduled event
+	dynamic::engine::coordinator<TIME, LOGGER> _top_coordinator;
+	vector<shared_ptr<Run_Observer<TIME>>> _observers;
+	shared_ptr<Run_Pacer<TIME>> _pacer;		//none: as fast as possible
+	shared_ptr<Step_Executor<TIME>> _executor;	//none: the coordinators run the models
+	bool _stopped = false;	//the last run ended on its stop condition
+	long long _steps = 0;
+
+public:
+	MCCS_Runner(shared_ptr<dynamic::modeling::coupled<TIME>> coupled_model, const TIME& init_time)
+		: _last(init_time), _top_coordinator(coupled_model){
+		LOGGER::template log<logger::logger_info, logger::run_info>("Preparing model");
+		LOGGER::template log<logger::logger_global_time, logger::run_global_time>(init_time);
+		_top_coordinator.init(init_time);
+		_next = _top_coordinator.next();
+	}
+
+	void attach(shared_ptr<Run_Observer<TIME>> observer){
+		_observers.push_back(observer);
+		observer->start(_last);
+	}
+
+	//Every following step waits for the pacer first
+	void pace(shared_ptr<Run_Pacer<TIME>> pacer){
+		_pacer = pacer;
+		if (_pacer) _pacer->start(_last);
+	}
+
+	//The models of every following step are run by the executor
+	void execute(shared_ptr<Step_Executor<TIME>> executor){
+		_executor = executor;
+	}
+
+	//Runs until t or, if a stop condition is given, until it is reached (it is attached as an observer)
+	TIME run_until(const TIME& t, shared_ptr<Stop_Condition<TIME>> stop = nullptr){
+		LOGGER::template log<logger::logger_info, logger::run_info>("Starting run");
+		if (stop) attach(stop);
+		_stopped = (stop && stop->reached(_next));
+		while (_next < t && !_stopped){
+			step();
+			_stopped = (stop && stop->reached(_next));
+		}
+		if (stop) _observers.pop_back();
+		LOGGER::template log<logger::logger_info, logger::run_info>("Finished run");
+		return _next;
+	}
+
+	//Runs the single step at next() (once the pacer allows it, if any) and returns the time of the following one
+	TIME step(){
+		if (_pacer) _pacer->wait(_next);
+		LOGGER::template log<logger::logger_global_time, logger::run_global_time>(_next);
+		{
+			MCCS_PROFILE_SCOPE("runner", PROFILE_COLLECT);
+			if (_executor) _executor->outputs(_next);
+			_top_coordinator.collect_outputs(_next);
+		}
+		for (auto& o : _observers) o->outputs(_next, _top_coordinator.outbox());
+		{
+			MCCS_PROFILE_SCOPE("runner", PROFILE_ADVANCE);
+			_top_coordinator.advance_simulation(_next);
+			if (_executor && _executor->transitions(_next)) _top_coordinator.advance_simulation(_next);
+		}
+		for (auto& o : _observers) o->step(_next);
+		_last = _next;
+		_next = _top_coordinator.next();
+		_steps++;
+		return _next;
+	}
+
+	void run_until_passivate(){
+		run_until(numeric_limits<TIME>::infinity());
+	}
+
+	//time of the last executed step
+	TIME last() const{
+		return _last;
+	}
+
+	TIME next() const{
+		return _next;
+	}
+
+	bool stopped() const{
+		return _stopped;
+	}
+
+	//steps run since the runner was created
+	long long steps() const{
+		return _steps;
+	}
+};
+
+#endif //_MCCS_RUNNER_HPP__
\ No newline at end of file
@@ -0,0 +1,376 @@
+#ifndef _MODEL_BUILDER_HPP__
+#define _MODEL_BUILDER_HPP__
+
+//Cadmium Simulator headers
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/xml_parser.hpp>
+
+//Atomic model headers
+#include "../atomics/control.hpp"
+#include "../atomics/storage.hpp"
+#include "../atomics/handling.hpp"
+#include "../atomics/generator.hpp"
+#include "../atomics/transfer.hpp"
+#include "../atomics/schedule_reader.hpp"
+#include "../atomics/dispatcher.hpp"
+#include "../atomics/line_gate.hpp"
+
+#include "../data_structures/message.hpp"
+#include "../data_structures/timing.hpp"
+#include "../data_structures/input_schedule.hpp"
+#include "../data_structures/dispatch_message.hpp"
+
+//C++ libraries
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>				//mallinfo2
+#endif
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace cadmium;
+
+
+/***** (1) Plant description *****/
+//Layout of a plant, read from an XML file instead of being hand-coded (see input_data/MCCS_plant_example.xml):
+//	<Plant name="example" lines="4">
+//		<Input type="file" path="../input_data/MCCS_input_test_startIn.txt"/>
+//		<Stage name="prep" config="../input_data/MCCS_config_test.txt"/>
+//		<Stage name="pack" loading_time="constant 1" moving_time="uniform 3 4" seed="7"/>
+//	</Plant>
+//Each line is an input (shared schedule reader or generator) feeding a chain of MCCS cells, one per stage; between two stages a
+//Transfer turns every prepared material into a request downstream. Lines are independent copies of the same chain.
+//With <Dispatcher policy="round_robin|least_wip|earliest_completion"/>, the plant has a single input instead, and a
+//Dispatcher sends each of its batches to one line (see atomics/dispatcher.hpp) through the Line_Gate of that line.
+//MCCS_ModelDescription.xml describes the models and their ports; this file only gives how many of them and how they are coupled.
+struct Plant_stage{
+	string name;
+	MCCS_config config;			//timings of the Storage and Handling of the stage
+};
+
+struct Plant_description{
+	string name;
+	long long lines;
+	bool generated;				//input: a generator per line (seed + line number) or the file path
+	string input_path;
+	Generator_config generator;
+	vector<Plant_stage> stages;
+	uint64_t replication;		//random number streams of the stages and generators, 0 = those of a single run
+	int dispatch;				//Dispatch_Policy, DISPATCH_NONE: an input per line
+	string error;				//why read() failed
+
+	Plant_description() : lines(1), generated(false), replication(0), dispatch(DISPATCH_NONE){}
+
+	bool read(const char* file_path){
+		using boost::property_tree::ptree;
+		try {
+			ptree tree;
+			boost::property_tree::read_xml(file_path, tree);
+			const ptree& plant = tree.get_child("Plant");
+			name = plant.get<string>("<xmlattr>.name", "plant");
+			lines = plant.get<long long>("<xmlattr>.lines", 1);
+			if (lines < 1) return fail("lines must be at least 1");
+
+			const ptree& input = plant.get_child("Input");
+			string type = input.get<string>("<xmlattr>.type");
+			if (type == "file"){
+				generated = false;
+				input_path = input.get<string>("<xmlattr>.path");
+				if (!ifstream(input_path).is_open()) return fail("cannot open the input " + input_path);
+			} else if (type == "generator"){
+				generated = true;
+				string arrival = input.get<string>("<xmlattr>.arrival", "poisson");
+				if (arrival == "deterministic"){
+					generator.arrival = 0;
+				} else if (arrival == "poisson"){
+					generator.arrival = 1;
+				} else if (arrival == "bursty"){
+					generator.arrival = 2;
+				} else {
+					return fail("unknown arrival process " + arrival);
+				}
+				generator.mean_interarrival = input.get<double>("<xmlattr>.mean_interarrival", generator.mean_interarrival);
+				generator.batch_min = input.get<int>("<xmlattr>.batch_min", generator.batch_min);
+				generator.batch_max = input.get<int>("<xmlattr>.batch_max", generator.batch_max);
+				generator.seed = input.get<uint64_t>("<xmlattr>.seed", generator.seed);
+				generator.max_batches = input.get<long long>("<xmlattr>.max_batches", generator.max_batches);
+			} else {
+				return fail("unknown input type " + type);
+			}
+
+			auto dispatcher = plant.get_child_optional("Dispatcher");
+			dispatch = DISPATCH_NONE;
+			if (dispatcher){
+				string policy = dispatcher->get<string>("<xmlattr>.policy", "round_robin");
+				if (!read_dispatch_policy(policy, dispatch)) return fail("unknown dispatch policy " + policy);
+			}
+
+			set<string> names;
+			for (const auto& child : plant){
+				if (child.first != "Stage") continue;
+				const ptree& s = child.second;
+				Plant_stage stage;
+				stage.name = s.get<string>("<xmlattr>.name");
+				if (!names.insert(stage.name).second) return fail("duplicate stage " + stage.name);
+				auto config = s.get_optional<string>("<xmlattr>.config");
+				if (config && !stage.config.read(config->c_str())) return fail("invalid configuration file " + *config);
+				auto loading = s.get_optional<string>("<xmlattr>.loading_time");
+				if (loading && !read_timing(*loading, stage.config.loading)) return fail("invalid loading_time " + *loading);
+				auto moving = s.get_optional<string>("<xmlattr>.moving_time");
+				if (moving && !read_timing(*moving, stage.config.moving)) return fail("invalid moving_time " + *moving);
+				stage.config.seed = s.get<uint64_t>("<xmlattr>.seed", stage.config.seed);
+				stages.push_back(stage);
+			}
+			if (stages.empty()) return fail("a plant needs at least one Stage");
+		} catch (boost::property_tree::ptree_error& e){
+			return fail(e.what());
+		}
+		return true;
+	}
+
+	long long atomic_models() const{
+		long long shared = (dispatch == DISPATCH_NONE) ? 0 : 2;		//the input and the dispatcher
+		return shared + lines*(1 + 3*(long long)stages.size() + ((long long)stages.size() - 1));
+	}
+
+	//Expected time per material of a line: that of its slowest stage, which loads then moves each material
+	double service_seconds() const{
+		double slowest = 0;
+		for (auto& stage : stages) slowest = max(slowest, stage.config.loading.mean() + stage.config.moving.mean());
+		return slowest;
+	}
+
+private:
+	bool fail(const string& message){
+		error = message;
+		return false;
+	}
+
+	static bool read_timing(const string& text, Timing& timing){
+		istringstream is(text);
+		return timing.read(is);
+	}
+};
+
+
+/***** (2) Builder *****/
+struct Plant_defs{
+	//plant (TOP) and line outputs: the last stage of every line
+	struct out_mat_prepared : public out_port<int>{};
+	struct out_end : public out_port<int>{};
+	struct line_out_mat_prepared : public out_port<int>{};
+	struct line_out_end : public out_port<int>{};
+	//line behind a dispatcher
+	struct line_in_dispatch : public in_port<Dispatch_t>{};
+	struct line_out_feedback : public out_port<Line_Feedback_t>{};
+	//MCCS cell of a stage
+	struct mccs_in_start : public in_port<int>{};
+	struct mccs_out_mat_prepared : public out_port<int>{};
+	struct mccs_out_end : public out_port<int>{};
+	//Inventory handler of a stage
+	struct ih_in_load : public in_port<Message_t>{};
+	struct ih_in_prep : public in_port<Message_t>{};
+	struct ih_out_loaded : public out_port<Message_t>{};
+	struct ih_out_unloaded : public out_port<Message_t>{};
+};
+
+//All the lines replay the same start requests: the file is parsed once and shared (see data_structures/input_schedule.hpp)
+template<typename T>
+class Plant_Input_Reader : public Schedule_Reader<int, T>{
+public:
+	Plant_Input_Reader() = default;
+	Plant_Input_Reader(shared_ptr<const Input_Schedule<int, T>> schedule) : Schedule_Reader<int, T>(schedule){}
+};
+
+struct Plant_build_report{
+	long long atomic_models = 0;
+	long long coupled_models = 0;
+	double seconds = 0;				//wall-clock time of build_plant
+	long long memory_bytes = -1;	//heap (or resident memory) taken by the build, -1 if unknown
+
+	void print(ostream& os) const{
+		os << "Built " << atomic_models << " atomic and " << coupled_models << " coupled models in " << seconds*1000 << " ms";
+		if (memory_bytes >= 0) os << ", " << memory_bytes/1024 << " KiB";
+		os << endl;
+	}
+};
+
+//Heap in use with glibc (freed memory is reused, so the difference stays exact across builds),
+//otherwise the resident memory of the process on Linux, -1 elsewhere
+inline long long allocated_bytes(){
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+	struct mallinfo2 info = mallinfo2();
+	return (long long)(info.uordblks + info.hblkhd);
+#else
+	ifstream statm("/proc/self/statm");
+	long long size, resident;
+	if (!(statm >> size >> resident)) return -1;
+	return resident*sysconf(_SC_PAGESIZE);
+#endif
+}
+
+//Model ids: <model>_<stage>_<line>, e.g. control_prep_3 (lines from 1), line_3, input_3 and TOP.
+//With a dispatcher: input and dispatcher in TOP, and gate_3 instead of input_3.
+template<typename TIME>
+shared_ptr<dynamic::modeling::coupled<TIME>> build_plant(const Plant_description& plant, Plant_build_report* report = nullptr){
+	auto begin = chrono::steady_clock::now();
+	long long memory_before = allocated_bytes();
+	long long coupled_models = 1;
+	shared_ptr<const Input_Schedule<int, TIME>> schedule;
+	if (!plant.generated) schedule = Input_Schedule<int, TIME>::load(plant.input_path);
+
+	bool dispatched = (plant.dispatch != DISPATCH_NONE);
+	dynamic::modeling::Models lines;
+	dynamic::modeling::EOCs eocs_TOP;
+	dynamic::modeling::ICs ics_TOP;
+	lines.reserve(plant.lines + 2);
+	eocs_TOP.reserve(2*plant.lines);
+	if (dispatched){
+		/***** Single input of the plant and its dispatcher *****/
+		if (plant.generated){
+			Generator_config config = plant.generator;
+			if (plant.replication) config.seed = CounterRng(config.seed).split(plant.replication).key;
+			lines.push_back(dynamic::translate::make_dynamic_atomic_model<Generator, TIME, Generator_config>("input", move(config)));
+			ics_TOP.push_back(dynamic::translate::make_IC<Generator_defs::startOut, Dispatcher_defs::startIn>("input", "dispatcher"));
+		} else {
+			lines.push_back(dynamic::translate::make_dynamic_atomic_model
+				<Plant_Input_Reader, TIME, shared_ptr<const Input_Schedule<int, TIME>>>("input", shared_ptr<const Input_Schedule<int, TIME>>(schedule)));
+			ics_TOP.push_back(dynamic::translate::make_IC<Schedule_Reader_defs<int>::out, Dispatcher_defs::startIn>("input", "dispatcher"));
+		}
+		lines.push_back(dynamic::translate::make_dynamic_atomic_model<Dispatcher, TIME, int, int, double>("dispatcher",
+			(int)plant.lines, int(plant.dispatch), plant.service_seconds()));
+		ics_TOP.reserve(1 + 2*plant.lines);
+	}
+	for (long long l = 1; l <= plant.lines; l++){
+		string line_id = "line_" + to_string(l);
+		dynamic::modeling::Models submodels_line;
+		dynamic::modeling::ICs ics_line;
+
+		/***** Input of the line *****/
+		string input_id = ((dispatched) ? "gate_" : "input_") + to_string(l);
+		if (dispatched){
+			submodels_line.push_back(dynamic::translate::make_dynamic_atomic_model<Line_Gate, TIME, int>(input_id, int(l - 1)));
+		} else if (plant.generated){
+			Generator_config config = plant.generator;
+			config.seed += l - 1;
+			if (plant.replication) config.seed = CounterRng(config.seed).split(plant.replication).key;
+			submodels_line.push_back(dynamic::translate::make_dynamic_atomic_model
+				<Generator, TIME, Generator_config>(input_id, move(config)));
+		} else {
+			submodels_line.push_back(dynamic::translate::make_dynamic_atomic_model
+				<Plant_Input_Reader, TIME, shared_ptr<const Input_Schedule<int, TIME>>>(input_id, shared_ptr<const Input_Schedule<int, TIME>>(schedule)));
+		}
+
+		/***** One MCCS cell per stage *****/
+		string upstream;				//model feeding the next cell: the input, then the Transfer of each stage
+		for (size_t s = 0; s < plant.stages.size(); s++){
+			const Plant_stage& stage = plant.stages[s];
+			string suffix = "_" + stage.name + "_" + to_string(l);
+			string control_id = "control" + suffix, storage_id = "storage" + suffix, handling_id = "handling" + suffix;
+			string ih_id = "IH" + suffix, mccs_id = "MCCS" + suffix;
+
+			shared_ptr<dynamic::modeling::model> storage = dynamic::translate::make_dynamic_atomic_model
+				<Storage, TIME, Timing, map<int, Timing>>(storage_id, stage.config.storage_timing(storage_id.c_str(), plant.replication),
+				stage.config.storage_product_timings(storage_id.c_str(), plant.replication));
+			shared_ptr<dynamic::modeling::model> handling = dynamic::translate::make_dynamic_atomic_model
+				<Handling, TIME, Timing, map<int, Timing>>(handling_id, stage.config.handling_timing(handling_id.c_str(), plant.replication),
+				stage.config.handling_product_timings(handling_id.c_str(), plant.replication));
+			shared_ptr<dynamic::modeling::model> control = dynamic::translate::make_dynamic_atomic_model<Control, TIME>(control_id);
+
+			shared_ptr<dynamic::modeling::coupled<TIME>> IH = make_shared<dynamic::modeling::coupled<TIME>>(ih_id,
+				dynamic::modeling::Models{storage, handling},
+				dynamic::modeling::Ports{typeid(Plant_defs::ih_in_load), typeid(Plant_defs::ih_in_prep)},
+				dynamic::modeling::Ports{typeid(Plant_defs::ih_out_loaded), typeid(Plant_defs::ih_out_unloaded)},
+				dynamic::modeling::EICs{dynamic::translate::make_EIC<Plant_defs::ih_in_load, Storage_defs::loadIn>(storage_id),
+					dynamic::translate::make_EIC<Plant_defs::ih_in_prep, Handling_defs::prepIn>(handling_id)},
+				dynamic::modeling::EOCs{dynamic::translate::make_EOC<Storage_defs::loadedOut, Plant_defs::ih_out_loaded>(storage_id),
+					dynamic::translate::make_EOC<Storage_defs::unloadedOut, Plant_defs::ih_out_unloaded>(storage_id)},
+				dynamic::modeling::ICs{dynamic::translate::make_IC<Handling_defs::unloadOut, Storage_defs::unloadIn>(handling_id, storage_id)});
+
+			shared_ptr<dynamic::modeling::coupled<TIME>> MCCS = make_shared<dynamic::modeling::coupled<TIME>>(mccs_id,
+				dynamic::modeling::Models{control, IH},
+				dynamic::modeling::Ports{typeid(Plant_defs::mccs_in_start)},
+				dynamic::modeling::Ports{typeid(Plant_defs::mccs_out_mat_prepared), typeid(Plant_defs::mccs_out_end)},
+				dynamic::modeling::EICs{dynamic::translate::make_EIC<Plant_defs::mccs_in_start, Control_defs::startIn>(control_id)},
+				dynamic::modeling::EOCs{dynamic::translate::make_EOC<Control_defs::matPreparedOut, Plant_defs::mccs_out_mat_prepared>(control_id),
+					dynamic::translate::make_EOC<Control_defs::endOut, Plant_defs::mccs_out_end>(control_id)},
+				dynamic::modeling::ICs{dynamic::translate::make_IC<Control_defs::loadOut, Plant_defs::ih_in_load>(control_id, ih_id),
+					dynamic::translate::make_IC<Control_defs::prepOut, Plant_defs::ih_in_prep>(control_id, ih_id),
+					dynamic::translate::make_IC<Plant_defs::ih_out_loaded, Control_defs::loadedIn>(ih_id, control_id),
+					dynamic::translate::make_IC<Plant_defs::ih_out_unloaded, Control_defs::unloadedIn>(ih_id, control_id)});
+			submodels_line.push_back(MCCS);
+			coupled_models += 2;
+
+			if (s == 0 && dispatched){
+				ics_line.push_back(dynamic::translate::make_IC<Line_Gate_defs::startOut, Plant_defs::mccs_in_start>(input_id, mccs_id));
+			} else if (s == 0 && plant.generated){
+				ics_line.push_back(dynamic::translate::make_IC<Generator_defs::startOut, Plant_defs::mccs_in_start>(input_id, mccs_id));
+			} else if (s == 0){
+				ics_line.push_back(dynamic::translate::make_IC<Schedule_Reader_defs<int>::out, Plant_defs::mccs_in_start>(input_id, mccs_id));
+			} else {
+				ics_line.push_back(dynamic::translate::make_IC<Transfer_defs::startOut, Plant_defs::mccs_in_start>(upstream, mccs_id));
+			}
+			if (s + 1 < plant.stages.size()){
+				string transfer_id = "transfer" + suffix;
+				submodels_line.push_back(dynamic::translate::make_dynamic_atomic_model<Transfer, TIME>(transfer_id));
+				ics_line.push_back(dynamic::translate::make_IC<Plant_defs::mccs_out_mat_prepared, Transfer_defs::preparedIn>(mccs_id, transfer_id));
+				upstream = transfer_id;
+			} else {
+				upstream = mccs_id;
+			}
+		}
+
+		/***** Line coupled model: outputs of the last stage *****/
+		dynamic::modeling::Ports in_line, out_line = {typeid(Plant_defs::line_out_mat_prepared), typeid(Plant_defs::line_out_end)};
+		dynamic::modeling::EICs eics_line;
+		dynamic::modeling::EOCs eocs_line = {
+			dynamic::translate::make_EOC<Plant_defs::mccs_out_mat_prepared, Plant_defs::line_out_mat_prepared>(upstream),
+			dynamic::translate::make_EOC<Plant_defs::mccs_out_end, Plant_defs::line_out_end>(upstream)};
+		if (dispatched){		//the gate gets the dispatches and reports the progress of the last stage
+			in_line.push_back(typeid(Plant_defs::line_in_dispatch));
+			out_line.push_back(typeid(Plant_defs::line_out_feedback));
+			eics_line.push_back(dynamic::translate::make_EIC<Plant_defs::line_in_dispatch, Line_Gate_defs::dispatchIn>(input_id));
+			eocs_line.push_back(dynamic::translate::make_EOC<Line_Gate_defs::feedbackOut, Plant_defs::line_out_feedback>(input_id));
+			ics_line.push_back(dynamic::translate::make_IC<Plant_defs::mccs_out_mat_prepared, Line_Gate_defs::preparedIn>(upstream, input_id));
+			ics_line.push_back(dynamic::translate::make_IC<Plant_defs::mccs_out_end, Line_Gate_defs::endIn>(upstream, input_id));
+			ics_TOP.push_back(dynamic::translate::make_IC<Dispatcher_defs::startOut, Plant_defs::line_in_dispatch>("dispatcher", line_id));
+			ics_TOP.push_back(dynamic::translate::make_IC<Plant_defs::line_out_feedback, Dispatcher_defs::feedbackIn>(line_id, "dispatcher"));
+		}
+		shared_ptr<dynamic::modeling::coupled<TIME>> line = make_shared<dynamic::modeling::coupled<TIME>>(line_id,
+			submodels_line, in_line, out_line, eics_line, eocs_line, ics_line);
+		lines.push_back(line);
+		coupled_models++;
+		eocs_TOP.push_back(dynamic::translate::make_EOC<Plant_defs::line_out_mat_prepared, Plant_defs::out_mat_prepared>(line_id));
+		eocs_TOP.push_back(dynamic::translate::make_EOC<Plant_defs::line_out_end, Plant_defs::out_end>(line_id));
+	}
+
+	shared_ptr<dynamic::modeling::coupled<TIME>> TOP = make_shared<dynamic::modeling::coupled<TIME>>("TOP",
+		lines,
+		dynamic::modeling::Ports{},
+		dynamic::modeling::Ports{typeid(Plant_defs::out_mat_prepared), typeid(Plant_defs::out_end)},
+		dynamic::modeling::EICs{},
+		eocs_TOP,
+		ics_TOP);
+
+	if (report){
+		report->atomic_models = plant.atomic_models();
+		report->coupled_models = coupled_models;
+		report->seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		long long memory_after = allocated_bytes();
+		report->memory_bytes = (memory_before >= 0 && memory_after >= 0) ? memory_after - memory_before : -1;
+	}
+	return TOP;
+}
+
+#endif //_MODEL_BUILDER_HPP__
\ No newline at end of file
@@ -0,0 +1,478 @@
+#ifndef _PARALLEL_STEP_HPP__
+#define _PARALLEL_STEP_HPP__
+
+//Cadmium Simulator headers
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_message_bag.hpp>
+#include <cadmium/engine/pdevs_dynamic_engine.hpp>
+#include <cadmium/engine/pdevs_dynamic_simulator.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+#include "mccs_runner.hpp"
+#include "log_profiles.hpp"
+
+//C++ libraries
+#include <assert.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+using namespace cadmium;
+
+
+/***** (1) Work-stealing pool *****/
+//run(n, task) calls task(0) ... task(n - 1) on the calling thread and threads - 1 workers. The indices are dealt in
+//contiguous blocks, one deque per thread: each thread takes from the front of its own deque and, once it is empty,
+//steals from the back of the others', so a block of slow tasks is shared out. run returns when every task is done
+//and throws the first exception of a task, if any.
+class Work_Stealing_Pool{
+	struct Queue{
+		mutex m;
+		deque<size_t> tasks;
+	};
+	vector<unique_ptr<Queue>> queues;		//queue 0 is the caller's
+	vector<thread> workers;
+	mutex m;
+	condition_variable wake;
+	condition_variable done;
+	const function<void(size_t)>* job = nullptr;
+	atomic<size_t> remaining{0};
+	unsigned long long generation = 0;		//one per run
+	bool stopping = false;
+	exception_ptr error;
+	atomic<long long> stolen{0};
+
+public:
+	Work_Stealing_Pool(unsigned threads = thread::hardware_concurrency()){
+		if (threads == 0) threads = 1;
+		for (unsigned q = 0; q < threads; q++) queues.emplace_back(new Queue());
+		for (unsigned q = 1; q < threads; q++) workers.emplace_back([this, q](){ worker(q); });
+	}
+
+	~Work_Stealing_Pool(){
+		{
+			lock_guard<mutex> lock(m);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (auto& w : workers) w.join();
+	}
+
+	Work_Stealing_Pool(const Work_Stealing_Pool&) = delete;
+	Work_Stealing_Pool& operator=(const Work_Stealing_Pool&) = delete;
+
+	void run(size_t n, const function<void(size_t)>& task){
+		if (n == 0) return;
+		if (workers.empty()){
+			for (size_t i = 0; i < n; i++) task(i);
+			return;
+		}
+		{
+			lock_guard<mutex> lock(m);
+			job = &task;
+			error = nullptr;
+			remaining = n;
+			size_t threads = queues.size();
+			for (size_t q = 0; q < threads; q++){
+				lock_guard<mutex> queue_lock(queues[q]->m);
+				for (size_t i = n*q/threads; i < n*(q + 1)/threads; i++) queues[q]->tasks.push_back(i);
+			}
+			generation++;
+		}
+		wake.notify_all();
+		work(0);
+		unique_lock<mutex> lock(m);
+		done.wait(lock, [this](){ return remaining == 0; });
+		job = nullptr;
+		if (error) rethrow_exception(error);
+	}
+
+	unsigned threads() const{
+		return queues.size();
+	}
+
+	//tasks run by another thread than the one they were dealt to, since the pool was created
+	long long steals() const{
+		return stolen;
+	}
+
+private:
+	void worker(unsigned q){
+		unsigned long long seen = 0;
+		while (true){
+			{
+				unique_lock<mutex> lock(m);
+				wake.wait(lock, [this, seen](){ return stopping || generation != seen; });
+				if (stopping) return;
+				seen = generation;
+			}
+			work(q);
+		}
+	}
+
+	//own tasks from the front, then the others' from the back, until every deque is empty
+	void work(unsigned q){
+		size_t threads = queues.size();
+		while (true){
+			size_t i;
+			bool found = take(*queues[q], false, i);
+			for (size_t k = 1; !found && k < threads; k++){
+				found = take(*queues[(q + k) % threads], true, i);
+				if (found) stolen++;
+			}
+			if (!found) return;
+			try {
+				(*job)(i);
+			} catch (...){
+				lock_guard<mutex> lock(m);
+				if (!error) error = current_exception();
+			}
+			if (--remaining == 0){
+				lock_guard<mutex> lock(m);
+				done.notify_all();
+			}
+		}
+	}
+
+	static bool take(Queue& queue, bool back, size_t& i){
+		lock_guard<mutex> lock(queue.m);
+		if (queue.tasks.empty()) return false;
+		if (back){
+			i = queue.tasks.back();
+			queue.tasks.pop_back();
+		} else {
+			i = queue.tasks.front();
+			queue.tasks.pop_front();
+		}
+		return true;
+	}
+};
+
+
+/***** (2) Parallel logger *****/
+//LOGGER as it is; a run instantiated with Parallel_Logger<LOGGER> gets the simulator below for its atomic models,
+//whose output and transition functions a Parallel_Steps executor can then run on a pool
+template<typename LOGGER>
+struct Parallel_Logger{
+	template<typename DECLARED_SOURCE, typename LOG_TYPE, typename... PARAMs>
+	static void log(const PARAMs&... ps){
+		LOGGER::template log<DECLARED_SOURCE, LOG_TYPE>(ps...);
+	}
+};
+
+template<typename LOGGER>
+struct is_parallel_logger : false_type{};
+
+template<typename LOGGER>
+struct is_parallel_logger<Parallel_Logger<LOGGER>> : true_type{};
+
+//false if LOGGER is a Profile_Logger (see engine/log_profiles.hpp) with that source off: its strings are not built
+template<typename LOGGER, typename SOURCE>
+struct logs_source : true_type{};
+
+template<typename LOGGER, bool STATES, bool MESSAGES, typename SOURCE>
+struct logs_source<Profile_Logger<LOGGER, STATES, MESSAGES>, SOURCE>
+	: integral_constant<bool, Profile_Logger<LOGGER, STATES, MESSAGES>::template enabled<SOURCE>()>{};
+
+//Phases of a step, read by the simulators
+//PARALLEL_OFF: the simulators run the models when the coordinators call them, as the Cadmium simulator
+//PARALLEL_DEFER: the outputs were computed by the pool; the transitions are noted, to be run by the pool
+//PARALLEL_COMMIT: second advance of the coordinators, after the pool ran the transitions: the states are logged
+enum Parallel_Phase {PARALLEL_OFF, PARALLEL_DEFER, PARALLEL_COMMIT};
+
+template<typename TIME>
+class Parallel_Steps;
+
+//What the executor sees of a simulator, whatever its logger
+template<typename TIME>
+class Parallel_Atomic{
+public:
+	virtual ~Parallel_Atomic() = default;
+	virtual TIME next_event() const = 0;
+	virtual void run_output() = 0;							//lambda of an imminent model, kept for collect_outputs
+	virtual void run_transition(const TIME& t) = 0;		//the transition noted by advance_simulation
+	virtual void attach(Parallel_Steps<TIME>* steps) = 0;
+
+	//The simulator of each atomic model, enrolled by the simulators themselves (the coordinators create them)
+	static void enroll(const void* model, Parallel_Atomic<TIME>* simulator){
+		lock_guard<mutex> lock(registry_mutex());
+		registry()[model] = simulator;
+	}
+
+	static void withdraw(const void* model, Parallel_Atomic<TIME>* simulator){
+		lock_guard<mutex> lock(registry_mutex());
+		auto it = registry().find(model);
+		if (it != registry().end() && it->second == simulator) registry().erase(it);
+	}
+
+	static Parallel_Atomic<TIME>* find(const void* model){
+		lock_guard<mutex> lock(registry_mutex());
+		auto it = registry().find(model);
+		return (it != registry().end()) ? it->second : nullptr;
+	}
+
+private:
+	static map<const void*, Parallel_Atomic<TIME>*>& registry(){
+		static map<const void*, Parallel_Atomic<TIME>*> simulators;
+		return simulators;
+	}
+
+	static mutex& registry_mutex(){
+		static mutex m;
+		return m;
+	}
+};
+
+
+/***** (3) Step executor *****/
+//Runs the output functions of the imminent models of a step, then the transitions of the imminent models and of
+//the ones receiving messages, on a work-stealing pool. The coordinators still route every message, on the calling
+//thread and in their own order (the deterministic merge between the two phases), and log the states after the pool
+//is done, in a second advance: the run, the logs and the states are those of the sequential runner. Steps with
+//fewer imminent models than the threshold run sequentially (a hand-off in a cell, with ta = 0, is worth less than
+//waking the pool).
+//	MCCS_Runner<TIME, Parallel_Logger<LOGGER>> r(TOP, t0);
+//	r.execute(make_shared<Parallel_Steps<TIME>>(TOP, threads, threshold));
+//The simulators keep a pointer to the executor: it must not be replaced while the runner goes on.
+template<typename TIME>
+class Parallel_Steps : public Step_Executor<TIME>{
+	static const size_t GRAIN = 8;			//models per task
+	Work_Stealing_Pool pool;
+	size_t threshold;
+	vector<Parallel_Atomic<TIME>*> simulators;
+	vector<Parallel_Atomic<TIME>*> imminent;
+	vector<Parallel_Atomic<TIME>*> pending;
+	int phase = PARALLEL_OFF;
+	long long parallel = 0;
+	long long sequential = 0;
+	long long parallel_models = 0;
+
+public:
+	Parallel_Steps(shared_ptr<dynamic::modeling::model> top, unsigned threads = thread::hardware_concurrency(), size_t i_threshold = 64)
+		: pool(threads), threshold(max<size_t>(i_threshold, 1)){
+		find_simulators(top);
+		for (auto s : simulators) s->attach(this);
+	}
+
+	void outputs(const TIME& t) override{
+		phase = PARALLEL_OFF;
+		imminent.clear();
+		for (auto s : simulators){
+			if (s->next_event() == t) imminent.push_back(s);
+		}
+		if (imminent.size() < threshold){
+			sequential++;
+			return;
+		}
+		parallel++;
+		parallel_models += imminent.size();
+		pending.clear();
+		run_blocks(imminent.size(), [this](size_t i){ imminent[i]->run_output(); });
+		phase = PARALLEL_DEFER;
+	}
+
+	bool transitions(const TIME& t) override{
+		if (phase != PARALLEL_DEFER) return false;
+		run_blocks(pending.size(), [this, &t](size_t i){ pending[i]->run_transition(t); });
+		phase = PARALLEL_COMMIT;
+		return true;
+	}
+
+	//called by the simulators during the first advance of a parallel step
+	void defer(Parallel_Atomic<TIME>* simulator){
+		pending.push_back(simulator);
+	}
+
+	int current_phase() const{
+		return phase;
+	}
+
+	size_t models() const{
+		return simulators.size();
+	}
+
+	unsigned threads() const{
+		return pool.threads();
+	}
+
+	void print(ostream& os) const{
+		os << "Parallel steps: " << parallel << " on " << pool.threads() << " threads (" <<
+			((parallel) ? (double)parallel_models/parallel : 0.0) << " imminent models on average), " << sequential <<
+			" sequential (fewer than " << threshold << " imminent models), " << pool.steals() << " tasks stolen" << endl;
+	}
+
+private:
+	void find_simulators(shared_ptr<dynamic::modeling::model> model){
+		auto coupled = dynamic_pointer_cast<dynamic::modeling::coupled<TIME>>(model);
+		if (coupled){
+			for (auto& m : coupled->_models) find_simulators(m);
+			return;
+		}
+		Parallel_Atomic<TIME>* simulator = Parallel_Atomic<TIME>::find(model.get());
+		if (!simulator){
+			throw domain_error("No parallel simulator for " + model->get_id() + ": the runner must use a Parallel_Logger");
+		}
+		simulators.push_back(simulator);
+	}
+
+	void run_blocks(size_t n, function<void(size_t)> task){
+		size_t blocks = (n + GRAIN - 1)/GRAIN;
+		pool.run(blocks, [n, &task](size_t b){
+			for (size_t i = b*GRAIN; i < n && i < (b + 1)*GRAIN; i++) task(i);
+		});
+	}
+};
+
+
+/***** (4) Simulator *****/
+namespace cadmium{ namespace dynamic{ namespace engine{
+
+//Same transitions as the Cadmium simulator, run when the coordinators call it or, in a parallel step, by the pool
+template<typename TIME, typename LOGGER>
+class simulator<TIME, Parallel_Logger<LOGGER>> : public engine<TIME>, public Parallel_Atomic<TIME>{
+	shared_ptr<cadmium::dynamic::modeling::atomic_abstract<TIME>> _model;
+	TIME _last;
+	TIME _next;
+	cadmium::dynamic::message_bags _inbox;
+	cadmium::dynamic::message_bags _outbox;
+	Parallel_Steps<TIME>* _steps = nullptr;
+	cadmium::dynamic::message_bags _computed;		//output computed by the pool
+	bool _output_ready = false;
+	cadmium::dynamic::message_bags _deferred;		//inbox of the noted transition
+	bool _imminent = false;
+
+	int phase() const{
+		return (_steps) ? _steps->current_phase() : PARALLEL_OFF;
+	}
+
+	void log_state(const TIME& t) const{
+		if constexpr (logs_source<LOGGER, cadmium::logger::logger_state>::value){
+			LOGGER::template log<cadmium::logger::logger_state, cadmium::logger::sim_state>(t, _model->get_id(), _model->model_state_as_string());
+		}
+	}
+
+	void transition(const TIME& t, cadmium::dynamic::message_bags& inbox, bool imminent){
+		if (!inbox.empty()){
+			if (imminent) _model->confluence_transition(t - _last, inbox);
+			else _model->external_transition(t - _last, inbox);
+		} else {
+			_model->internal_transition();
+		}
+		_last = t;
+		_next = _last + _model->time_advance();
+		inbox = cadmium::dynamic::message_bags();
+	}
+
+public:
+	explicit simulator(shared_ptr<cadmium::dynamic::modeling::atomic_abstract<TIME>> model) : _model(model){
+		Parallel_Atomic<TIME>::enroll(_model.get(), this);
+	}
+
+	~simulator(){
+		Parallel_Atomic<TIME>::withdraw(_model.get(), this);
+	}
+
+	void init(TIME initial_time) override{
+		_last = initial_time;
+		_next = initial_time + _model->time_advance();
+		log_state(initial_time);
+	}
+
+	string get_model_id() const override{
+		return _model->get_id();
+	}
+
+	TIME next() const noexcept override{
+		return _next;
+	}
+
+	void collect_outputs(const TIME& t) override{
+		_outbox = cadmium::dynamic::message_bags();
+		if (_next < t) throw domain_error("Trying to obtain output in a higher time than the next scheduled internal event");
+		if (_next == t){
+			if (_output_ready){
+				swap(_outbox, _computed);
+				_computed = cadmium::dynamic::message_bags();
+				_output_ready = false;
+			} else {
+				_outbox = _model->output();
+			}
+			if constexpr (logs_source<LOGGER, cadmium::logger::logger_messages>::value){
+				LOGGER::template log<cadmium::logger::logger_messages, cadmium::logger::sim_messages_collect>(t, _model->get_id(),
+					_model->messages_by_port_as_string(_outbox));
+			}
+		}
+	}
+
+	cadmium::dynamic::message_bags& outbox() override{
+		return _outbox;
+	}
+
+	cadmium::dynamic::message_bags& inbox() override{
+		return _inbox;
+	}
+
+	void advance_simulation(const TIME& t) override{
+		_outbox = cadmium::dynamic::message_bags();
+		int p = phase();
+		if (p == PARALLEL_COMMIT){
+			//the transition (if any) is done; a second routing of the same inputs is dropped
+			_inbox = cadmium::dynamic::message_bags();
+			log_state(t);
+			return;
+		}
+		if (t < _last) throw domain_error("Event received for executing in the past of current simulation time");
+		if (_next < t) throw domain_error("Event received for executing after next internal event");
+		if (_inbox.empty() && t != _next){
+			if (p == PARALLEL_OFF) log_state(t);
+			return;
+		}
+		if (p == PARALLEL_DEFER){
+			swap(_deferred, _inbox);
+			_inbox = cadmium::dynamic::message_bags();
+			_imminent = (t == _next);
+			_next = t;							//until the pool has run the transition
+			_steps->defer(this);
+			return;
+		}
+		transition(t, _inbox, t == _next);
+		log_state(t);
+	}
+
+
+	/***** Parallel_Atomic *****/
+	TIME next_event() const override{
+		return _next;
+	}
+
+	void run_output() override{
+		_computed = _model->output();
+		_output_ready = true;
+	}
+
+	void run_transition(const TIME& t) override{
+		transition(t, _deferred, _imminent);
+	}
+
+	void attach(Parallel_Steps<TIME>* steps) override{
+		_steps = steps;
+	}
+};
+
+}}}
+
+#endif //_PARALLEL_STEP_HPP__
\ No newline at end of file
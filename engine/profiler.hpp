@@ -0,0 +1,285 @@
+#ifndef _PROFILER_HPP__
+#define _PROFILER_HPP__
+
+/***** HOT-PATH PROFILING *****/
+//Built with -DMCCS_PROFILING (make ... PROFILING=-DMCCS_PROFILING):
+//	- MCCS_PROFILED(Control) is an atomic model counting its dint/dext/dconf/lambda/ta calls and timing one call in
+//	  Profiler::sample_every with steady_clock,
+//	- MCCS_PROFILED_LOGGER(LOGGER) does the same for the logger and MCCS_PROFILE_SCOPE for a block of the runner,
+//	- timed calls also go to a per-thread trace buffer, exported as Chrome/Perfetto JSON.
+//Without the flag the macros give back the plain model/logger and an empty statement: no code is added.
+
+#ifdef MCCS_PROFILING
+
+//Cadmium Simulator headers
+#include <cadmium/modeling/message_bag.hpp>
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+
+//C++ libraries
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace cadmium;
+
+
+enum Profile_Kind {PROFILE_INT, PROFILE_EXT, PROFILE_CONF, PROFILE_OUT, PROFILE_TA,		//atomic models
+				   PROFILE_COLLECT, PROFILE_ADVANCE, PROFILE_LOG, PROFILE_KINDS};		//runner and logger
+
+//Counters of one atomic instance (or of the runner/logger). Relaxed atomics, so runs on several threads can share them.
+struct Profile_Slot{
+	string name;
+	atomic<uint64_t> calls[PROFILE_KINDS];
+	atomic<uint64_t> sampled[PROFILE_KINDS];
+	atomic<uint64_t> sampled_ns[PROFILE_KINDS];
+
+	Profile_Slot(const string& i_name) : name(i_name){
+		for (int k = 0; k < PROFILE_KINDS; k++){
+			calls[k] = 0;
+			sampled[k] = 0;
+			sampled_ns[k] = 0;
+		}
+	}
+};
+
+//One timed call
+struct Trace_Event{
+	const Profile_Slot* slot;
+	int kind;
+	int64_t start_ns;			//since the profiler was created
+	int64_t duration_ns;
+};
+
+struct Trace_Buffer{
+	static const size_t CAPACITY = 1 << 20;		//events kept per thread, later ones are only counted
+	vector<Trace_Event> events;
+	uint64_t dropped = 0;
+	int tid;
+};
+
+
+class Profiler{
+	mutex registry;
+	vector<unique_ptr<Profile_Slot>> slots;
+	vector<unique_ptr<Trace_Buffer>> buffers;
+	chrono::steady_clock::time_point origin = chrono::steady_clock::now();
+
+	Profiler() = default;
+
+public:
+	uint64_t sample_every = 8;				//time one call in sample_every (per instance and kind)
+
+	static Profiler& instance(){
+		static Profiler profiler;
+		return profiler;
+	}
+
+	static const char* kind_name(int kind){
+		static const char* names[PROFILE_KINDS] = {"dint", "dext", "dconf", "lambda", "ta", "collect_outputs", "advance_simulation", "log"};
+		return names[kind];
+	}
+
+	Profile_Slot* new_slot(const string& name){
+		lock_guard<mutex> lock(registry);
+		slots.emplace_back(new Profile_Slot(name));
+		return slots.back().get();
+	}
+
+	//slot shared by every caller with the same name (runner, logger)
+	Profile_Slot* global_slot(const string& name){
+		lock_guard<mutex> lock(registry);
+		for (auto& s : slots){
+			if (s->name == name) return s.get();
+		}
+		slots.emplace_back(new Profile_Slot(name));
+		return slots.back().get();
+	}
+
+	//buffer of the calling thread, registered on first use
+	Trace_Buffer& thread_buffer(){
+		thread_local Trace_Buffer* buffer = nullptr;
+		if (!buffer){
+			lock_guard<mutex> lock(registry);
+			buffers.emplace_back(new Trace_Buffer());
+			buffer = buffers.back().get();
+			buffer->tid = (int)buffers.size();
+		}
+		return *buffer;
+	}
+
+	int64_t now_ns() const{
+		return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - origin).count();
+	}
+
+	//Names the profiled atomic instances of a model tree after their ids (defined below)
+	template<typename TIME>
+	void name_instances(shared_ptr<dynamic::modeling::model> model);
+
+
+	/***** Reports *****/
+	//rows sorted by estimated total time (mean sampled cost x calls)
+	void print_report(ostream& os){
+		struct Row{ const Profile_Slot* slot; int kind; uint64_t calls; uint64_t sampled; double mean_ns; double total_ms; };
+		vector<Row> rows;
+		double all_ms = 0;
+		lock_guard<mutex> lock(registry);
+		for (auto& s : slots){
+			for (int k = 0; k < PROFILE_KINDS; k++){
+				uint64_t calls = s->calls[k], sampled = s->sampled[k];
+				if (!calls) continue;
+				double mean = (sampled) ? (double)s->sampled_ns[k]/sampled : 0.0;
+				rows.push_back({s.get(), k, calls, sampled, mean, mean*calls/1e6});
+				if (k != PROFILE_COLLECT && k != PROFILE_ADVANCE) all_ms += mean*calls/1e6;	//runner blocks contain the others
+			}
+		}
+		sort(rows.begin(), rows.end(), [](const Row& a, const Row& b){ return a.total_ms > b.total_ms; });
+		os << left << setw(28) << "instance" << setw(20) << "call" << setw(12) << "calls" << setw(12) << "sampled" <<
+			setw(12) << "mean[ns]" << setw(14) << "total[ms]" << endl;
+		for (auto& r : rows){
+			os << left << setw(28) << r.slot->name << setw(20) << kind_name(r.kind) << setw(12) << r.calls << setw(12) << r.sampled <<
+				setw(12) << (long long)r.mean_ns << setw(14) << r.total_ms << endl;
+		}
+		os << "models + logger: " << all_ms << " ms (estimated); the runner rows also include bag routing" << endl;
+		for (auto& b : buffers){
+			if (b->dropped) os << "thread " << b->tid << ": " << b->dropped << " trace events dropped" << endl;
+		}
+	}
+
+	//Chrome/Perfetto trace ("X" complete events, microseconds)
+	void print_trace(ostream& os){
+		lock_guard<mutex> lock(registry);
+		os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+		bool first = true;
+		for (auto& b : buffers){
+			for (auto& e : b->events){
+				os << ((first) ? "" : ",") << "\n{\"name\": \"" << e.slot->name << " " << kind_name(e.kind) <<
+					"\", \"cat\": \"" << kind_name(e.kind) << "\", \"ph\": \"X\", \"ts\": " << e.start_ns/1000.0 <<
+					", \"dur\": " << e.duration_ns/1000.0 << ", \"pid\": 1, \"tid\": " << b->tid << "}";
+				first = false;
+			}
+		}
+		os << "\n]}" << endl;
+	}
+};
+
+
+//Counts a call and, one time in sample_every, times it
+class Profile_Scope{
+	Profile_Slot* slot;
+	int kind;
+	int64_t start;					//-1 when not sampled
+
+public:
+	Profile_Scope(Profile_Slot* i_slot, int i_kind) : slot(i_slot), kind(i_kind), start(-1){
+		uint64_t n = slot->calls[kind].fetch_add(1, memory_order_relaxed);
+		if (n % Profiler::instance().sample_every == 0){
+			start = Profiler::instance().now_ns();
+		}
+	}
+
+	~Profile_Scope(){
+		if (start < 0) return;
+		Profiler& p = Profiler::instance();
+		int64_t duration = p.now_ns() - start;
+		slot->sampled[kind].fetch_add(1, memory_order_relaxed);
+		slot->sampled_ns[kind].fetch_add((uint64_t)duration, memory_order_relaxed);
+		Trace_Buffer& b = p.thread_buffer();
+		if (b.events.size() < Trace_Buffer::CAPACITY){
+			b.events.push_back({slot, kind, start, duration});
+		} else {
+			b.dropped++;
+		}
+	}
+};
+
+
+//Base of the profiled atomic models, so that they can be found in a model tree
+struct Profiled_Instance{
+	Profile_Slot* profile_slot = Profiler::instance().new_slot("unnamed");
+};
+
+//Profiled<Control>::model<TIME> is a Control<TIME> whose transitions, output and time advance are counted
+template<template<typename> class ATOMIC>
+struct Profiled{
+	template<typename TIME>
+	class model : public ATOMIC<TIME>, public Profiled_Instance{
+		using base = ATOMIC<TIME>;
+		using input_bags = typename make_message_bags<typename base::input_ports>::type;
+		using output_bags = typename make_message_bags<typename base::output_ports>::type;
+
+	public:
+		using base::base;				//same constructors as the model
+
+		void internal_transition(){
+			Profile_Scope scope(profile_slot, PROFILE_INT);
+			base::internal_transition();
+		}
+
+		void external_transition(TIME e, input_bags mbs){
+			Profile_Scope scope(profile_slot, PROFILE_EXT);
+			base::external_transition(e, move(mbs));
+		}
+
+		//the base confluence calls the base transitions, so they are not counted twice
+		void confluence_transition(TIME e, input_bags mbs){
+			Profile_Scope scope(profile_slot, PROFILE_CONF);
+			base::confluence_transition(e, move(mbs));
+		}
+
+		output_bags output() const{
+			Profile_Scope scope(profile_slot, PROFILE_OUT);
+			return base::output();
+		}
+
+		TIME time_advance() const{
+			Profile_Scope scope(profile_slot, PROFILE_TA);
+			return base::time_advance();
+		}
+	};
+};
+
+template<typename TIME>
+void Profiler::name_instances(shared_ptr<dynamic::modeling::model> model){
+	auto coupled = dynamic_pointer_cast<dynamic::modeling::coupled<TIME>>(model);
+	if (coupled){
+		for (auto& m : coupled->_models) name_instances<TIME>(m);
+		return;
+	}
+	Profiled_Instance* profiled = dynamic_cast<Profiled_Instance*>(model.get());
+	if (profiled) profiled->profile_slot->name = model->get_id();
+}
+
+//LOGGER whose calls are counted (all of them, including the ones the logger filters out)
+template<typename LOGGER>
+struct Profiled_Logger{
+	template<typename DECLARED_SOURCE, typename LOG_TYPE, typename... PARAMs>
+	static void log(const PARAMs&... ps){
+		static Profile_Slot* slot = Profiler::instance().global_slot("logger");
+		Profile_Scope scope(slot, PROFILE_LOG);
+		LOGGER::template log<DECLARED_SOURCE, LOG_TYPE>(ps...);
+	}
+};
+
+#define MCCS_PROFILED(ATOMIC) Profiled<ATOMIC>::model
+#define MCCS_PROFILED_LOGGER(LOGGER) Profiled_Logger<LOGGER>
+#define MCCS_PROFILE_SCOPE(NAME, KIND) \
+	static Profile_Slot* profile_slot_##KIND = Profiler::instance().global_slot(NAME); \
+	Profile_Scope profile_scope_##KIND(profile_slot_##KIND, KIND)
+
+#else
+
+#define MCCS_PROFILED(ATOMIC) ATOMIC
+#define MCCS_PROFILED_LOGGER(LOGGER) LOGGER
+#define MCCS_PROFILE_SCOPE(NAME, KIND)
+
+#endif //MCCS_PROFILING
+
+#endif //_PROFILER_HPP__
\ No newline at end of file
@@ -0,0 +1,103 @@
+#ifndef _REAL_TIME_HPP__
+#define _REAL_TIME_HPP__
+
+#include "mccs_runner.hpp"
+
+#include "../data_structures/histogram.hpp"
+#include "../data_structures/time_conversion.hpp"
+
+//C++ libraries
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include <stdint.h>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <thread>
+
+using namespace std;
+
+
+/***** (1) Options and report *****/
+struct Real_Time_Options{
+	double scale = 1.0;						//simulated seconds per wall-clock second (10: ten times faster than the cell)
+	int64_t spin_ns = 1000000;				//the last 1 ms before a step are spun instead of slept
+	int64_t tolerance_ns = 1000000;			//a step woken more than 1 ms after its time missed its deadline
+	int core = -1;							//core the simulation thread is pinned to, -1: not pinned
+};
+
+struct Real_Time_Report{
+	long long steps = 0;
+	long long misses = 0;					//steps that started later than the tolerance
+	Latency_Histogram jitter_ns;			//wake-up time - scheduled time of every step
+	bool pinned = false;
+	double wall_seconds = 0;				//from start() to the last step
+
+	void print(ostream& os, const Real_Time_Options& options) const{
+		streamsize precision = os.precision();
+		os << "real time x" << options.scale << ((pinned) ? ", pinned to core " + to_string(options.core) : string(", not pinned")) <<
+			": " << steps << " steps in " << fixed << setprecision(3) << wall_seconds << " s, " << misses << " deadline misses (> " <<
+			options.tolerance_ns/1000000.0 << " ms late)" << endl;
+		os << "wake-up jitter (us): mean " << jitter_ns.mean()/1000.0 << "   p50 " << jitter_ns.quantile(0.5)/1000.0 << "   p99 " <<
+			jitter_ns.quantile(0.99)/1000.0 << "   max " << jitter_ns.max()/1000.0 << defaultfloat << setprecision(precision) << endl;
+	}
+};
+
+
+/***** (2) Wall-clock pacer *****/
+//Ties the simulated time to the wall clock from the moment it is given to a runner: the step at t runs at
+//start + (t - t0)/scale. Each wait sleeps until spin_ns before that instant and spins the rest, since sleeps wake up
+//tens of microseconds late; the wake-up jitter of every step is recorded, and a step that cannot start in time (the
+//previous ones took too long) counts as a deadline miss and runs at once, so the run catches up instead of drifting.
+template<typename TIME>
+class Real_Time_Pacer : public Run_Pacer<TIME>{
+	Real_Time_Options options;
+	Real_Time_Report* report;
+	chrono::steady_clock::time_point origin;
+	long long origin_ms;
+
+public:
+	//report: filled during the run, must outlive it
+	Real_Time_Pacer(const Real_Time_Options& i_options, Real_Time_Report* i_report) : options(i_options), report(i_report), origin_ms(0){
+		assert(options.scale > 0 && "R - the time scale must be positive");
+	}
+
+	void start(const TIME& t) override{
+		report->pinned = pin(options.core);
+		origin = chrono::steady_clock::now();
+		origin_ms = time_to_milliseconds(t);
+	}
+
+	void wait(const TIME& t) override{
+		auto deadline = origin + chrono::nanoseconds((int64_t)((time_to_milliseconds(t) - origin_ms)*1e6/options.scale));
+		auto now = chrono::steady_clock::now();
+		if (deadline - now > chrono::nanoseconds(options.spin_ns)){
+			this_thread::sleep_until(deadline - chrono::nanoseconds(options.spin_ns));
+		}
+		while ((now = chrono::steady_clock::now()) < deadline){
+			this_thread::yield();		//spin, but let the ingestion threads run if they share the core
+		}
+		int64_t late = chrono::duration_cast<chrono::nanoseconds>(now - deadline).count();
+		report->jitter_ns.record(late);
+		if (late > options.tolerance_ns) report->misses++;
+		report->steps++;
+		report->wall_seconds = chrono::duration<double>(now - origin).count();
+	}
+
+	//Pins the calling thread (the one running the simulation); false if not pinned or not supported
+	static bool pin(int core){
+		if (core < 0) return false;
+#ifdef __linux__
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(core, &set);
+		return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+		return false;
+#endif
+	}
+};
+
+#endif //_REAL_TIME_HPP__
\ No newline at end of file
@@ -0,0 +1,207 @@
+#ifndef _REPLICATIONS_HPP__
+#define _REPLICATIONS_HPP__
+
+#include "sweep.hpp"					//sweep_simulate, Sweep_Result
+#include "confidence.hpp"
+
+//C++ libraries
+#include <assert.h>
+#include <math.h>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+
+/***** (1) Confidence intervals *****/
+//normal_quantile, student_t_quantile and Running_Estimate (see confidence.hpp)
+
+
+/***** (2) Replication plan *****/
+//How many replications to run: batches of "batch" replications (run in parallel) are added until the confidence
+//interval of the metric is narrower than the target, between min_replications and max_replications.
+//With several scenarios the target applies to the differences with the first one, which is what ranks them.
+enum Replication_Metric {REP_MAKESPAN = 0, REP_CYCLE_TIME, REP_THROUGHPUT, REP_WIP, REP_METRICS};
+
+struct Replication_Plan{
+	int metric = REP_CYCLE_TIME;
+	string until = "05:00:00:000";
+	double confidence = 0.95;
+	double half_width = 0;				//absolute target, in the unit of the metric; 0 = use relative_half_width
+	double relative_half_width = 0.05;	//target as a fraction of the mean of the (first) scenario
+	long long min_replications = 5;
+	long long max_replications = 1000;
+	unsigned batch = thread::hardware_concurrency();
+	//Common random numbers: replication r of every scenario uses the same random number streams, so that the
+	//differences between scenarios come from the scenarios and not from the draws
+	bool common_random_numbers = true;
+
+	static const char* metric_name(int metric){
+		static const char* names[REP_METRICS] = {"makespan", "cycle_time", "throughput", "wip"};
+		return names[metric];
+	}
+
+	bool set_metric(const string& name){
+		for (int m = 0; m < REP_METRICS; m++){
+			if (name == metric_name(m)){
+				metric = m;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//makespan and cycle time are -1 when no endOut or no complete cycle happened within the horizon
+	bool has_value(const Sweep_Result& r) const{
+		return value(r) >= 0;
+	}
+
+	double value(const Sweep_Result& r) const{
+		if (metric == REP_MAKESPAN) return r.makespan;
+		if (metric == REP_CYCLE_TIME) return r.cycle_time;
+		if (metric == REP_THROUGHPUT) return r.throughput;
+		return r.wip;
+	}
+
+	//replication index of the random number streams of replication r of scenario s
+	uint64_t stream(long long r, size_t s, size_t scenarios) const{
+		return (common_random_numbers) ? (uint64_t)r : (uint64_t)r*scenarios + s;
+	}
+};
+
+
+/***** (3) Replications *****/
+struct Scenario_Estimate{
+	string name;
+	vector<double> values;			//metric of each replication, in replication order
+	Running_Estimate metric;
+	Running_Estimate difference;	//paired differences with the first scenario
+};
+
+struct Replication_Report{
+	vector<Scenario_Estimate> scenarios;
+	long long replications = 0;		//per scenario
+	long long missing = 0;			//replications left out because a scenario did not produce the metric
+	bool converged = false;
+	string error;
+	double target = 0;				//half width reached (or aimed at, if not converged)
+	double seconds = 0;
+
+	void print(ostream& os, const Replication_Plan& plan) const{
+		os << replications << " replications per scenario (" << ((plan.common_random_numbers) ? "common" : "independent") <<
+			" random numbers), " << ((converged) ? "converged" : "NOT converged") << ", target half width " << target <<
+			", " << seconds << " s" << endl;
+		if (missing) os << missing << " replications without a " << Replication_Plan::metric_name(plan.metric) <<
+			" within " << plan.until << " left out" << endl;
+		size_t width = 24;
+		for (auto& e : scenarios) width = max(width, e.name.size() + 2);
+		os << left << setw(width) << "scenario" << setw(14) << Replication_Plan::metric_name(plan.metric) << setw(14) << "+/-" <<
+			setw(14) << "difference" << setw(14) << "+/-" << endl;
+		for (size_t s = 0; s < scenarios.size(); s++){
+			const Scenario_Estimate& e = scenarios[s];
+			os << left << setw(width) << e.name << setw(14) << e.metric.mean << setw(14) << e.metric.half_width(plan.confidence);
+			if (s) os << setw(14) << e.difference.mean << setw(14) << e.difference.half_width(plan.confidence);
+			os << endl;
+		}
+	}
+};
+
+//Runs replications of every scenario (each a resolved plant description) until the plan is met. The replications
+//of a batch run on a pool of threads, but are added to the estimates in replication order: the result only
+//depends on the plan, not on the number of threads or their scheduling.
+//A replication in which a scenario has no value of the metric (see has_value) is left out for every scenario, which
+//keeps the differences paired; if none of the first min_replications has one, the run stops with an error.
+template<typename TIME>
+Replication_Report run_replications(const vector<Plant_description>& scenarios, const vector<string>& names,
+		const Replication_Plan& plan){
+	assert(names.size() == scenarios.size());
+	auto begin = chrono::steady_clock::now();
+	Replication_Report report;
+	report.scenarios.resize(scenarios.size());
+	for (size_t s = 0; s < scenarios.size(); s++) report.scenarios[s].name = names[s];
+	if (scenarios.empty()) return report;
+	TIME until(plan.until);
+
+	while (report.replications < plan.max_replications){
+		long long first = report.replications;
+		long long used = first - report.missing;
+		long long count = (used < plan.min_replications) ? plan.min_replications - used : max(1u, plan.batch);
+		count = min(count, plan.max_replications - first);
+		size_t jobs = (size_t)count*scenarios.size();
+		vector<Sweep_Result> results(jobs);
+
+		atomic<size_t> next(0);
+		auto worker = [&](){
+			for (size_t j = next++; j < jobs; j = next++){
+				size_t s = j % scenarios.size();
+				long long r = first + (long long)(j / scenarios.size());
+				Plant_description plant = scenarios[s];
+				plant.replication = plan.stream(r, s, scenarios.size());
+				try {
+					sweep_simulate<TIME>(plant, until, results[j]);
+					results[j].ok = true;
+				} catch (exception& e){
+					results[j].error = e.what();
+				}
+			}
+		};
+		vector<thread> pool;
+		for (unsigned t = 0; t < max(1u, plan.batch) && t < jobs; t++) pool.emplace_back(worker);
+		for (auto& t : pool) t.join();
+
+		for (size_t j = 0; j < jobs; j++){
+			if (!results[j].ok){
+				report.error = results[j].error;
+				report.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+				return report;
+			}
+		}
+		for (size_t j = 0; j < jobs; j += scenarios.size()){
+			bool complete = true;
+			for (size_t s = 0; s < scenarios.size(); s++) complete = complete && plan.has_value(results[j + s]);
+			if (!complete){
+				report.missing++;
+				continue;
+			}
+			for (size_t s = 0; s < scenarios.size(); s++){
+				double x = plan.value(results[j + s]);
+				Scenario_Estimate& e = report.scenarios[s];
+				e.values.push_back(x);
+				e.metric.add(x);
+				if (s) e.difference.add(x - report.scenarios[0].values.back());
+			}
+		}
+		report.replications += count;
+		if (report.missing == report.replications){
+			report.error = string("no replication has a ") + Replication_Plan::metric_name(plan.metric) + " within " + plan.until;
+			report.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+			return report;
+		}
+
+		//target reached?
+		if (report.replications - report.missing < plan.min_replications) continue;
+		report.target = (plan.half_width > 0) ? plan.half_width : plan.relative_half_width*fabs(report.scenarios[0].metric.mean);
+		bool converged = true;
+		if (scenarios.size() == 1){
+			converged = report.scenarios[0].metric.half_width(plan.confidence) <= report.target;
+		}
+		for (size_t s = 1; s < scenarios.size(); s++){
+			converged = converged && report.scenarios[s].difference.half_width(plan.confidence) <= report.target;
+		}
+		if (converged){
+			report.converged = true;
+			break;
+		}
+	}
+	report.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+	return report;
+}
+
+#endif //_REPLICATIONS_HPP__
\ No newline at end of file
@@ -0,0 +1,109 @@
+#ifndef _SNAPSHOT_LOGGER_HPP__
+#define _SNAPSHOT_LOGGER_HPP__
+
+//Cadmium Simulator headers
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_message_bag.hpp>
+
+//Atomic model headers
+#include "../atomics/control.hpp"
+#include "../atomics/storage.hpp"
+#include "../atomics/handling.hpp"
+
+#include "mccs_runner.hpp"
+
+//C++ libraries
+#include <assert.h>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace cadmium;
+
+
+/***** SNAPSHOT STATE LOGGER *****/
+//Observer writing the full states of the watched models every period of simulated time, whatever happens in between:
+//the log grows with the horizon, not with the number of events. The snapshot at T holds the states after every step
+//at a time <= T; it is written when the first step after T starts (or by finish), in the format of the state log:
+//	00:10:00:000
+//	State for model control1 is :
+//		phase: ...
+//so the state log tools (e.g. MCCS_ANALYSE, MCCS_LOG) read it as well.
+template<typename TIME>
+class MCCS_Snapshots : public Run_Observer<TIME>{
+	struct Watched{
+		string id;
+		shared_ptr<dynamic::modeling::atomic_abstract<TIME>> model;
+	};
+	vector<Watched> models;
+	ostream& os;
+	TIME period;
+	TIME next_snapshot;
+	long long written = 0;
+
+public:
+	MCCS_Snapshots(ostream& i_os, const TIME& i_period) : os(i_os), period(i_period){
+		assert(TIME() < period && "SN - the snapshot period must be positive");
+	}
+
+	/***** Registration *****/
+	//Any atomic model, as created by make_dynamic_atomic_model
+	void watch(shared_ptr<dynamic::modeling::model> model){
+		auto atomic = dynamic_pointer_cast<dynamic::modeling::atomic_abstract<TIME>>(model);
+		assert(atomic && "SN - not an atomic model");
+		models.push_back({model->get_id(), atomic});
+	}
+
+	//Every Control, Storage and Handling in the model tree, in the order of the tree
+	void watch_cells(shared_ptr<dynamic::modeling::model> model){
+		auto coupled = dynamic_pointer_cast<dynamic::modeling::coupled<TIME>>(model);
+		if (coupled){
+			for (auto& m : coupled->_models) watch_cells(m);
+		} else if (dynamic_pointer_cast<Control<TIME>>(model) || dynamic_pointer_cast<Storage<TIME>>(model) ||
+			dynamic_pointer_cast<Handling<TIME>>(model)){
+			watch(model);
+		}
+	}
+
+
+	/***** Observer *****/
+	void start(const TIME& t) override{
+		next_snapshot = t;
+	}
+
+	//the states are still the ones before the step at t
+	void outputs(const TIME& t, const dynamic::message_bags& top_outbox) override{
+		write_before(t);
+	}
+
+	//Writes the snapshots due before until (the end of the run: run_until(until) stops before the steps at until)
+	void finish(const TIME& until){
+		write_before(until);
+		os.flush();
+	}
+
+	long long snapshots() const{
+		return written;
+	}
+
+	size_t watched() const{
+		return models.size();
+	}
+
+private:
+	void write_before(const TIME& t){
+		while (next_snapshot < t){
+			os << next_snapshot << '\n';
+			for (auto& w : models){
+				os << "State for model " << w.id << " is " << w.model->model_state_as_string() << '\n';
+			}
+			written++;
+			next_snapshot = next_snapshot + period;
+		}
+	}
+};
+
+#endif //_SNAPSHOT_LOGGER_HPP__
\ No newline at end of file
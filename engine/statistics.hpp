@@ -0,0 +1,222 @@
+#ifndef _STATISTICS_HPP__
+#define _STATISTICS_HPP__
+
+//Cadmium Simulator headers
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_message_bag.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+#include <boost/any.hpp>
+
+//Atomic model headers
+#include "../atomics/control.hpp"
+#include "../atomics/storage.hpp"
+#include "../atomics/handling.hpp"
+
+#include "../data_structures/time_conversion.hpp"
+#include "mccs_runner.hpp"
+
+//C++ libraries
+#include <assert.h>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+using namespace std;
+using namespace cadmium;
+
+
+/***** (1) Time-weighted average *****/
+//Running integral of a piecewise constant signal: O(1) memory whatever the run length
+struct Time_Average{
+	double start;			//seconds
+	double last_time;
+	double last_value;
+	double area;			//integral of the value from start to last_time
+	double max;
+
+	void reset(double t, double value){
+		start = last_time = t;
+		last_value = max = value;
+		area = 0;
+	}
+
+	void update(double t, double value){
+		area += last_value*(t - last_time);
+		last_time = t;
+		last_value = value;
+		if (value > max) max = value;
+	}
+
+	//average over [start, end], the last value holding until end
+	double mean(double end) const{
+		double length = end - start;
+		if (length <= 0) return last_value;
+		return (area + last_value*(end - last_time))/length;
+	}
+};
+
+
+/***** (2) Statistics observer *****/
+//Collects, while the simulation runs, the figures usually recovered from the state log:
+//utilisation of the handling units (active) and storages (full), work in progress of each control
+//(materials requested but not prepared yet) and the throughput of the TOP output ports.
+template<typename TIME>
+class MCCS_Statistics : public Run_Observer<TIME>{
+	struct Signal{
+		string name;
+		string metric;					//"utilisation" or "wip"
+		function<double()> read;		//current value, read from the model state
+		Time_Average average;
+	};
+	struct Counter{
+		string name;
+		type_index port;
+		function<size_t(const boost::any&)> count;		//number of messages in the bag of the port
+		long long messages;
+		long long events;								//steps with at least one message
+		double last;									//time of the last message in seconds, -1 if none
+	};
+	vector<Signal> signals;
+	vector<Counter> counters;
+	double start_time = 0;
+	double last_time = 0;
+	TIME step_time;						//time last converted, the outputs and the step at a time share one conversion
+	double step_seconds = 0;
+
+	double seconds(const TIME& t){
+		if (t != step_time){
+			step_time = t;
+			step_seconds = time_to_seconds(t);
+		}
+		return step_seconds;
+	}
+
+public:
+	/***** Registration *****/
+	//Models are passed as created by make_dynamic_atomic_model; they are reached through their atomic class
+	void watch_handling(shared_ptr<dynamic::modeling::model> model){
+		auto handling = dynamic_pointer_cast<Handling<TIME>>(model);
+		assert(handling && "S - not a Handling model");
+		add_signal(model->get_id(), "utilisation", [handling](){ return (handling->state.active) ? 1.0 : 0.0; });
+	}
+
+	void watch_storage(shared_ptr<dynamic::modeling::model> model){
+		auto storage = dynamic_pointer_cast<Storage<TIME>>(model);
+		assert(storage && "S - not a Storage model");
+		add_signal(model->get_id(), "utilisation", [storage](){ return (storage->state.full) ? 1.0 : 0.0; });
+	}
+
+	void watch_control(shared_ptr<dynamic::modeling::model> model){
+		auto control = dynamic_pointer_cast<Control<TIME>>(model);
+		assert(control && "S - not a Control model");
+		add_signal(model->get_id(), "wip", [control](){ return (double)(control->state.total_mats - control->state.num_prepared); });
+	}
+
+	//Output port of the TOP model whose messages are counted
+	template<typename PORT>
+	void count_port(const string& name){
+		Counter c{name, type_index(typeid(PORT)),
+			[](const boost::any& bag){ return boost::any_cast<const message_bag<PORT>&>(bag).messages.size(); }, 0, 0, -1};
+		counters.push_back(c);
+	}
+
+
+	/***** Observer *****/
+	void start(const TIME& t) override{
+		step_time = t;
+		start_time = last_time = step_seconds = time_to_seconds(t);
+		for (auto& s : signals) s.average.reset(start_time, s.read());
+	}
+
+	void outputs(const TIME& t, const dynamic::message_bags& top_outbox) override{
+		for (auto& c : counters){
+			auto bag = top_outbox.find(c.port);
+			if (bag == top_outbox.end()) continue;
+			size_t n = c.count(bag->second);
+			c.messages += n;
+			if (n > 0){
+				c.events++;
+				c.last = seconds(t);
+			}
+		}
+	}
+
+	void step(const TIME& t) override{
+		last_time = seconds(t);
+		for (auto& s : signals) s.average.update(last_time, s.read());
+	}
+
+
+	/***** Values *****/
+	//mean over the watched models of their time-weighted mean (e.g. all the handling units), 0 if none
+	double mean_of_models(double end = -1) const{
+		if (end < 0) end = last_time;
+		double sum = 0;
+		for (auto& s : signals) sum += s.average.mean(end);
+		return (signals.empty()) ? 0.0 : sum/signals.size();
+	}
+
+	//messages counted on the port registered as name, and the time of the last one (-1 if none)
+	long long messages(const string& name) const{
+		for (auto& c : counters){
+			if (c.name == name) return c.messages;
+		}
+		return 0;
+	}
+
+	double last_message(const string& name) const{
+		for (auto& c : counters){
+			if (c.name == name) return c.last;
+		}
+		return -1;
+	}
+
+
+	/***** Reports *****/
+	//end: end of the observation window in seconds, usually the run_until horizon (defaults to the last event)
+	void print_summary(ostream& os, double end = -1) const{
+		if (end < 0) end = last_time;
+		double hours = (end - start_time)/3600.0;
+		os << "Simulated time: " << end - start_time << " s" << endl;
+		os << left << setw(24) << "model/port" << setw(14) << "metric" << setw(12) << "mean" << setw(12) << "max" << endl;
+		for (auto& s : signals){
+			os << left << setw(24) << s.name << setw(14) << s.metric <<
+				setw(12) << s.average.mean(end) << setw(12) << s.average.max << endl;
+		}
+		os << left << setw(24) << "model/port" << setw(14) << "messages" << setw(12) << "per hour" << setw(12) << "events" << endl;
+		for (auto& c : counters){
+			os << left << setw(24) << c.name << setw(14) << c.messages <<
+				setw(12) << ((hours > 0) ? c.messages/hours : 0.0) << setw(12) << c.events << endl;
+		}
+	}
+
+	void print_json(ostream& os, double end = -1) const{
+		if (end < 0) end = last_time;
+		double hours = (end - start_time)/3600.0;
+		os << "{\n  \"simulated_seconds\": " << end - start_time << ",\n  \"models\": [";
+		for (size_t i = 0; i < signals.size(); i++){
+			const Signal& s = signals[i];
+			os << ((i) ? "," : "") << "\n    {\"name\": \"" << s.name << "\", \"metric\": \"" << s.metric <<
+				"\", \"mean\": " << s.average.mean(end) << ", \"max\": " << s.average.max << "}";
+		}
+		os << "\n  ],\n  \"ports\": [";
+		for (size_t i = 0; i < counters.size(); i++){
+			const Counter& c = counters[i];
+			os << ((i) ? "," : "") << "\n    {\"name\": \"" << c.name << "\", \"messages\": " << c.messages <<
+				", \"per_hour\": " << ((hours > 0) ? c.messages/hours : 0.0) << ", \"events\": " << c.events << "}";
+		}
+		os << "\n  ]\n}" << endl;
+	}
+
+private:
+	void add_signal(const string& name, const string& metric, function<double()> read){
+		Signal s{name, metric, read, Time_Average()};
+		s.average.reset(last_time, s.read());
+		signals.push_back(s);
+	}
+};
+
+#endif //_STATISTICS_HPP__
\ No newline at end of file
@@ -0,0 +1,242 @@
+#ifndef _STEADY_STATE_HPP__
+#define _STEADY_STATE_HPP__
+
+//Cadmium Simulator headers
+#include <cadmium/modeling/dynamic_message_bag.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+#include <boost/any.hpp>
+
+#include "../data_structures/time_conversion.hpp"
+#include "mccs_runner.hpp"
+#include "confidence.hpp"
+
+//C++ libraries
+#include <assert.h>
+#include <math.h>
+#include <limits>
+#include <ostream>
+#include <typeindex>
+#include <vector>
+
+using namespace std;
+using namespace cadmium;
+
+
+/***** (1) Steady-state estimator *****/
+//Online estimate of the long-run mean of an output series (e.g. materials prepared per hour, one value per interval):
+//  - warm-up: MSER-5. The series is averaged in groups of 5 and the first d groups are cut, d minimising the
+//    variance of the mean of the rest, sum((z_j - mean)^2)/(m - d)^2, over d <= m/2. A minimum at the end of that range
+//    means the series has not settled yet.
+//  - precision: batch means. The values after the cut are split in "batches" batches (the oldest remainder dropped)
+//    and the half width of the confidence interval comes from the spread of the batch means.
+struct Steady_State_Plan{
+	double confidence = 0.95;
+	double half_width = 0;				//absolute target, in the unit of the series; 0 = use relative_half_width
+	double relative_half_width = 0.05;	//target as a fraction of the mean
+	int batches = 10;
+	long long min_observations = 100;	//after the warm-up cut
+};
+
+class Steady_State_Estimator{
+	static const int GROUP = 5;
+	Steady_State_Plan plan;
+	vector<double> values;
+	vector<double> groups;				//means of GROUP consecutive values
+	long long cut_groups = 0;
+	bool settled = false;				//the MSER minimum is inside the range searched
+	bool precise = false;				//converged(), updated with every value
+
+public:
+	Steady_State_Estimator(Steady_State_Plan i_plan = Steady_State_Plan()) : plan(i_plan){
+		assert(plan.batches >= 2 && "SS - batch means need at least 2 batches");
+	}
+
+	void add(double x){
+		values.push_back(x);
+		if (values.size() % GROUP == 0){
+			double sum = 0;
+			for (size_t k = values.size() - GROUP; k < values.size(); k++) sum += values[k];
+			groups.push_back(sum/GROUP);
+			update_cut();
+		}
+		precise = settled && kept() >= plan.min_observations && half_width() <= target() &&
+			batch_autocorrelation() <= normal_quantile(plan.confidence)/sqrt((double)plan.batches);
+	}
+
+	//values discarded as warm-up
+	long long warmup() const{
+		return cut_groups*GROUP;
+	}
+
+	long long observations() const{
+		return values.size();
+	}
+
+	//values after the cut
+	long long kept() const{
+		return values.size() - warmup();
+	}
+
+	bool warmup_detected() const{
+		return settled;
+	}
+
+	double mean() const{
+		double sum = 0;
+		for (size_t k = warmup(); k < values.size(); k++) sum += values[k];
+		return (kept() > 0) ? sum/kept() : 0.0;
+	}
+
+	//half width of the batch means interval, infinite while a batch would be empty
+	double half_width() const{
+		vector<double> means = batch_means();
+		if (means.empty()) return numeric_limits<double>::infinity();
+		Running_Estimate estimate;
+		for (double x : means) estimate.add(x);
+		return estimate.half_width(plan.confidence);
+	}
+
+	//lag-1 autocorrelation of the batch means: a trend left after the cut (or batches too short for the correlation of
+	//the series) makes it high, and the half width then understates the error
+	double batch_autocorrelation() const{
+		vector<double> means = batch_means();
+		if (means.size() < 2) return 1;
+		double mean = 0;
+		for (double x : means) mean += x;
+		mean /= means.size();
+		double c0 = 0, c1 = 0;
+		for (size_t k = 0; k < means.size(); k++){
+			c0 += (means[k] - mean)*(means[k] - mean);
+			if (k > 0) c1 += (means[k] - mean)*(means[k - 1] - mean);
+		}
+		return (c0 > 0) ? c1/c0 : 0.0;
+	}
+
+	double target() const{
+		return (plan.half_width > 0) ? plan.half_width : plan.relative_half_width*fabs(mean());
+	}
+
+	bool converged() const{
+		return precise;
+	}
+
+	const Steady_State_Plan& settings() const{
+		return plan;
+	}
+
+private:
+	vector<double> batch_means() const{
+		vector<double> means;
+		long long size = kept()/plan.batches;
+		if (size < 1) return means;
+		for (size_t first = values.size() - size*plan.batches; first < values.size(); first += size){
+			double sum = 0;
+			for (long long k = 0; k < size; k++) sum += values[first + k];
+			means.push_back(sum/size);
+		}
+		return means;
+	}
+
+	//MSER over the groups, with suffix sums: O(groups) per new group
+	void update_cut(){
+		long long m = groups.size();
+		long long best = 0;
+		double best_mser = numeric_limits<double>::infinity();
+		double sum = 0, sum2 = 0;
+		vector<double> mser(m/2 + 1);
+		for (long long d = m - 1; d >= 0; d--){
+			sum += groups[d];
+			sum2 += groups[d]*groups[d];
+			if (d <= m/2){
+				double n = (double)(m - d);
+				mser[d] = (sum2 - sum*sum/n)/(n*n);
+			}
+		}
+		for (long long d = 0; d <= m/2; d++){
+			if (mser[d] < best_mser*(1 - 1e-12)){			//ties (e.g. a constant series) keep the earliest cut
+				best_mser = mser[d];
+				best = d;
+			}
+		}
+		cut_groups = best;
+		settled = (m >= 4 && best < m/2);
+	}
+};
+
+
+/***** (2) Steady-state stop condition *****/
+//Counts the messages of an output port of the TOP model per interval of simulated time (as a rate per hour), feeds
+//the counts to the estimator and ends the run once the steady-state estimate is precise enough, e.g.
+//	Steady_State_Stop<TIME, top_out_mat_prepared>(TIME("00:05:00:000"), plan)
+template<typename TIME, typename PORT>
+class Steady_State_Stop : public Stop_Condition<TIME>{
+	Steady_State_Estimator estimator;
+	TIME interval;
+	TIME begin;
+	TIME interval_end;
+	double per_hour;				//rate per hour of one message in one interval
+	long long count = 0;
+	bool started = false;			//run_until calls start() each time; the intervals go on from the first one
+
+public:
+	Steady_State_Stop(const TIME& i_interval, Steady_State_Plan plan = Steady_State_Plan())
+		: estimator(plan), interval(i_interval){
+		double seconds = time_to_seconds(interval);
+		assert(seconds > 0 && "SS - the interval must be positive");
+		per_hour = 3600.0/seconds;
+	}
+
+	void start(const TIME& t) override{
+		if (started) return;
+		started = true;
+		begin = t;
+		interval_end = t + interval;
+	}
+
+	void outputs(const TIME& t, const dynamic::message_bags& top_outbox) override{
+		close_intervals(t);
+		auto bag = top_outbox.find(type_index(typeid(PORT)));
+		if (bag != top_outbox.end()){
+			count += boost::any_cast<const message_bag<PORT>&>(bag->second).messages.size();
+		}
+	}
+
+	bool reached(const TIME& next) override{
+		close_intervals(next);
+		return estimator.converged();
+	}
+
+	const Steady_State_Estimator& estimate() const{
+		return estimator;
+	}
+
+	//end of the warm-up period cut from the series
+	TIME warmup_end() const{
+		TIME t = begin;
+		for (long long k = 0; k < estimator.warmup(); k++) t = t + interval;
+		return t;
+	}
+
+	void print(ostream& os) const{
+		const Steady_State_Plan& plan = estimator.settings();
+		os << "Steady state: " << ((estimator.converged()) ? "reached" : "NOT reached") << " after " << estimator.observations() <<
+			" intervals of " << interval << endl;
+		os << "Warm-up cut: " << estimator.warmup() << " intervals, until " << warmup_end() <<
+			((estimator.warmup_detected()) ? "" : " (the series has not settled)") << endl;
+		os << "Mean per hour: " << estimator.mean() << " +/- " << estimator.half_width() << " (" << plan.confidence*100 << "%, " <<
+			plan.batches << " batch means of " << estimator.kept() << " intervals, target +/- " << estimator.target() << ")" << endl;
+	}
+
+private:
+	//the counts of the intervals ending at or before t are complete (no step before t is left)
+	void close_intervals(const TIME& t){
+		if (t == numeric_limits<TIME>::infinity()) return;
+		while (!(t < interval_end)){
+			estimator.add(count*per_hour);
+			count = 0;
+			interval_end = interval_end + interval;
+		}
+	}
+};
+
+#endif //_STEADY_STATE_HPP__
\ No newline at end of file
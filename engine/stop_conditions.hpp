@@ -0,0 +1,116 @@
+#ifndef _STOP_CONDITIONS_HPP__
+#define _STOP_CONDITIONS_HPP__
+
+//Cadmium Simulator headers
+#include <cadmium/modeling/dynamic_message_bag.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+#include <boost/any.hpp>
+
+#include "mccs_runner.hpp"
+
+//C++ libraries
+#include <functional>
+#include <limits>
+#include <memory>
+#include <typeindex>
+#include <vector>
+
+using namespace std;
+using namespace cadmium;
+
+
+/***** STOP CONDITIONS *****/
+//Passed to MCCS_Runner::run_until(t, stop): the run ends at t or after the first step where the condition holds.
+//Each check is O(1): counters are updated from the outputs of the step, never by scanning the models.
+//Counts are kept across run_until calls, so the same condition can be given to successive calls.
+
+//After K messages on an output port of the TOP model, e.g. Stop_After_Messages<TIME, top_out_end>(1)
+template<typename TIME, typename PORT>
+class Stop_After_Messages : public Stop_Condition<TIME>{
+	long long limit;
+	long long seen = 0;
+
+public:
+	Stop_After_Messages(long long k) : limit(k){}
+
+	void outputs(const TIME& t, const dynamic::message_bags& top_outbox) override{
+		auto bag = top_outbox.find(type_index(typeid(PORT)));
+		if (bag != top_outbox.end()){
+			seen += boost::any_cast<const message_bag<PORT>&>(bag->second).messages.size();
+		}
+	}
+
+	bool reached(const TIME& next) override{
+		return seen >= limit;
+	}
+
+	long long count() const{
+		return seen;
+	}
+};
+
+//All models passive and all inputs exhausted: nothing is scheduled any more. A plain run_until(t) also ends
+//there; as a condition it can be combined with the others, and MCCS_Runner::stopped() tells the run was cut short.
+template<typename TIME>
+class Stop_When_Idle : public Stop_Condition<TIME>{
+public:
+	bool reached(const TIME& next) override{
+		return next == numeric_limits<TIME>::infinity();
+	}
+};
+
+//User predicate over the model states, e.g. [control](){ return control->state.num_prepared >= 100; }
+//(it is evaluated after every step, so it should read a few fields only)
+template<typename TIME>
+class Stop_When : public Stop_Condition<TIME>{
+	function<bool()> predicate;
+
+public:
+	Stop_When(function<bool()> i_predicate) : predicate(i_predicate){}
+
+	bool reached(const TIME& next) override{
+		return predicate();
+	}
+};
+
+//Composition: any (or all) of the conditions
+template<typename TIME>
+class Stop_Composite : public Stop_Condition<TIME>{
+	vector<shared_ptr<Stop_Condition<TIME>>> conditions;
+	bool all;
+
+public:
+	Stop_Composite(vector<shared_ptr<Stop_Condition<TIME>>> i_conditions, bool i_all)
+		: conditions(i_conditions), all(i_all){}
+
+	void start(const TIME& t) override{
+		for (auto& c : conditions) c->start(t);
+	}
+
+	void outputs(const TIME& t, const dynamic::message_bags& top_outbox) override{
+		for (auto& c : conditions) c->outputs(t, top_outbox);
+	}
+
+	void step(const TIME& t) override{
+		for (auto& c : conditions) c->step(t);
+	}
+
+	bool reached(const TIME& next) override{
+		for (auto& c : conditions){
+			if (c->reached(next) != all) return !all;
+		}
+		return all;
+	}
+};
+
+template<typename TIME>
+shared_ptr<Stop_Condition<TIME>> Stop_Any(vector<shared_ptr<Stop_Condition<TIME>>> conditions){
+	return make_shared<Stop_Composite<TIME>>(conditions, false);
+}
+
+template<typename TIME>
+shared_ptr<Stop_Condition<TIME>> Stop_All(vector<shared_ptr<Stop_Condition<TIME>>> conditions){
+	return make_shared<Stop_Composite<TIME>>(conditions, true);
+}
+
+#endif //_STOP_CONDITIONS_HPP__
\ No newline at end of file
@@ -0,0 +1,362 @@
+#ifndef _SWEEP_HPP__
+#define _SWEEP_HPP__
+
+//Cadmium Simulator headers
+#include <cadmium/logger/common_loggers.hpp>
+
+#include "model_builder.hpp"
+#include "mccs_runner.hpp"
+#include "statistics.hpp"
+#include "cycle_times.hpp"
+#include "checkpoint.hpp"				//checkpoint_hash
+
+#include "../data_structures/time_conversion.hpp"
+
+//C++ libraries
+#include <sys/stat.h>
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace cadmium;
+
+
+/***** (1) Parameter grid *****/
+//A plant description and the values to try for some of its parameters, one "key value | value..." per line, e.g.
+//	plant ../input_data/MCCS_plant_example.xml
+//	until 05:00:00:000
+//	loading_time constant 2 | uniform 1.5 2.5
+//	moving_time constant 4 | constant 5
+//	lines 1 | 2
+//Every combination of the values is a point of the sweep. Parameters: lines, dispatch (none or a policy of
+//atomics/dispatcher.hpp), loading_time, moving_time and seed (all the stages), and for a generator input arrival,
+//mean_interarrival, batch_min, batch_max and input_seed.
+struct Sweep_Grid{
+	string plant_path;
+	string until = "05:00:00:000";
+	vector<pair<string, vector<string>>> axes;
+	string error;
+
+	bool read(const char* file_path){
+		ifstream file(file_path);
+		if (!file.is_open()) return fail(string("cannot open ") + file_path);
+		string line;
+		while (getline(file, line)){
+			if (!line.empty() && line.back() == '\r') line.pop_back();
+			istringstream is(line);
+			string key;
+			if (!(is >> key) || key[0] == '#') continue;
+			string rest;
+			getline(is, rest);
+			if (key == "plant"){
+				plant_path = trim(rest);
+			} else if (key == "until"){
+				until = trim(rest);
+			} else {
+				vector<string> values;
+				istringstream vs(rest);
+				string value;
+				while (getline(vs, value, '|')){
+					value = trim(value);
+					if (!value.empty()) values.push_back(value);
+				}
+				if (values.empty()) return fail("no value for " + key);
+				axes.push_back({key, values});
+			}
+		}
+		if (plant_path.empty()) return fail("no plant description");
+		return true;
+	}
+
+	//all the combinations, the last axis varying fastest
+	vector<vector<string>> points() const{
+		vector<vector<string>> result(1);
+		for (auto& axis : axes){
+			vector<vector<string>> next;
+			for (auto& p : result){
+				for (auto& v : axis.second){
+					next.push_back(p);
+					next.back().push_back(v);
+				}
+			}
+			result = next;
+		}
+		return result;
+	}
+
+private:
+	bool fail(const string& message){
+		error = message;
+		return false;
+	}
+
+	static string trim(const string& s){
+		size_t b = s.find_first_not_of(" \t"), e = s.find_last_not_of(" \t");
+		return (b == string::npos) ? "" : s.substr(b, e - b + 1);
+	}
+};
+
+//Applies one parameter value to the plant; false if the parameter or the value is not valid
+inline bool sweep_apply(Plant_description& plant, const string& key, const string& value){
+	istringstream is(value);
+	bool ok = true;
+	if (key == "lines"){
+		ok = !(is >> plant.lines).fail() && plant.lines > 0;
+	} else if (key == "loading_time" || key == "moving_time" || key == "seed"){
+		for (auto& stage : plant.stages){
+			istringstream vs(value);
+			if (key == "loading_time") ok = ok && stage.config.loading.read(vs);
+			if (key == "moving_time") ok = ok && stage.config.moving.read(vs);
+			if (key == "seed") ok = ok && !(vs >> stage.config.seed).fail();
+		}
+	} else if (key == "dispatch"){
+		ok = read_dispatch_policy(value, plant.dispatch);
+	} else if (!plant.generated){
+		ok = false;							//the other parameters belong to the generator
+	} else if (key == "arrival"){
+		map<string, int> arrivals = {{"deterministic", 0}, {"poisson", 1}, {"bursty", 2}};
+		ok = arrivals.count(value) > 0;
+		if (ok) plant.generator.arrival = arrivals[value];
+	} else if (key == "mean_interarrival"){
+		ok = !(is >> plant.generator.mean_interarrival).fail();
+	} else if (key == "batch_min"){
+		ok = !(is >> plant.generator.batch_min).fail();
+	} else if (key == "batch_max"){
+		ok = !(is >> plant.generator.batch_max).fail();
+	} else if (key == "input_seed"){
+		ok = !(is >> plant.generator.seed).fail();
+	} else {
+		ok = false;
+	}
+	return ok;
+}
+
+//Everything the results of a point depend on, as text: the resolved plant, the input file contents and the horizon
+inline string sweep_key(const Plant_description& plant, const string& until){
+	ostringstream os;
+	os << setprecision(17) << "version 2\nuntil " << until << "\nlines " << plant.lines << "\nreplication " << plant.replication << "\n";
+	if (plant.dispatch != DISPATCH_NONE) os << "dispatch " << plant.dispatch << "\n";		//keys without a dispatcher are unchanged
+	if (plant.generated){
+		const Generator_config& g = plant.generator;
+		os << "generator " << g.arrival << " " << g.mean_interarrival << " " << g.burst_size << " " << g.burst_gap << " " <<
+			g.batch_distribution << " " << g.batch_min << " " << g.batch_max << " " << g.batch_mean << " " << g.seed << " " <<
+			g.max_batches << "\n";
+	} else {
+		ifstream in(plant.input_path, ios::binary);
+		string contents((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+		os << "input " << checkpoint_hash(contents) << " " << contents.size() << "\n";
+	}
+	for (auto& stage : plant.stages){
+		const Timing& l = stage.config.loading;
+		const Timing& m = stage.config.moving;
+		os << "stage " << stage.name << " " << stage.config.seed << " " << l.distribution << " " << l.a << " " << l.b << " " <<
+			l.c << " " << m.distribution << " " << m.a << " " << m.b << " " << m.c << "\n";
+		for (auto& p : stage.config.product_loading){		//keys without product times are unchanged
+			os << "product " << p.first << " loading " << p.second.distribution << " " << p.second.a << " " << p.second.b << " " <<
+				p.second.c << "\n";
+		}
+		for (auto& p : stage.config.product_moving){
+			os << "product " << p.first << " moving " << p.second.distribution << " " << p.second.a << " " << p.second.b << " " <<
+				p.second.c << "\n";
+		}
+	}
+	return os.str();
+}
+
+
+/***** (2) Results and their on-disk cache *****/
+struct Sweep_Result{
+	vector<string> values;			//one per axis of the grid
+	bool ok = false;
+	string error;
+	bool cached = false;			//taken from the cache instead of simulated
+	long long prepared = 0;			//matPreparedOut and endOut messages of the last stages
+	long long ends = 0;
+	double makespan = -1;			//seconds until the last endOut, -1 if none
+	double throughput = 0;			//materials per hour over the horizon
+	double storage_utilisation = 0;	//means over the models of the plant
+	double handling_utilisation = 0;
+	double wip = 0;
+	double cycle_time = -1;			//mean seconds from the request of a material to its unloading in a cell, -1 if none
+
+	void write(ostream& os) const{
+		os << setprecision(17) << prepared << " " << ends << " " << makespan << " " << throughput << " " <<
+			storage_utilisation << " " << handling_utilisation << " " << wip << " " << cycle_time << "\n";
+	}
+
+	bool read(istream& is){
+		return !(is >> prepared >> ends >> makespan >> throughput >> storage_utilisation >> handling_utilisation >> wip >>
+			cycle_time).fail();
+	}
+};
+
+//One file per point, named after the hash of its key; the key is stored too, so a hash collision is a miss
+class Sweep_Cache{
+	string dir;
+
+	string path(const string& key) const{
+		ostringstream os;
+		os << dir << "/" << hex << setw(16) << setfill('0') << checkpoint_hash(key) << ".txt";
+		return os.str();
+	}
+
+public:
+	Sweep_Cache(const string& i_dir) : dir(i_dir){
+		if (!dir.empty()) mkdir(dir.c_str(), 0777);
+	}
+
+	bool get(const string& key, Sweep_Result& r) const{
+		if (dir.empty()) return false;
+		ifstream in(path(key));
+		if (!in) return false;
+		string stored_key(key.size(), '\0');
+		if (!in.read(&stored_key[0], key.size()) || stored_key != key) return false;
+		return r.read(in);
+	}
+
+	//written to a temporary file then renamed, so that a crashed run leaves no partial result
+	void put(const string& key, const Sweep_Result& r) const{
+		if (dir.empty()) return;
+		string p = path(key);
+		{
+			ofstream out(p + ".tmp");
+			out << key;
+			r.write(out);
+		}
+		rename((p + ".tmp").c_str(), p.c_str());
+	}
+};
+
+
+/***** (3) Sweep *****/
+//Simulates one point of the grid (no logs)
+template<typename TIME>
+void sweep_simulate(const Plant_description& plant, const TIME& until, Sweep_Result& r){
+	auto top = build_plant<TIME>(plant);
+	MCCS_Runner<TIME, logger::not_logger> runner(top, TIME("00:00:00:000"));
+	auto ports = make_shared<MCCS_Statistics<TIME>>();
+	auto storages = make_shared<MCCS_Statistics<TIME>>();
+	auto handlings = make_shared<MCCS_Statistics<TIME>>();
+	auto controls = make_shared<MCCS_Statistics<TIME>>();
+	auto cycles = make_shared<MCCS_Cycle_Times<TIME>>();
+	ports->template count_port<Plant_defs::out_mat_prepared>("matPreparedOut");
+	ports->template count_port<Plant_defs::out_end>("endOut");
+	function<void(shared_ptr<dynamic::modeling::model>)> watch = [&](shared_ptr<dynamic::modeling::model> model){
+		auto coupled = dynamic_pointer_cast<dynamic::modeling::coupled<TIME>>(model);
+		if (coupled){
+			for (auto& m : coupled->_models) watch(m);
+		} else if (dynamic_pointer_cast<Control<TIME>>(model)){
+			controls->watch_control(model);
+			cycles->watch_control(model);
+		} else if (dynamic_pointer_cast<Storage<TIME>>(model)){
+			storages->watch_storage(model);
+		} else if (dynamic_pointer_cast<Handling<TIME>>(model)){
+			handlings->watch_handling(model);
+		}
+	};
+	watch(top);
+	runner.attach(ports);
+	runner.attach(storages);
+	runner.attach(handlings);
+	runner.attach(controls);
+	runner.attach(cycles);
+	runner.run_until(until);
+
+	double end = time_to_seconds(until);
+	r.prepared = ports->messages("matPreparedOut");
+	r.ends = ports->messages("endOut");
+	r.makespan = ports->last_message("endOut");
+	r.throughput = (end > 0) ? r.prepared/(end/3600.0) : 0.0;
+	r.storage_utilisation = storages->mean_of_models(end);
+	r.handling_utilisation = handlings->mean_of_models(end);
+	r.wip = controls->mean_of_models(end);
+	const Latency_Histogram& cycle = cycles->histogram(MCCS_Cycle_Times<TIME>::END_TO_END);
+	r.cycle_time = (cycle.count()) ? cycle.mean()/1000.0 : -1;
+}
+
+//Runs every point of the grid not found in the cache on a pool of threads, each taking the next point to do
+template<typename TIME>
+vector<Sweep_Result> run_sweep(const Sweep_Grid& grid, const Sweep_Cache& cache, unsigned threads = thread::hardware_concurrency()){
+	Plant_description base;
+	vector<vector<string>> points = grid.points();
+	vector<Sweep_Result> results(points.size());
+	if (!base.read(grid.plant_path.c_str())){
+		for (size_t i = 0; i < points.size(); i++){
+			results[i].values = points[i];
+			results[i].error = "invalid plant description: " + base.error;
+		}
+		return results;
+	}
+
+	atomic<size_t> next(0);
+	auto worker = [&](){
+		for (size_t i = next++; i < points.size(); i = next++){
+			Sweep_Result& r = results[i];
+			r.values = points[i];
+			Plant_description plant = base;
+			bool valid = true;
+			for (size_t a = 0; a < grid.axes.size() && valid; a++){
+				valid = sweep_apply(plant, grid.axes[a].first, points[i][a]);
+				if (!valid) r.error = "invalid " + grid.axes[a].first + " " + points[i][a];
+			}
+			if (!valid) continue;
+			string key = sweep_key(plant, grid.until);
+			if (cache.get(key, r)){
+				r.ok = r.cached = true;
+				continue;
+			}
+			try {
+				sweep_simulate<TIME>(plant, TIME(grid.until), r);
+				cache.put(key, r);
+				r.ok = true;
+			} catch (exception& e){
+				r.error = e.what();
+			}
+		}
+	};
+	if (threads == 0) threads = 1;
+	vector<thread> pool;
+	for (unsigned t = 0; t < threads; t++) pool.emplace_back(worker);
+	for (auto& t : pool) t.join();
+	return results;
+}
+
+
+/***** (4) Tables *****/
+inline void print_sweep_csv(ostream& os, const Sweep_Grid& grid, const vector<Sweep_Result>& results){
+	for (auto& axis : grid.axes) os << axis.first << ",";
+	os << "ok,cached,prepared,ends,makespan_s,throughput_per_hour,storage_utilisation,handling_utilisation,wip,cycle_time_s,error" << endl;
+	for (auto& r : results){
+		for (auto& v : r.values) os << "\"" << v << "\",";
+		os << r.ok << "," << r.cached << "," << r.prepared << "," << r.ends << "," << r.makespan << "," << r.throughput << "," <<
+			r.storage_utilisation << "," << r.handling_utilisation << "," << r.wip << "," << r.cycle_time << ",\"" << r.error << "\"" << endl;
+	}
+}
+
+inline void print_sweep_json(ostream& os, const Sweep_Grid& grid, const vector<Sweep_Result>& results){
+	os << "[";
+	for (size_t i = 0; i < results.size(); i++){
+		const Sweep_Result& r = results[i];
+		os << ((i) ? "," : "") << "\n  {";
+		for (size_t a = 0; a < grid.axes.size(); a++){
+			os << "\"" << grid.axes[a].first << "\": \"" << r.values[a] << "\", ";
+		}
+		os << "\"ok\": " << ((r.ok) ? "true" : "false") << ", \"cached\": " << ((r.cached) ? "true" : "false") <<
+			", \"prepared\": " << r.prepared << ", \"ends\": " << r.ends << ", \"makespan_s\": " << r.makespan <<
+			", \"throughput_per_hour\": " << r.throughput << ", \"storage_utilisation\": " << r.storage_utilisation <<
+			", \"handling_utilisation\": " << r.handling_utilisation << ", \"wip\": " << r.wip << ", \"cycle_time_s\": " << r.cycle_time <<
+			", \"error\": \"" << r.error << "\"}";
+	}
+	os << "\n]" << endl;
+}
+
+#endif //_SWEEP_HPP__
\ No newline at end of file
@@ -0,0 +1,91 @@
+#ifndef _WHAT_IF_HPP__
+#define _WHAT_IF_HPP__
+
+//Cadmium Simulator headers
+#include <cadmium/modeling/dynamic_coupled.hpp>
+
+#include "checkpoint.hpp"
+#include "mccs_runner.hpp"
+
+//C++ libraries
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace cadmium;
+
+
+/***** WHAT-IF BRANCHES *****/
+//A live run is snapshotted once at time T (Checkpointer::snapshot) and forked into branches: each branch builds its
+//own model tree, restores the shared read-only snapshot into it, applies its change and runs on its own thread.
+//The prefix [0, T] is simulated only once, whatever the number of branches.
+//
+//	auto snapshot = Checkpointer<TIME>(TOP).snapshot(r.last());
+//	What_If_Branch<TIME, LOGGER> b;
+//	b.name = "moving 3s";
+//	b.build = [](){ return build_top(faster_config); };			//same model ids, other parameters (or extra models)
+//	b.attach = [](shared_ptr<dynamic::modeling::coupled<TIME>> top, MCCS_Runner<TIME, LOGGER>& r){ ... observers ... };
+//	run_what_if<TIME, LOGGER>(snapshot, {b, ...}, TIME("10:00:00:000"));
+//
+//The models of a branch are only touched by its thread, so LOGGER must not share an output between branches
+//(usually logger::not_logger, with the results collected by observers).
+
+template<typename TIME, typename LOGGER>
+struct What_If_Branch{
+	string name;
+	//builds the model tree of the branch; models with an id of the snapshot get its state, new ones start at T
+	function<shared_ptr<dynamic::modeling::coupled<TIME>>()> build;
+	//optional: changes the restored states (e.g. a new batch request) before the runner is created
+	function<void(shared_ptr<dynamic::modeling::coupled<TIME>>)> change;
+	//optional: attaches observers to the runner of the branch
+	function<void(shared_ptr<dynamic::modeling::coupled<TIME>>, MCCS_Runner<TIME, LOGGER>&)> attach;
+	//optional: called on the branch thread when the run is over
+	function<void(shared_ptr<dynamic::modeling::coupled<TIME>>, MCCS_Runner<TIME, LOGGER>&)> done;
+};
+
+struct What_If_Result{
+	string name;
+	bool ok;					//false if the snapshot could not be restored into the branch tree
+	string error;
+};
+
+//Runs every branch from the snapshot time until `until`, each on its own thread, and waits for all of them
+template<typename TIME, typename LOGGER>
+vector<What_If_Result> run_what_if(shared_ptr<const Checkpoint_Snapshot> snapshot,
+									const vector<What_If_Branch<TIME, LOGGER>>& branches, const TIME& until){
+	vector<What_If_Result> results(branches.size());
+	vector<thread> threads;
+	for (size_t i = 0; i < branches.size(); i++){
+		threads.emplace_back([&, i](){
+			const What_If_Branch<TIME, LOGGER>& branch = branches[i];
+			What_If_Result& result = results[i];
+			result.name = branch.name;
+			result.ok = false;
+			try {
+				shared_ptr<dynamic::modeling::coupled<TIME>> top = branch.build();
+				Checkpointer<TIME> checkpointer(top);
+				TIME start;
+				if (!checkpointer.restore(*snapshot, start, true)){
+					result.error = "the snapshot does not match the model tree of the branch";
+					return;
+				}
+				if (branch.change) branch.change(top);
+				MCCS_Runner<TIME, LOGGER> r(top, start);
+				if (branch.attach) branch.attach(top, r);
+				r.run_until(until);
+				if (branch.done) branch.done(top, r);
+				result.ok = true;
+			} catch (exception& e){
+				result.error = e.what();
+			}
+		});
+	}
+	for (auto& t : threads) t.join();
+	return results;
+}
+
+#endif //_WHAT_IF_HPP__
\ No newline at end of file
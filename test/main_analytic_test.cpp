@@ -0,0 +1,110 @@
+//Time class header
+#include <NDTime.hpp>
+
+//Analytic evaluation of a deterministic cell (includes the batch engine used as the fallback)
+#include "../engine/analytic.hpp"
+
+//C++ libraries
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//Namespaces
+using namespace std;
+using TIME = NDTime;
+
+
+/***** (1) *****/
+MCCS_config constant_config(double loading, double moving){
+	MCCS_config config;
+	config.loading = Timing(loading);
+	config.moving = Timing(moving);
+	return config;
+}
+
+//Writes a schedule of n batches of 1 to 3 materials, from 1 to 40 seconds apart
+void write_schedule(const string& path, int n){
+	ofstream file(path);
+	SplitMix64 rng(11);
+	long long ms = 0;
+	for (int i = 0; i < n; i++){
+		ms += 1000*rng.uniform_int(1, 40);
+		file << time_from_milliseconds<TIME>(ms) << " " << rng.uniform_int(1, 3) << endl;
+	}
+}
+
+
+/***** (2) *****/
+/***** Create the main function *****/
+int main (){
+	ofstream out("../simulation_results/Analytic_test_output.txt");
+	TIME until = TIME("05:00:00:000");
+	bool passed = true;
+
+	/***** Self-check: closed form and models agree (busy periods, same-time starts, starts at a completion) *****/
+	for (const char* input : {"../input_data/MCCS_input_test_startIn.txt", "../input_data/schedule_input_test.txt",
+			"../input_data/analytic_input_test.txt"}){
+		for (auto config : {MCCS_config(), constant_config(1.5, 3.25), constant_config(0, 4)}){
+			Analytic_Report report;
+			vector<Batch_Output<TIME>> outputs = evaluate_mccs<TIME>(input, config, until, ANALYTIC_CHECK, &report);
+			out << input << " loading " << config.loading.a << " moving " << config.moving.a << ": " << outputs.size() << " outputs" << endl;
+			report.print(out);
+			passed = passed && report.analytic && report.checked && report.matched;
+		}
+	}
+
+	/***** Times of product 0 (the materials of startIn batches) replace loading_time and moving_time *****/
+	MCCS_config products;
+	products.product_loading[0] = Timing(4);
+	products.product_moving[3] = Timing(9);			//no material of product 3
+	Analytic_Report product_report;
+	vector<Batch_Output<TIME>> product_outputs = evaluate_mccs<TIME>("../input_data/analytic_input_test.txt", products, until,
+		ANALYTIC_CHECK, &product_report);
+	bool same_times = product_outputs == evaluate_mccs<TIME>("../input_data/analytic_input_test.txt", constant_config(4, 5), until);
+	out << "product 0 loading 4: " << product_outputs.size() << " outputs, " << ((same_times) ? "" : "NOT ") << "those of loading 4" << endl;
+	product_report.print(out);
+	passed = passed && product_report.analytic && product_report.matched && same_times;
+
+	/***** The horizon cuts the outputs as the runner does *****/
+	Analytic_Report report;
+	vector<Batch_Output<TIME>> cut = evaluate_mccs<TIME>("../input_data/analytic_input_test.txt", MCCS_config(),
+		TIME("00:00:47:000"), ANALYTIC_CHECK, &report);
+	passed = passed && report.matched && !cut.empty() && cut.back().time < TIME("00:00:47:000");
+
+	/***** Fallback to the models *****/
+	MCCS_config stochastic;
+	stochastic.moving.distribution = 1;
+	stochastic.moving.b = 6;
+	evaluate_mccs<TIME>("../input_data/analytic_input_test.txt", stochastic, until, ANALYTIC_AUTO, &report);
+	report.print(out);
+	passed = passed && !report.analytic && !report.reason.empty();
+	evaluate_mccs<TIME>("../input_data/analytic_input_test.txt", MCCS_config(), until, ANALYTIC_SIMULATE, &report);
+	passed = passed && !report.analytic;
+	{
+		ofstream file("../simulation_results/analytic_zero_batch.txt");
+		file << "00:00:01 0" << endl << "00:00:05 2" << endl;
+	}
+	string reason;
+	bool zero_batch = MCCS_Analytic<TIME>::applicable(MCCS_config(),
+		*Input_Schedule<int, TIME>::load("../simulation_results/analytic_zero_batch.txt"), &reason);
+	out << "batch of 0: " << ((zero_batch) ? "analytic" : reason) << endl;
+	passed = passed && !zero_batch;
+	remove("../simulation_results/analytic_zero_batch.txt");
+
+	/***** Benchmark *****/
+	out << endl << "batches\tanalytic[s]\tsimulated[s]\tspeedup" << endl;
+	for (int n : {100, 1000, 5000}){
+		string path = "../simulation_results/analytic_benchmark_" + to_string(n) + ".txt";
+		write_schedule(path, n);
+		evaluate_mccs<TIME>(path.c_str(), MCCS_config(), TIME("100:00:00:000"), ANALYTIC_CHECK, &report);
+		out << n << "\t" << report.analytic_seconds << "\t" << report.simulation_seconds << "\t" <<
+			report.simulation_seconds/report.analytic_seconds << ((report.matched) ? "" : "\tMISMATCH") << endl;
+		passed = passed && report.matched;
+		remove(path.c_str());
+	}
+
+	cout << "Analytic test " << ((passed) ? "passed" : "FAILED") << endl;
+	return (passed) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+//Time class header
+#include <NDTime.hpp>
+
+//Messages structures
+#include "../data_structures/message.hpp"
+
+//Batch engine (includes the atomic models and the Cadmium headers it needs)
+#include "../engine/batch_engine.hpp"
+
+//C++ libraries
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+
+//Namespaces
+using namespace std;
+using TIME = NDTime;
+
+
+/***** (1) *****/
+/***** Compare the vectorised engine against the per-object models *****/
+bool same_cells(const MCCS_BatchEngine<TIME>& a, const MCCS_BatchEngine<TIME>& b, ostream& out){
+	if (a.outputs().size() != b.outputs().size()){
+		out << "different number of outputs: " << a.outputs().size() << " vs " << b.outputs().size() << endl;
+		return false;
+	}
+	for (size_t k = 0; k < a.outputs().size(); k++){
+		if (!(a.outputs()[k] == b.outputs()[k])){
+			out << "output " << k << " differs" << endl;
+			return false;
+		}
+	}
+	for (int i = 0; i < a.cells(); i++){
+		auto ca = a.control_state(i), cb = b.control_state(i);
+		auto sa = a.storage_state(i), sb = b.storage_state(i);
+		auto ha = a.handling_state(i), hb = b.handling_state(i);
+		if (ca.phase != cb.phase || ca.sending != cb.sending || ca.fin != cb.fin ||
+			ca.total_mats != cb.total_mats || ca.num_prepared != cb.num_prepared ||
+			sa.full != sb.full || sa.sending != sb.sending ||
+			sa.load_request_index != sb.load_request_index || sa.unload_request_index != sb.unload_request_index ||
+			ha.active != hb.active || ha.sending != hb.sending || ha.index != hb.index){
+			out << "final state of cell " << i+1 << " differs" << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+//Wall-clock seconds taken to build and run an engine with n cells
+double time_run(int n, const char* input, bool fallback, TIME until, bool& vectorised){
+	auto begin = chrono::steady_clock::now();
+	MCCS_BatchEngine<TIME> engine(n, input, fallback);
+	engine.run_until(until);
+	vectorised = engine.vectorised();
+	return chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+}
+
+
+/***** (2) *****/
+/***** Create the main function *****/
+int main (){
+	const char *i_input_data = "../input_data/MCCS_input_test_startIn.txt";
+	TIME until = TIME("05:00:00:000");
+	ofstream out("../simulation_results/BatchEngine_test_output.txt");
+
+	/***** Equivalence *****/
+	bool passed = true;
+	for (int n : {1, 7, 64}){
+		MCCS_BatchEngine<TIME> batch(n, i_input_data);
+		MCCS_BatchEngine<TIME> objects(n, i_input_data, true);
+		batch.run_until(until);
+		objects.run_until(until);
+		bool same = batch.vectorised() && !objects.vectorised() && same_cells(batch, objects, out);
+		out << n << " cells: " << batch.outputs().size() << " outputs, " << ((same) ? "identical" : "DIFFERENT") << endl;
+		passed = passed && same;
+	}
+
+	/***** Benchmark *****/
+	out << endl << "cells\tvectorised[s]\tper-object[s]\tspeedup" << endl;
+	for (int n : {1000, 10000}){
+		bool vectorised;
+		double t_batch = time_run(n, i_input_data, false, until, vectorised);
+		double t_objects = time_run(n, i_input_data, true, until, vectorised);
+		out << n << "\t" << t_batch << "\t" << t_objects << "\t" << t_objects/t_batch << endl;
+	}
+	for (int n : {100000, 1000000}){
+		bool vectorised;
+		double t_batch = time_run(n, i_input_data, false, until, vectorised);
+		out << n << "\t" << t_batch << "\t-\t-" << endl;
+	}
+
+	cout << "Batch engine test " << ((passed) ? "passed" : "FAILED") << endl;
+	return (passed) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,136 @@
+//Cadmium Simulator headers
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+//Time class header
+#include <NDTime.hpp>
+
+//Chunked log, plant builder and runner
+#include "../engine/chunked_log.hpp"
+#include "../engine/model_builder.hpp"
+#include "../engine/mccs_runner.hpp"
+
+//C++ libraries
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//Namespaces
+using namespace std;
+using namespace cadmium;
+using TIME = NDTime;
+
+
+/***** (1) *****/
+//The same state log written as text and as a chunked log
+static ofstream plain_log;
+static unique_ptr<Chunked_Log_Stream> chunked_log;
+struct plain_sink{
+	static ostream& sink(){
+		return plain_log;
+	}
+};
+struct chunked_sink{
+	static ostream& sink(){
+		return *chunked_log;
+	}
+};
+using logger_both = logger::multilogger<
+	logger::logger<logger::logger_state, dynamic::logger::formatter<TIME>, plain_sink>,
+	logger::logger<logger::logger_global_time, dynamic::logger::formatter<TIME>, plain_sink>,
+	logger::logger<logger::logger_state, dynamic::logger::formatter<TIME>, chunked_sink>,
+	logger::logger<logger::logger_global_time, dynamic::logger::formatter<TIME>, chunked_sink>>;
+
+string read_file(const string& path){
+	ifstream in(path, ios::binary);
+	return string((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+}
+
+//Steps of a text log in [from, to], as a reader without index has to find them: scanning the whole file
+string scan_range(const string& path, long long from, long long to){
+	ifstream in(path, ios::binary);
+	string line, out;
+	bool inside = false;
+	while (getline(in, line)){
+		long long ms = log_time_line_ms(line.data(), line.size());
+		if (ms >= 0) inside = (ms >= from && ms <= to);
+		if (inside) out += line + "\n";
+	}
+	return out;
+}
+
+
+/***** (2) *****/
+/***** Create the main function *****/
+int main (){
+	ofstream out("../simulation_results/ChunkedLog_test_output.txt");
+	bool passed = true;
+	string plain_path = "../simulation_results/ChunkedLog_test_state.txt";
+	string chunked_path = "../simulation_results/ChunkedLog_test_state.mclog";
+
+	/***** Two lines of the example plant fed by generators for an hour, state logs in both forms *****/
+	Plant_description plant;
+	passed = passed && plant.read("../input_data/MCCS_plant_example.xml");
+	plant.lines = 2;
+	plant.generated = true;
+	plant.generator.mean_interarrival = 20;
+	plain_log.open(plain_path, ios::binary);
+	chunked_log.reset(new Chunked_Log_Stream(chunked_path, 64*1024));
+	{
+		MCCS_Runner<TIME, logger_both> r(build_plant<TIME>(plant), TIME("00:00:00:000"));
+		r.run_until(TIME("01:00:00:000"));
+	}
+	plain_log.close();
+	chunked_log->close();
+	const Chunked_Log_Buffer& written = chunked_log->chunks();
+	out << "text log " << written.raw_bytes()/1024 << " KiB, chunked log " << written.compressed_bytes()/1024 << " KiB in " <<
+		written.chunk_count() << " chunks (" << (double)written.raw_bytes()/written.compressed_bytes() << "x smaller)" << endl;
+
+	/***** The whole chunked log is the text log *****/
+	Chunked_Log_Reader reader;
+	passed = passed && reader.open(chunked_path);
+	ostringstream all;
+	reader.read_range(0, numeric_limits<long long>::max(), all);
+	string text = read_file(plain_path);
+	bool same = (all.str() == text);
+	out << "whole log: " << ((same) ? "identical" : "DIFFERENT") << " to the text log" << endl;
+	passed = passed && same && (long long)reader.index.size() == written.chunk_count() && reader.index.size() > 10;
+
+	/***** A range: same steps as a scan of the text log, from a few chunks (not 5% of them) *****/
+	for (auto range : {make_pair(string("00:42:00:000"), string("00:43:00:000")), make_pair(string("00:00:00:000"), string("00:00:30:000"))}){
+		long long from = log_time_line_ms(range.first.data(), range.first.size());
+		long long to = log_time_line_ms(range.second.data(), range.second.size());
+		auto begin = chrono::steady_clock::now();
+		string scanned = scan_range(plain_path, from, to);
+		double scan_seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		ostringstream queried;
+		Log_Query_Report report = reader.read_range(from, to, queried);
+		bool matches = (queried.str() == scanned) && report.steps > 0 && report.chunks_read*20 < (long long)reader.index.size();
+		out << range.first << " to " << range.second << ": " << ((matches) ? "same steps" : "DIFFERENT STEPS") << " as the scan of the text log in " <<
+			scan_seconds*1000 << " ms; ";
+		report.print(out, reader.index.size());
+		passed = passed && matches;
+	}
+
+	/***** Chunk boundaries are at time lines *****/
+	bool boundaries = true;
+	for (size_t i = 0; i < reader.index.size(); i++){
+		string chunk = reader.chunk(i);
+		size_t end = chunk.find('\n');
+		boundaries = boundaries && end != string::npos && log_time_line_ms(chunk.data(), end) == reader.index[i].first_ms;
+	}
+	out << "every chunk starts with a time line: " << ((boundaries) ? "yes" : "NO") << endl;
+	passed = passed && boundaries;
+
+	remove(plain_path.c_str());
+	remove(chunked_path.c_str());
+	remove((chunked_path + ".idx").c_str());
+	cout << "Chunked log test " << ((passed) ? "passed" : "FAILED") << endl;
+	return (passed) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+//Time class header
+#include <NDTime.hpp>
+
+//Compact cells and the batch engine they are checked against (both include the atomic models and Cadmium headers)
+#include "../engine/compact_cells.hpp"
+#include "../engine/batch_engine.hpp"
+#include "../engine/model_builder.hpp"		//allocated_bytes
+
+//C++ libraries
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+//Namespaces
+using namespace std;
+using TIME = NDTime;
+
+
+/***** (1) *****/
+/***** Compare the compact cells against the batch engine (vectorised or per-object) *****/
+bool same_cells(const MCCS_CompactCells<TIME>& a, const MCCS_BatchEngine<TIME>& b, ostream& out){
+	if (a.outputs().size() != b.outputs().size() || a.prepared() + a.ends() != (long long)b.outputs().size()){
+		out << "different number of outputs: " << a.outputs().size() << " vs " << b.outputs().size() << endl;
+		return false;
+	}
+	for (size_t k = 0; k < a.outputs().size(); k++){
+		const Compact_Output& x = a.outputs()[k];
+		const Batch_Output<TIME>& y = b.outputs()[k];
+		if (x.ms != time_to_milliseconds(y.time) || (int)x.cell != y.cell || x.port != y.port || x.value != y.value){
+			out << "output " << k << " differs" << endl;
+			return false;
+		}
+	}
+	for (int i = 0; i < b.cells(); i++){
+		auto ca = a.control_state(i), cb = b.control_state(i);
+		auto sa = a.storage_state(i), sb = b.storage_state(i);
+		auto ha = a.handling_state(i), hb = b.handling_state(i);
+		if (ca.phase != cb.phase || ca.sending != cb.sending || ca.fin != cb.fin ||
+			ca.total_mats != cb.total_mats || ca.num_prepared != cb.num_prepared ||
+			sa.full != sb.full || sa.sending != sb.sending ||
+			sa.load_request_index != sb.load_request_index || sa.unload_request_index != sb.unload_request_index ||
+			ha.active != hb.active || ha.sending != hb.sending || ha.index != hb.index){
+			out << "final state of cell " << i+1 << " differs" << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+
+/***** (2) *****/
+/***** Create the main function *****/
+int main (){
+	const char *i_input_data = "../input_data/MCCS_input_test_startIn.txt";
+	TIME until = TIME("05:00:00:000");
+	ofstream out("../simulation_results/CompactCells_test_output.txt");
+	bool passed = true;
+
+	MCCS_config stochastic;
+	stochastic.seed = 42;
+	istringstream loading("uniform 1.5 2.5"), moving("exponential 5");
+	passed = stochastic.loading.read(loading) && stochastic.moving.read(moving);
+
+	/***** Equivalence: constant timings against the vectorised engine, random timings against the per-object models *****/
+	for (bool random : {false, true}){
+		for (int n : {1, 7, 64}){
+			MCCS_config config = (random) ? stochastic : MCCS_config();
+			MCCS_CompactCells<TIME> compact(n, i_input_data, config);
+			MCCS_BatchEngine<TIME> reference(n, i_input_data, false, config);
+			compact.run_until(until);
+			reference.run_until(until);
+			bool same = compact.error.empty() && reference.vectorised() == !random && same_cells(compact, reference, out);
+			out << n << " cells, " << ((random) ? "random timings (per-object models): " : "constant timings (vectorised engine): ") <<
+				compact.outputs().size() << " outputs, " << ((same) ? "identical" : "DIFFERENT") << endl;
+			passed = passed && same;
+		}
+	}
+
+	/***** Random times of product 0 (the materials of startIn batches) are drawn from the product's streams *****/
+	MCCS_config products;
+	products.seed = 42;
+	istringstream product_loading("triangular 1 2 4");
+	passed = passed && products.product_loading[0].read(product_loading);
+	MCCS_CompactCells<TIME> compact(7, i_input_data, products);
+	MCCS_BatchEngine<TIME> reference(7, i_input_data, false, products);
+	compact.run_until(until);
+	reference.run_until(until);
+	bool same = compact.error.empty() && !reference.vectorised() && same_cells(compact, reference, out);
+	out << "7 cells, random times of product 0: " << compact.outputs().size() << " outputs, " << ((same) ? "identical" : "DIFFERENT") << endl;
+	passed = passed && same;
+
+	/***** One template for all the cells: names are interned once and built on demand *****/
+	const Cell_Template& shape = *Cell_Template::mccs();
+	bool streams = true;
+	for (uint32_t cell : {0u, 8u, 9u, 99u, 999999u}){
+		for (int role : {COMPACT_STORAGE, COMPACT_HANDLING}){
+			streams = streams && shape.stream_of(cell, role) == CounterRng::stream_of(shape.model_name(cell, role).c_str());
+		}
+	}
+	out << endl << "template: " << shape.names.size() << " interned names, " << shape.couplings.size() << " couplings, " <<
+		shape.bytes() << " bytes for all the cells; RNG streams from the names: " << ((streams) ? "same" : "DIFFERENT") << endl;
+	shape.print(out, 6);
+	passed = passed && streams && &shape == Cell_Template::mccs().get() && shape.names.size() == 17;
+
+	/***** Memory per cell: per-object models, structure of arrays and compact cells *****/
+	out << endl << "representation\tcells\tbytes/cell" << endl;
+	long long before = allocated_bytes();
+	double objects_per_cell, soa_per_cell, compact_per_cell;
+	{
+		MCCS_BatchEngine<TIME> objects(1000, i_input_data, true);
+		objects_per_cell = (allocated_bytes() - before)/1000.0;
+	}
+	before = allocated_bytes();
+	{
+		MCCS_BatchEngine<TIME> soa(100000, i_input_data);
+		soa_per_cell = (allocated_bytes() - before)/100000.0;
+	}
+	out << "per-object\t1000\t" << objects_per_cell << endl;
+	out << "vectorised\t100000\t" << soa_per_cell << endl;
+	out << endl << "compact cells\ttimings\tbytes/cell (measured)\tbytes/cell (engine)\tmaterials prepared\trun[s]" << endl;
+	for (bool random : {false, true}){
+		before = allocated_bytes();
+		auto begin = chrono::steady_clock::now();
+		MCCS_CompactCells<TIME> compact(1000000, i_input_data, (random) ? stochastic : MCCS_config(), 0, false);
+		compact.run_until(until);
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		compact_per_cell = (allocated_bytes() - before)/1000000.0;
+		out << "1000000\t" << ((random) ? "random" : "constant") << "\t" << compact_per_cell << "\t" << compact.bytes_per_cell() << "\t" <<
+			compact.prepared() << "\t" << seconds << endl;
+		passed = passed && compact.prepared() == 6000000 && compact.ends() >= 1000000 && compact_per_cell < 100 &&
+			compact_per_cell*10 < objects_per_cell;
+	}
+
+	cout << "Compact cells test " << ((passed) ? "passed" : "FAILED") << endl;
+	return (passed) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+//Time class header
+#include <NDTime.hpp>
+
+//Dispatcher, plant builder and sweep (to simulate one plant and collect its figures)
+#include "../atomics/dispatcher.hpp"
+#include "../engine/model_builder.hpp"
+#include "../engine/sweep.hpp"
+
+//C++ libraries
+#include <iomanip>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//Namespaces
+using namespace std;
+using TIME = NDTime;
+
+
+/***** (1) *****/
+//Lines chosen by a dispatcher of 3 lines for the given requests, all at time 0
+vector<int> dispatch(int policy, const vector<int>& requests){
+	Dispatcher<TIME> d(3, policy, 7.0);
+	typename make_message_bags<Dispatcher<TIME>::input_ports>::type mbs;
+	get_messages<Dispatcher_defs::startIn>(mbs) = requests;
+	d.external_transition(TIME("00:00:00:000"), mbs);
+	vector<int> lines;
+	auto bags = d.output();
+	for (auto& x : get_messages<Dispatcher_defs::startOut>(bags)) lines.push_back(x.line);
+	return lines;
+}
+
+//3 lines of one stage with random timings, fed by 100 random batches (the lines are busy 80% of the time)
+Plant_description plant(int policy, uint64_t seed){
+	Plant_description p;
+	p.name = "dispatch";
+	p.lines = 3;
+	p.generated = true;
+	p.generator.arrival = 1;
+	p.generator.mean_interarrival = 10;
+	p.generator.batch_min = 1;
+	p.generator.batch_max = 6;
+	p.generator.seed = seed;
+	p.generator.max_batches = 100;
+	Plant_stage stage;
+	stage.name = "cell";
+	stage.config.seed = seed;
+	sweep_apply(p, "lines", "3");
+	p.stages.push_back(stage);
+	sweep_apply(p, "loading_time", "uniform 1 3");
+	sweep_apply(p, "moving_time", "uniform 3 7");
+	p.dispatch = policy;
+	return p;
+}
+
+//The same lines followed by a faster packing stage, which ends after every material while the first stage still works
+Plant_description two_stage_plant(int policy, uint64_t seed){
+	Plant_description p = plant(policy, seed);
+	Plant_stage pack;
+	pack.name = "pack";
+	pack.config.seed = seed + 100;
+	istringstream loading("constant 1"), moving("uniform 1 2");
+	pack.config.loading.read(loading);
+	pack.config.moving.read(moving);
+	p.stages.push_back(pack);
+	return p;
+}
+
+//Feedback of a line, as sent by its gate
+void feedback(Dispatcher<TIME>& d, const vector<Line_Feedback_t>& messages){
+	typename make_message_bags<Dispatcher<TIME>::input_ports>::type mbs;
+	get_messages<Dispatcher_defs::feedbackIn>(mbs) = messages;
+	d.external_transition(TIME("00:00:01:000"), mbs);
+}
+
+//Dispatches one batch and returns the line chosen
+int dispatch_one(Dispatcher<TIME>& d, int amount){
+	typename make_message_bags<Dispatcher<TIME>::input_ports>::type mbs;
+	get_messages<Dispatcher_defs::startIn>(mbs) = {amount};
+	d.external_transition(TIME("00:00:01:000"), mbs);
+	int line = d.state.pending.back().line;
+	d.internal_transition();
+	return line;
+}
+
+
+/***** (2) *****/
+/***** Create the main function *****/
+int main (){
+	ofstream out("../simulation_results/Dispatcher_test_output.txt");
+	bool passed = true;
+
+	/***** Choices of each policy for the same requests *****/
+	vector<int> requests = {5, 1, 1, 1, 2};
+	vector<vector<int>> expected = {{}, {0, 1, 2, 0, 1}, {0, 1, 2, 1, 2}, {0, 1, 2, 1, 2}};
+	for (int policy = DISPATCH_ROUND_ROBIN; policy <= DISPATCH_EARLIEST_COMPLETION; policy++){
+		vector<int> lines = dispatch(policy, requests);
+		out << dispatch_policy_name(policy) << " sends 5 1 1 1 2 to lines";
+		for (int l : lines) out << " " << l;
+		out << ((lines == expected[policy]) ? "" : " WRONG") << endl;
+		passed = passed && lines == expected[policy];
+	}
+
+	/***** endOut of the last stage of a line does not mean that the line is idle *****/
+	Dispatcher<TIME> d(2, DISPATCH_LEAST_WIP, 7.0);
+	bool fed = dispatch_one(d, 3) == 0 && dispatch_one(d, 1) == 1;
+	feedback(d, {{0, Line_Feedback_t::PREPARED}, {0, Line_Feedback_t::END}});		//line 0 still holds 2 materials
+	feedback(d, {{1, Line_Feedback_t::PREPARED}, {1, Line_Feedback_t::END}});		//line 1 is idle
+	fed = fed && d.state.outstanding == vector<long long>{2, 0} && dispatch_one(d, 1) == 1;
+	out << "end of the last stage of a busy line: outstanding " << d.state.outstanding[0] << " " << d.state.outstanding[1] <<
+		((fed) ? "" : " WRONG") << endl;
+	passed = passed && fed;
+
+	/***** Plant: the same 100 batches dispatched by each policy, over several input seeds *****/
+	const int seeds = 5;
+	TIME until = TIME("10:00:00:000");
+	vector<double> makespan(4, 0), wip(4, 0);
+	long long materials = -1;
+	out << fixed << setprecision(1);
+	for (uint64_t seed = 1; seed <= seeds; seed++){
+		for (int policy = DISPATCH_ROUND_ROBIN; policy <= DISPATCH_EARLIEST_COMPLETION; policy++){
+			Sweep_Result r;
+			sweep_simulate<TIME>(plant(policy, seed), until, r);
+			out << "seed " << seed << " " << setw(20) << left << dispatch_policy_name(policy) << right << " prepared " << r.prepared <<
+				"   makespan " << r.makespan << " s   mean work in progress " << setprecision(2) << r.wip << setprecision(1) << endl;
+			makespan[policy] += r.makespan/seeds;
+			wip[policy] += r.wip/seeds;
+			if (policy == DISPATCH_ROUND_ROBIN) materials = r.prepared;
+			passed = passed && r.prepared == materials && r.makespan > 0;	//every material once, whatever the line
+		}
+	}
+	for (int policy = DISPATCH_ROUND_ROBIN; policy <= DISPATCH_EARLIEST_COMPLETION; policy++){
+		out << setw(20) << left << dispatch_policy_name(policy) << right << " mean makespan " << makespan[policy] <<
+			" s (" << 100*(1 - makespan[policy]/makespan[DISPATCH_ROUND_ROBIN]) << "% better)   mean work in progress " <<
+			setprecision(2) << wip[policy] << setprecision(1) << " (" << 100*(1 - wip[policy]/wip[DISPATCH_ROUND_ROBIN]) << "% better)" << endl;
+	}
+	passed = passed && makespan[DISPATCH_LEAST_WIP] <= makespan[DISPATCH_ROUND_ROBIN] &&
+		makespan[DISPATCH_EARLIEST_COMPLETION] <= makespan[DISPATCH_ROUND_ROBIN] &&
+		wip[DISPATCH_LEAST_WIP] < wip[DISPATCH_ROUND_ROBIN] && wip[DISPATCH_EARLIEST_COMPLETION] < wip[DISPATCH_ROUND_ROBIN];
+
+	/***** Two-stage lines: every material goes through both stages once, whatever the policy *****/
+	materials = -1;
+	for (int policy = DISPATCH_ROUND_ROBIN; policy <= DISPATCH_EARLIEST_COMPLETION; policy++){
+		Sweep_Result r;
+		sweep_simulate<TIME>(two_stage_plant(policy, 1), until, r);
+		out << "two stages " << setw(20) << left << dispatch_policy_name(policy) << right << " prepared " << r.prepared <<
+			"   makespan " << r.makespan << " s   mean work in progress " << setprecision(2) << r.wip << setprecision(1) << endl;
+		if (policy == DISPATCH_ROUND_ROBIN) materials = r.prepared;
+		passed = passed && r.prepared == materials && r.prepared > 0 && r.makespan > 0;
+	}
+
+	cout << "Dispatcher test " << ((passed) ? "passed" : "FAILED") << endl;
+	return (passed) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+//Cadmium Simulator headers
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+//Time class header
+#include <NDTime.hpp>
+
+//Messages structures
+#include "../data_structures/message.hpp"
+
+//Atomic model headers
+#include "../atomics/generator.hpp"
+
+//C++ libraries
+#include <iostream>
+#include <fstream>
+#include <string>
+
+//Namespaces
+using namespace std;
+using namespace cadmium;
+using TIME = NDTime;
+
+/***** (1) *****/
+/***** Define output ports for coupled model *****/
+struct top_out_deterministic: public out_port<int>{};
+struct top_out_poisson: public out_port<int>{};
+struct top_out_bursty: public out_port<int>{};
+
+
+/***** (2) *****/
+/***** Create the main function *****/
+int main (){
+	/***** (3) *****/
+	/****** Generator atomic model instantiation *******************/
+	//one generator per arrival process, 10 batches each
+	Generator_config config_deterministic;
+	config_deterministic.arrival = 0;
+	config_deterministic.mean_interarrival = 20.0;
+	config_deterministic.batch_min = 2;
+	config_deterministic.batch_max = 2;
+	config_deterministic.max_batches = 10;
+	shared_ptr<dynamic::modeling::model> generator_deterministic = dynamic::translate::make_dynamic_atomic_model
+					<Generator, TIME, Generator_config>("generator_deterministic", move(config_deterministic));
+	
+	Generator_config config_poisson;
+	config_poisson.arrival = 1;
+	config_poisson.mean_interarrival = 20.0;
+	config_poisson.batch_min = 1;
+	config_poisson.batch_max = 5;
+	config_poisson.seed = 42;
+	config_poisson.max_batches = 10;
+	shared_ptr<dynamic::modeling::model> generator_poisson = dynamic::translate::make_dynamic_atomic_model
+					<Generator, TIME, Generator_config>("generator_poisson", move(config_poisson));
+	
+	Generator_config config_bursty;
+	config_bursty.arrival = 2;
+	config_bursty.mean_interarrival = 60.0;
+	config_bursty.burst_size = 3;
+	config_bursty.burst_gap = 0.5;
+	config_bursty.batch_distribution = 1;
+	config_bursty.batch_mean = 2.5;
+	config_bursty.seed = 7;
+	config_bursty.max_batches = 10;
+	shared_ptr<dynamic::modeling::model> generator_bursty = dynamic::translate::make_dynamic_atomic_model
+					<Generator, TIME, Generator_config>("generator_bursty", move(config_bursty));
+	
+	
+	/***** (4) *****/
+	/*******TOP MODEL********/
+	//create a variable iports_TOP to store input ports of the top model
+	dynamic::modeling::Ports iports_TOP = {};		//no input in this case --> empty vector
+	//output ports
+	dynamic::modeling::Ports oports_TOP = {typeid(top_out_deterministic), typeid(top_out_poisson), typeid(top_out_bursty)};
+	//Submodels
+	dynamic::modeling::Models submodels_TOP = {generator_deterministic, generator_poisson, generator_bursty};
+	//EICs
+	dynamic::modeling::EICs eics_TOP = {};			//no external input
+	//EOCs
+	dynamic::modeling::EOCs eocs_TOP = {dynamic::translate::make_EOC<Generator_defs::startOut,top_out_deterministic>("generator_deterministic"),
+		dynamic::translate::make_EOC<Generator_defs::startOut,top_out_poisson>("generator_poisson"),
+		dynamic::translate::make_EOC<Generator_defs::startOut,top_out_bursty>("generator_bursty")};
+	//ICs
+	dynamic::modeling::ICs ics_TOP = {};
+	
+	/***** Create an instance of the coupled model *****/
+	/* The parameters of the method are the name of the coupled model (i.e. “TOP”), and all the components 
+	 * we have defined in the following order: submodels_TOP, iports_TOP, oports_TOP, eics_TOP, eocs_TOP, ics_TOP
+	 */
+	shared_ptr<dynamic::modeling::coupled<TIME>> TOP = make_shared<dynamic::modeling::coupled<TIME>>
+		("TOP", submodels_TOP, iports_TOP, oports_TOP, eics_TOP, eocs_TOP, ics_TOP);
+	
+	
+	/***** (5) *****/
+	/*************** Loggers *******************/
+	static ofstream out_messages("../simulation_results/Generator_test_output_messages.txt");//the output file to log messages
+	struct oss_sink_messages{
+		static ostream& sink(){
+			return out_messages;
+		}
+	};
+	static ofstream out_state("../simulation_results/Generator_test_output_state.txt");//the output file to log states
+		struct oss_sink_state{
+			static ostream& sink(){
+				return out_state;
+		}
+	};
+	
+	using state = logger::logger<logger::logger_state, dynamic::logger::formatter<TIME>,
+	oss_sink_state>;
+	using log_messages = logger::logger<logger::logger_messages,
+	dynamic::logger::formatter<TIME>, oss_sink_messages>;
+	using global_time_mes = logger::logger<logger::logger_global_time,
+	dynamic::logger::formatter<TIME>, oss_sink_messages>;
+	using global_time_sta = logger::logger<logger::logger_global_time,
+	dynamic::logger::formatter<TIME>, oss_sink_state>;
+	using logger_top = logger::multilogger<state, log_messages, global_time_mes,
+	global_time_sta>;
+	
+	
+	/***** (6) *****/
+	/************** Runner call ************************/
+	dynamic::engine::runner<NDTime, logger_top> r(TOP, {0});	// Name of the TOP model, initial time ("TOP", 0)
+	r.run_until(NDTime("05:00:00:000"));			//alternatively, run_until_passivate();
+	return 0;
+}
\ No newline at end of file
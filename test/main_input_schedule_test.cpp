@@ -0,0 +1,159 @@
+//Cadmium Simulator headers
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include <cadmium/basic_model/pdevs/iestream.hpp>
+
+//Time class header
+#include <NDTime.hpp>
+
+//Shared schedules and their reader
+#include "../data_structures/input_schedule.hpp"
+#include "../atomics/schedule_reader.hpp"
+
+//Runner and allocated_bytes()
+#include "../engine/mccs_runner.hpp"
+#include "../engine/model_builder.hpp"
+
+//C++ libraries
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+
+//Namespaces
+using namespace std;
+using namespace cadmium;
+using namespace cadmium::basic_models::pdevs;
+using TIME = NDTime;
+using LOGGER = logger::not_logger;
+
+
+/***** (1) *****/
+struct top_out: public out_port<int>{};
+
+template<typename T>
+class InputReader_Int : public iestream_input<int, T>{
+public:
+	InputReader_Int() = default;
+	InputReader_Int(const char* file_path) : iestream_input<int, T>(file_path){}
+};
+
+template<typename T>
+class Shared_Reader_Int : public Schedule_Reader<int, T>{
+public:
+	Shared_Reader_Int() = default;
+	Shared_Reader_Int(shared_ptr<const Input_Schedule<int, T>> schedule) : Schedule_Reader<int, T>(schedule){}
+};
+
+//Records the messages sent by the reader
+class Output_Log : public Run_Observer<TIME>{
+public:
+	vector<string> lines;
+	void outputs(const TIME& t, const dynamic::message_bags& top_outbox) override{
+		auto bag = top_outbox.find(type_index(typeid(top_out)));
+		if (bag == top_outbox.end()) return;
+		for (int n : boost::any_cast<const message_bag<top_out>&>(bag->second).messages){
+			ostringstream os;
+			os << t << " " << n;
+			lines.push_back(os.str());
+		}
+	}
+};
+
+//Messages sent by a TOP model made of the reader only, from start until 5h
+template<typename OUT>
+vector<string> replay(shared_ptr<dynamic::modeling::model> reader, const TIME& start){
+	auto top = make_shared<dynamic::modeling::coupled<TIME>>("TOP",
+		dynamic::modeling::Models{reader},
+		dynamic::modeling::Ports{},
+		dynamic::modeling::Ports{typeid(top_out)},
+		dynamic::modeling::EICs{},
+		dynamic::modeling::EOCs{dynamic::translate::make_EOC<OUT, top_out>(reader->get_id())},
+		dynamic::modeling::ICs{});
+	MCCS_Runner<TIME, LOGGER> r(top, start);
+	auto log = make_shared<Output_Log>();
+	r.attach(log);
+	r.run_until(TIME("05:00:00:000"));
+	return log->lines;
+}
+
+
+/***** (2) *****/
+/***** Create the main function *****/
+int main (){
+	ofstream out("../simulation_results/InputSchedule_test_output.txt");
+	bool passed = true;
+
+	/***** Same messages as iestream_input, in the same bags *****/
+	for (string path : {"../input_data/MCCS_input_test_startIn.txt", "../input_data/schedule_input_test.txt"}){
+		const char* i_path = path.c_str();
+		auto file_reader = dynamic::translate::make_dynamic_atomic_model<InputReader_Int, TIME, const char*>("reader", move(i_path));
+		auto shared_reader = dynamic::translate::make_dynamic_atomic_model
+			<Shared_Reader_Int, TIME, shared_ptr<const Input_Schedule<int, TIME>>>("reader", Input_Schedule<int, TIME>::load(path));
+		vector<string> expected = replay<iestream_input_defs<int>::out>(file_reader, TIME("00:00:00:000"));
+		vector<string> got = replay<Schedule_Reader_defs<int>::out>(shared_reader, TIME("00:00:00:000"));
+		bool same = !expected.empty() && got == expected;
+		out << path << ": " << got.size() << " messages, " << ((same) ? "identical to" : "DIFFERENT from") << " iestream_input" << endl;
+		passed = passed && same;
+
+		/***** Seek: a reader started at 10s only sends the events from 10s on *****/
+		TIME start = TIME("00:00:10:000");
+		auto seeked = dynamic::translate::make_dynamic_atomic_model
+			<Shared_Reader_Int, TIME, shared_ptr<const Input_Schedule<int, TIME>>>("reader", Input_Schedule<int, TIME>::load(path));
+		dynamic_pointer_cast<Schedule_Reader<int, TIME>>(seeked)->seek(start);
+		vector<string> later;
+		for (const string& line : expected){
+			if (TIME(line.substr(0, line.find(' '))) >= start) later.push_back(line);
+		}
+		got = replay<Schedule_Reader_defs<int>::out>(seeked, start);
+		same = got == later;
+		out << path << " from " << start << ": " << got.size() << " messages, " << ((same) ? "as expected" : "WRONG") << endl;
+		passed = passed && same;
+	}
+
+	/***** One parse per file *****/
+	long long parses = Input_Schedule<int, TIME>::parses();
+	auto a = Input_Schedule<int, TIME>::load("../input_data/schedule_input_test.txt");
+	auto b = Input_Schedule<int, TIME>::load("../input_data/schedule_input_test.txt");
+	bool once = a == b && Input_Schedule<int, TIME>::parses() - parses <= 1 && a->size() == 7;
+	out << "schedule shared by the readers: " << ((once) ? "yes" : "NO") << endl;
+	passed = passed && once;
+	passed = passed && !Input_Schedule<int, TIME>::load("../input_data/no_such_file.txt");
+
+	/***** Startup time and memory of N readers *****/
+	out << endl << "readers\tiestream[ms]\tiestream[KiB]\tshared[ms]\tshared[KiB]" << endl;
+	for (int n : {10, 100, 500}){
+		const char* path = "../input_data/MCCS_input_test_startIn.txt";
+		long long before = allocated_bytes();
+		auto begin = chrono::steady_clock::now();
+		vector<shared_ptr<dynamic::modeling::model>> file_readers;
+		for (int i = 0; i < n; i++){
+			const char* i_path = path;
+			file_readers.push_back(dynamic::translate::make_dynamic_atomic_model<InputReader_Int, TIME, const char*>("reader", move(i_path)));
+			dynamic_pointer_cast<iestream_input<int, TIME>>(file_readers.back())->internal_transition();		//parses the first lines
+		}
+		double file_ms = chrono::duration<double>(chrono::steady_clock::now() - begin).count()*1000;
+		long long file_bytes = allocated_bytes() - before;
+		file_readers.clear();
+
+		before = allocated_bytes();
+		begin = chrono::steady_clock::now();
+		vector<shared_ptr<dynamic::modeling::model>> shared_readers;
+		auto schedule = Input_Schedule<int, TIME>::load(path);
+		for (int i = 0; i < n; i++){
+			shared_readers.push_back(dynamic::translate::make_dynamic_atomic_model
+				<Shared_Reader_Int, TIME, shared_ptr<const Input_Schedule<int, TIME>>>("reader", shared_ptr<const Input_Schedule<int, TIME>>(schedule)));
+		}
+		double shared_ms = chrono::duration<double>(chrono::steady_clock::now() - begin).count()*1000;
+		long long shared_bytes = allocated_bytes() - before;
+		out << n << "\t" << file_ms << "\t" << file_bytes/1024 << "\t" << shared_ms << "\t" << shared_bytes/1024 << endl;
+	}
+
+	cout << "Input schedule test " << ((passed) ? "passed" : "FAILED") << endl;
+	return (passed) ? 0 : 1;
+}
\ No newline at end of file
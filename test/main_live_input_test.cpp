@@ -0,0 +1,195 @@
+//Cadmium Simulator headers
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+//Time class header
+#include <NDTime.hpp>
+
+//Live input, its queue and its ingestion thread
+#include "../data_structures/mpsc_queue.hpp"
+#include "../atomics/live_input.hpp"
+#include "../engine/live_ingestion.hpp"
+#include "../engine/mccs_runner.hpp"
+#include "../engine/real_time.hpp"
+
+//C++ libraries
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Namespaces
+using namespace std;
+using namespace cadmium;
+using TIME = NDTime;
+
+
+/***** (1) *****/
+struct top_out: public out_port<int>{};
+
+//Records the startOut messages of the live input with their simulated time
+class Output_Log : public Run_Observer<TIME>{
+public:
+	vector<pair<long long, int>> messages;			//ms, amount
+	void outputs(const TIME& t, const dynamic::message_bags& top_outbox) override{
+		auto bag = top_outbox.find(type_index(typeid(top_out)));
+		if (bag == top_outbox.end()) return;
+		for (int n : boost::any_cast<const message_bag<top_out>&>(bag->second).messages){
+			messages.push_back({time_to_milliseconds(t), n});
+		}
+	}
+};
+
+shared_ptr<dynamic::modeling::coupled<TIME>> live_top(shared_ptr<Live_Feed> feed, TIME poll){
+	shared_ptr<dynamic::modeling::model> live_input = dynamic::translate::make_dynamic_atomic_model
+		<Live_Input, TIME, shared_ptr<Live_Feed>, TIME>("live_input", move(feed), move(poll));
+	return make_shared<dynamic::modeling::coupled<TIME>>("TOP",
+		dynamic::modeling::Models{live_input}, dynamic::modeling::Ports{}, dynamic::modeling::Ports{typeid(top_out)},
+		dynamic::modeling::EICs{}, dynamic::modeling::EOCs{dynamic::translate::make_EOC<Live_Input_defs::startOut, top_out>("live_input")},
+		dynamic::modeling::ICs{});
+}
+
+long long sum_of(const vector<pair<long long, int>>& messages){
+	long long sum = 0;
+	for (auto& m : messages) sum += m.second;
+	return sum;
+}
+
+
+/***** (2) *****/
+/***** Create the main function *****/
+int main (){
+	ofstream out("../simulation_results/LiveInput_test_output.txt");
+	bool passed = true;
+
+	/***** Queue: a full queue refuses, 4 producers against one consumer lose nothing and keep their order *****/
+	MPSC_Queue<long long> small(4);
+	bool refused = small.push(1) && small.push(2) && small.push(3) && small.push(4) && !small.push(5);
+	long long v;
+	refused = refused && small.pop(v) && v == 1 && small.push(5);
+	out << "full queue refuses a push: " << ((refused) ? "yes" : "NO") << endl;
+	passed = passed && refused;
+
+	const int producers = 4, per_producer = 200000;
+	MPSC_Queue<long long> queue(1024);
+	vector<thread> threads;
+	auto begin = chrono::steady_clock::now();
+	for (int p = 0; p < producers; p++){
+		threads.emplace_back([&queue, p](){
+			for (long long i = 0; i < per_producer; i++){
+				while (!queue.push(((long long)p << 32) | i)) this_thread::yield();
+			}
+		});
+	}
+	vector<long long> expected(producers, 0);
+	bool ordered = true;
+	for (long long received = 0; received < (long long)producers*per_producer; ){
+		if (!queue.pop(v)) continue;
+		int p = (int)(v >> 32);
+		ordered = ordered && (v & 0xFFFFFFFF) == expected[p];
+		expected[p]++;
+		received++;
+	}
+	for (auto& t : threads) t.join();
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+	out << producers << " producers x " << per_producer << " pushes: " << ((ordered) ? "all received in order" : "LOST OR REORDERED") <<
+		", " << (producers*per_producer)/seconds/1e6 << " million per second" << endl;
+	passed = passed && ordered && !queue.pop(v);
+
+	/***** Requests pushed before the run are sent at the first poll; a closed feed passivates the model *****/
+	auto feed = make_shared<Live_Feed>();
+	feed->push(2);
+	feed->push(3);
+	feed->close();
+	{
+		MCCS_Runner<TIME, logger::not_logger> r(live_top(feed, TIME("00:00:00:100")), TIME("00:00:00:000"));
+		auto log = make_shared<Output_Log>();
+		r.attach(log);
+		r.run_until(TIME("01:00:00:000"));
+		bool first_poll = log->messages.size() == 2 && log->messages[0].first == 100 && sum_of(log->messages) == 5;
+		bool passive = r.next() == numeric_limits<TIME>::infinity() && feed->injected == 2 && feed->latency_us.count() == 2;
+		out << "closed feed: " << log->messages.size() << " requests at the first poll, " << ((passive) ? "passive" : "STILL ACTIVE") << endl;
+		passed = passed && first_poll && passive;
+	}
+
+	/***** Live run: requests pushed during the run are sent at the simulated time of their arrival *****/
+	feed = make_shared<Live_Feed>();
+	TIME poll = TIME("00:00:00:010");
+	{
+		MCCS_Runner<TIME, logger::not_logger> r(live_top(feed, poll), TIME("00:00:00:000"));
+		auto log = make_shared<Output_Log>();
+		r.attach(log);
+		vector<long long> pushed_at;
+		auto start = chrono::steady_clock::now();
+		thread producer([&](){				//stand-in for the real cell: a request every 40 ms
+			for (int i = 1; i <= 10; i++){
+				this_thread::sleep_until(start + chrono::milliseconds(40*i));
+				pushed_at.push_back(chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count());
+				feed->push(i);
+			}
+			feed->close();
+		});
+		Real_Time_Report pacing;
+		r.pace(make_shared<Real_Time_Pacer<TIME>>(Real_Time_Options(), &pacing));
+		r.run_until(TIME("00:00:10:000"));
+		producer.join();
+		bool in_time = log->messages.size() == 10 && sum_of(log->messages) == 55;
+		for (size_t i = 0; in_time && i < log->messages.size(); i++){
+			long long sent = log->messages[i].first;
+			in_time = sent >= pushed_at[i] - 10 - 5 && sent <= pushed_at[i] + 10 + 50;	//around the next poll, with scheduling slack
+			out << "request " << i + 1 << " pushed at " << pushed_at[i] << " ms, sent at simulated " << sent << " ms" << endl;
+		}
+		print_live_latency(out, *feed);
+		passed = passed && in_time && feed->latency_us.count() == 10;
+	}
+
+	/***** Ingestion from a stream (a file here) and from a Unix socket *****/
+	{
+		ofstream requests("../simulation_results/live_test_requests.txt");
+		requests << "1" << endl << "2" << endl << "not a request" << endl << "3";
+	}
+	feed = make_shared<Live_Feed>();
+	{
+		Live_Ingestion ingestion(feed);
+		passed = passed && ingestion.start_stream("../simulation_results/live_test_requests.txt");
+		for (int i = 0; i < 100 && !feed->closed.load(); i++) this_thread::sleep_for(chrono::milliseconds(10));
+	}
+	bool stream_ok = feed->pushed.load() == 3 && feed->closed.load();
+	out << "stream: " << feed->pushed.load() << " requests" << endl;
+	remove("../simulation_results/live_test_requests.txt");
+
+	feed = make_shared<Live_Feed>();
+	bool socket_ok = false;
+	{
+		Live_Ingestion ingestion(feed);
+		string path = "../simulation_results/live_test.sock";
+		if (ingestion.start_socket(path)){
+			int client = socket(AF_UNIX, SOCK_STREAM, 0);
+			sockaddr_un address;
+			memset(&address, 0, sizeof(address));
+			address.sun_family = AF_UNIX;
+			strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+			if (connect(client, (sockaddr*)&address, sizeof(address)) == 0){
+				string lines = "4\n5\n";
+				socket_ok = write(client, lines.data(), lines.size()) == (ssize_t)lines.size();
+			}
+			close(client);
+			for (int i = 0; i < 100 && feed->pushed.load() < 2; i++) this_thread::sleep_for(chrono::milliseconds(10));
+		}
+	}
+	socket_ok = socket_ok && feed->pushed.load() == 2 && feed->closed.load();
+	out << "socket: " << feed->pushed.load() << " requests" << endl;
+	passed = passed && stream_ok && socket_ok;
+
+	cout << "Live input test " << ((passed) ? "passed" : "FAILED") << endl;
+	return (passed) ? 0 : 1;
+}
\ No newline at end of file
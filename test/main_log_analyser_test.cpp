@@ -0,0 +1,216 @@
+//Cadmium Simulator headers
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+//Time class header
+#include <NDTime.hpp>
+
+//Log analyser, chunked log, plant builder and runner
+#include "../engine/log_analyser.hpp"
+#include "../engine/chunked_log.hpp"
+#include "../engine/model_builder.hpp"
+#include "../engine/mccs_runner.hpp"
+
+//C++ libraries
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//Namespaces
+using namespace std;
+using namespace cadmium;
+using TIME = NDTime;
+
+
+/***** (1) *****/
+//The messages and state logs of a run, as text and as chunked logs
+static ofstream messages_log, state_log;
+static unique_ptr<Chunked_Log_Stream> messages_chunked, state_chunked;
+struct messages_sink{
+	static ostream& sink(){
+		return messages_log;
+	}
+};
+struct state_sink{
+	static ostream& sink(){
+		return state_log;
+	}
+};
+struct messages_chunked_sink{
+	static ostream& sink(){
+		return *messages_chunked;
+	}
+};
+struct state_chunked_sink{
+	static ostream& sink(){
+		return *state_chunked;
+	}
+};
+using logger_all = logger::multilogger<
+	logger::logger<logger::logger_messages, dynamic::logger::formatter<TIME>, messages_sink>,
+	logger::logger<logger::logger_global_time, dynamic::logger::formatter<TIME>, messages_sink>,
+	logger::logger<logger::logger_state, dynamic::logger::formatter<TIME>, state_sink>,
+	logger::logger<logger::logger_global_time, dynamic::logger::formatter<TIME>, state_sink>,
+	logger::logger<logger::logger_messages, dynamic::logger::formatter<TIME>, messages_chunked_sink>,
+	logger::logger<logger::logger_global_time, dynamic::logger::formatter<TIME>, messages_chunked_sink>,
+	logger::logger<logger::logger_state, dynamic::logger::formatter<TIME>, state_chunked_sink>,
+	logger::logger<logger::logger_global_time, dynamic::logger::formatter<TIME>, state_chunked_sink>>;
+
+//The aggregates as an ad-hoc script gets them: reading each log line by line, with no threads
+Log_Analysis reference(const string& messages_path, const string& state_path){
+	Log_Analysis a;
+	map<pair<string, long long>, deque<long long>> loaded;
+	string line;
+	long long ms = -1;
+	ifstream messages(messages_path);
+	while (getline(messages, line)){
+		long long t = log_time_line_ms(line.data(), line.size());
+		if (t >= 0){
+			ms = t;
+			continue;
+		}
+		size_t by = line.find("] generated by model ");
+		if (line.empty() || line[0] != '[' || by == string::npos) continue;
+		string model = line.substr(by + 21);
+		size_t pos = 1;
+		while (pos < by){
+			size_t colon = line.find(": {", pos), close = line.find('}', colon);
+			string port = line.substr(pos, colon - pos);
+			port = port.substr(port.rfind(':') + 1);
+			string content = line.substr(colon + 3, close - colon - 3);
+			vector<string> items;
+			for (size_t start = 0; !content.empty(); ){
+				size_t comma = content.find(", ", start);
+				items.push_back(content.substr(start, comma - start));
+				if (comma == string::npos) break;
+				start = comma + 2;
+			}
+			a.messages[model][port] += items.size();
+			for (auto& item : items){
+				bool load = model.compare(0, 7, "control") == 0 && port == "loadOut";
+				bool unload = model.compare(0, 7, "storage") == 0 && port == "unloadedOut";
+				if (!load && !unload) continue;
+				pair<string, long long> key(model.substr(7), stoll(item.substr(14)));
+				if (load){
+					loaded[key].push_back(ms);
+				} else if (!loaded[key].empty()){
+					a.load_to_unload_ms.record(ms - loaded[key].front());
+					loaded[key].pop_front();
+				}
+			}
+			pos = close + 3;
+		}
+	}
+	for (auto& l : loaded) a.unmatched_loads += l.second.size();
+	ifstream state(state_path);
+	map<string, pair<long long, string>> current;		//model -> (since, phase)
+	string model;
+	while (getline(state, line)){
+		long long t = log_time_line_ms(line.data(), line.size());
+		if (t >= 0) ms = t;
+		if (line.compare(0, 16, "State for model ") == 0){
+			model = line.substr(16, line.find(' ', 16) - 16);
+			continue;
+		}
+		if (!model.empty() && line.compare(0, 8, "\tphase: ") == 0){
+			string phase = line.substr(8, line.find(' ', 8) - 8);
+			auto found = current.find(model);
+			if (found != current.end()) a.residency_ms[model][found->second.second] += ms - found->second.first;
+			current[model] = {ms, phase};
+		}
+		model.clear();
+	}
+	for (auto& c : current) a.residency_ms[c.first][c.second.second] += ms - c.second.first;
+	return a;
+}
+
+//The figures of an analysis (without its sizes and times)
+string figures(const Log_Analysis& a){
+	ostringstream os;
+	a.print_json(os);
+	string json = os.str();
+	return json.substr(json.find("\"ports\""));
+}
+
+
+/***** (2) *****/
+/***** Create the main function *****/
+int main (){
+	ofstream out("../simulation_results/LogAnalyser_test_output.txt");
+	bool passed = true;
+	string messages_path = "../simulation_results/LogAnalyser_test_messages.txt";
+	string state_path = "../simulation_results/LogAnalyser_test_state.txt";
+
+	/***** Two lines of the example plant fed by generators for two hours, logs in both forms *****/
+	Plant_description plant;
+	passed = passed && plant.read("../input_data/MCCS_plant_example.xml");
+	plant.lines = 2;
+	plant.generated = true;
+	plant.generator.mean_interarrival = 20;
+	messages_log.open(messages_path, ios::binary);
+	state_log.open(state_path, ios::binary);
+	messages_chunked.reset(new Chunked_Log_Stream(messages_path + ".mclog", 256*1024));
+	state_chunked.reset(new Chunked_Log_Stream(state_path + ".mclog", 256*1024));
+	{
+		MCCS_Runner<TIME, logger_all> r(build_plant<TIME>(plant), TIME("00:00:00:000"));
+		r.run_until(TIME("02:00:00:000"));
+	}
+	messages_log.close();
+	state_log.close();
+	messages_chunked->close();
+	state_chunked->close();
+
+	/***** The analyser gives the figures of the line-by-line reading, on any number of threads *****/
+	auto begin = chrono::steady_clock::now();
+	Log_Analysis expected = reference(messages_path, state_path);
+	double reference_seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+	string expected_figures = figures(expected);
+	out << "line by line reading: " << reference_seconds*1000 << " ms" << endl;
+	passed = passed && expected.load_to_unload_ms.count() > 100 && expected.residency_ms.count("control_prep_1") == 1;
+	Log_Analysis a;
+	for (unsigned threads : {1, 2, 4}){
+		a = analyse_logs({messages_path, state_path}, threads);
+		bool same = a.error.empty() && figures(a) == expected_figures;
+		out << "analyser, " << threads << " threads: " << ((same) ? "same figures" : "DIFFERENT FIGURES") << "; ";
+		a.print_scan(out);
+		passed = passed && same;
+	}
+
+	/***** The parts of a text log start at time lines *****/
+	Mapped_File state;
+	bool mapped = state.open(state_path);
+	vector<size_t> cuts = split_at_time_lines(state.data(), state.size(), 7);
+	bool at_time_lines = mapped && cuts.size() == 8;
+	for (size_t k = 1; k + 1 < cuts.size(); k++){
+		const char* line = state.data() + cuts[k];
+		at_time_lines = at_time_lines && state.data()[cuts[k] - 1] == '\n' &&
+			log_time_line_ms(line, (const char*)memchr(line, '\n', state.size() - cuts[k]) - line) >= 0;
+	}
+	out << "state log cut in " << cuts.size() - 1 << " parts, all at time lines: " << ((at_time_lines) ? "yes" : "NO") << endl;
+	passed = passed && at_time_lines;
+
+	/***** Chunked logs give the same figures *****/
+	Log_Analysis chunked = analyse_logs({messages_path + ".mclog", state_path + ".mclog"}, 2);
+	bool same = chunked.error.empty() && figures(chunked) == expected_figures;
+	out << "chunked logs: " << ((same) ? "same figures" : "DIFFERENT FIGURES") << "; ";
+	chunked.print_scan(out);
+	passed = passed && same;
+
+	out << endl;
+	a.print(out);
+
+	remove(messages_path.c_str());
+	remove(state_path.c_str());
+	for (string path : {messages_path + ".mclog", state_path + ".mclog"}){
+		remove(path.c_str());
+		remove((path + ".idx").c_str());
+	}
+	cout << "Log analyser test " << ((passed) ? "passed" : "FAILED") << endl;
+	return (passed) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,188 @@
+//Cadmium Simulator headers
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+//Time class header
+#include <NDTime.hpp>
+
+//Log profiles, plant builder, runner and statistics
+#include "../engine/log_profiles.hpp"
+#include "../engine/model_builder.hpp"
+#include "../engine/mccs_runner.hpp"
+#include "../engine/statistics.hpp"
+
+//C++ libraries
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//Namespaces
+using namespace std;
+using namespace cadmium;
+using TIME = NDTime;
+
+
+/***** (1) *****/
+//Loggers of the profiles, writing to files
+static ofstream messages_log, state_log;
+struct messages_sink{
+	static ostream& sink(){
+		return messages_log;
+	}
+};
+struct state_sink{
+	static ostream& sink(){
+		return state_log;
+	}
+};
+using log_messages = logger::logger<logger::logger_messages, dynamic::logger::formatter<TIME>, messages_sink>;
+using global_time_mes = logger::logger<logger::logger_global_time, dynamic::logger::formatter<TIME>, messages_sink>;
+using log_state = logger::logger<logger::logger_state, dynamic::logger::formatter<TIME>, state_sink>;
+using global_time_sta = logger::logger<logger::logger_global_time, dynamic::logger::formatter<TIME>, state_sink>;
+using logger_full = logger::multilogger<log_state, log_messages, global_time_mes, global_time_sta>;
+using logger_messages_only = Profile_Logger<logger::multilogger<log_messages, global_time_mes>, false, true>;
+
+//Atomic model counting how many times its state is turned into a string
+static long long state_strings = 0;
+struct Ticker_defs{
+	struct out : public out_port<int>{};
+};
+template<typename TIME> class Ticker{
+public:
+	using input_ports = tuple<>;
+	using output_ports = tuple<typename Ticker_defs::out>;
+	struct state_type{
+		int ticks = 0;
+	};
+	state_type state;
+
+	void internal_transition(){ state.ticks++; }
+	void external_transition(TIME e, typename make_message_bags<input_ports>::type mbs){}
+	void confluence_transition(TIME e, typename make_message_bags<input_ports>::type mbs){ internal_transition(); }
+	typename make_message_bags<output_ports>::type output() const{
+		typename make_message_bags<output_ports>::type bags;
+		get_messages<typename Ticker_defs::out>(bags).push_back(state.ticks);
+		return bags;
+	}
+	TIME time_advance() const{ return TIME("00:00:01:000"); }
+
+	friend ostringstream& operator<< (ostringstream& os, const typename Ticker<TIME>::state_type& i){
+		state_strings++;
+		os << "ticks: " << i.ticks;
+		return os;
+	}
+};
+
+//State strings built by a ticker (one step a second) run for 1000 s with LOGGER
+template<typename LOGGER>
+long long ticker_state_strings(){
+	state_strings = 0;
+	shared_ptr<dynamic::modeling::model> ticker = dynamic::translate::make_dynamic_atomic_model<Ticker, TIME>("ticker");
+	auto top = make_shared<dynamic::modeling::coupled<TIME>>("TOP", dynamic::modeling::Models{ticker}, dynamic::modeling::Ports{},
+		dynamic::modeling::Ports{}, dynamic::modeling::EICs{}, dynamic::modeling::EOCs{}, dynamic::modeling::ICs{});
+	MCCS_Runner<TIME, LOGGER> r(top, TIME("00:00:00:000"));
+	r.run_until(TIME("00:16:40:000"));
+	return state_strings;
+}
+
+struct Profile_Run{
+	long long steps = 0;
+	TIME last;
+	double seconds = 0;
+	long long prepared = -1;		//summary only
+};
+
+//The plant run with LOGGER (and the statistics for the summary profile)
+template<typename LOGGER>
+Profile_Run run(const Plant_description& plant, bool summary){
+	Profile_Run p;
+	MCCS_Runner<TIME, LOGGER> r(build_plant<TIME>(plant), TIME("00:00:00:000"));
+	shared_ptr<MCCS_Statistics<TIME>> statistics;
+	if (summary){
+		statistics = make_shared<MCCS_Statistics<TIME>>();
+		statistics->template count_port<Plant_defs::out_mat_prepared>("matPreparedOut");
+		r.attach(statistics);
+	}
+	auto begin = chrono::steady_clock::now();
+	r.run_until(TIME("04:00:00:000"));
+	p.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+	p.steps = r.steps();
+	p.last = r.last();
+	if (summary) p.prepared = statistics->messages("matPreparedOut");
+	return p;
+}
+
+string read_file(const string& path){
+	ifstream in(path, ios::binary);
+	return string((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+}
+
+
+/***** (2) *****/
+/***** Create the main function *****/
+int main (){
+	ofstream out("../simulation_results/LogProfiles_test_output.txt");
+	bool passed = true;
+	string messages_path = "../simulation_results/LogProfiles_test_messages.txt";
+	string state_path = "../simulation_results/LogProfiles_test_state.txt";
+	string messages_only_path = "../simulation_results/LogProfiles_test_messages_only.txt";
+
+	/***** Without logs, no state is turned into a string *****/
+	state_log.open(state_path, ios::binary);
+	messages_log.open(messages_path, ios::binary);
+	long long full_strings = ticker_state_strings<logger_full>();
+	long long quiet_strings = ticker_state_strings<Quiet_Logger>();
+	long long not_logger_strings = ticker_state_strings<logger::not_logger>();
+	state_log.close();
+	messages_log.close();
+	out << "state strings of 1000 s of a ticker: full " << full_strings << ", not_logger " << not_logger_strings << ", none " <<
+		quiet_strings << endl;
+	passed = passed && full_strings >= 1000 && quiet_strings == 0;
+
+	/***** Two lines of the example plant fed by generators for 4 hours, with each profile *****/
+	Plant_description plant;
+	bool read = plant.read("../input_data/MCCS_plant_example.xml");
+	passed = passed && read;
+	plant.lines = 2;
+	plant.generated = true;
+	plant.generator.mean_interarrival = 20;
+	vector<Profile_Run> runs;
+	state_log.open(state_path, ios::binary);
+	messages_log.open(messages_path, ios::binary);
+	runs.push_back(run<logger_full>(plant, false));
+	state_log.close();
+	messages_log.close();
+	messages_log.open(messages_only_path, ios::binary);
+	runs.push_back(run<logger_messages_only>(plant, false));
+	messages_log.close();
+	runs.push_back(run<Quiet_Logger>(plant, true));
+	runs.push_back(run<Quiet_Logger>(plant, false));
+
+	out << left << setw(10) << "profile" << setw(10) << "steps" << setw(12) << "seconds" << setw(16) << "steps/s" << "speed-up" << endl;
+	for (int profile = LOG_FULL; profile <= LOG_NONE; profile++){
+		const Profile_Run& p = runs[profile];
+		out << left << setw(10) << log_profile_name(profile) << setw(10) << p.steps << setw(12) << p.seconds << setw(16) <<
+			p.steps/p.seconds << runs[LOG_FULL].seconds/p.seconds << "x" << endl;
+		passed = passed && p.steps == runs[LOG_FULL].steps && p.last == runs[LOG_FULL].last;
+	}
+	out << "materials prepared (summary): " << runs[LOG_SUMMARY].prepared << endl;
+	passed = passed && runs[LOG_SUMMARY].prepared > 0 && runs[LOG_NONE].seconds < runs[LOG_FULL].seconds;
+
+	/***** The messages profile writes the messages log of the full profile *****/
+	bool same = read_file(messages_only_path) == read_file(messages_path);
+	out << "messages log of the messages profile: " << ((same) ? "same as" : "DIFFERENT FROM") << " the full profile" << endl;
+	passed = passed && same && read_file(messages_path).size() > 0;
+
+	remove(messages_path.c_str());
+	remove(state_path.c_str());
+	remove(messages_only_path.c_str());
+	cout << "Log profiles test " << ((passed) ? "passed" : "FAILED") << endl;
+	return (passed) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+//Cadmium Simulator headers
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+//Time class header
+#include <NDTime.hpp>
+
+//Plant builder, runner and snapshots
+#include "../engine/model_builder.hpp"
+#include "../engine/mccs_runner.hpp"
+#include "../engine/checkpoint.hpp"
+
+//C++ libraries
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//Namespaces
+using namespace std;
+using namespace cadmium;
+using TIME = NDTime;
+using LOGGER = logger::not_logger;
+
+
+/***** (1) *****/
+//Records the materials prepared by the plant, to compare two runs
+class Output_Log : public Run_Observer<TIME>{
+public:
+	vector<string> lines;
+	void outputs(const TIME& t, const dynamic::message_bags& top_outbox) override{
+		auto bag = top_outbox.find(type_index(typeid(Plant_defs::out_mat_prepared)));
+		if (bag == top_outbox.end()) return;
+		for (int n : boost::any_cast<const message_bag<Plant_defs::out_mat_prepared>&>(bag->second).messages){
+			ostringstream os;
+			os << t << " " << n;
+			lines.push_back(os.str());
+		}
+	}
+};
+
+
+/***** (2) *****/
+/***** Create the main function *****/
+int main (){
+	TIME until = TIME("05:00:00:000");
+	ofstream out("../simulation_results/ModelBuilder_test_output.txt");
+	bool passed = true;
+
+	/***** Description *****/
+	Plant_description example;
+	bool read = example.read("../input_data/MCCS_plant_example.xml");
+	out << "example plant: " << ((read) ? "read" : "NOT READ " + example.error) << ", " << example.lines << " lines, " <<
+		example.stages.size() << " stages" << endl;
+	passed = read && example.lines == 4 && example.stages.size() == 2 && !example.generated;
+	Plant_description invalid;
+	invalid.read("../input_data/MCCS_config_test.txt");
+	out << "invalid description rejected: " << invalid.error << endl;
+	passed = passed && !invalid.error.empty();
+
+	/***** Multi-stage lines: every material requested by the input goes through both stages *****/
+	auto top = build_plant<TIME>(example);
+	MCCS_Runner<TIME, LOGGER> r(top, TIME("00:00:00:000"));
+	r.run_until(TIME("00:00:15:000"));
+	auto snapshot = Checkpointer<TIME>(top).snapshot(r.last());
+	auto reference = make_shared<Output_Log>();
+	r.attach(reference);
+	r.run_until(until);
+	out << "materials prepared by the last stage after 15s: " << reference->lines.size() << endl;
+	passed = passed && reference->lines.size() == 4*6;		//input file: batches of 2, 1 and 3
+
+	/***** A plant restored from a snapshot continues like the original one *****/
+	auto restored_top = build_plant<TIME>(example);
+	TIME start;
+	bool restored = Checkpointer<TIME>(restored_top).restore(*snapshot, start);
+	MCCS_Runner<TIME, LOGGER> restored_r(restored_top, start);
+	auto restored_log = make_shared<Output_Log>();
+	restored_r.attach(restored_log);
+	restored_r.run_until(until);
+	bool same = restored && restored_log->lines == reference->lines;
+	out << "restored plant " << ((same) ? "identical to" : "DIFFERENT from") << " the original one" << endl;
+	passed = passed && same;
+
+	/***** Build time and memory *****/
+	out << endl << "lines\tstages\tatomic models\tbuild[ms]\tmemory[KiB]" << endl;
+	Plant_description generated = example;
+	generated.generated = true;
+	for (long long lines : {1000LL, 10000LL, 25000LL}){
+		for (size_t stages : {(size_t)1, (size_t)2}){
+			generated.lines = lines;
+			generated.stages.assign(example.stages.begin(), example.stages.begin() + stages);
+			Plant_build_report report;
+			{
+				auto plant_top = build_plant<TIME>(generated, &report);
+			}
+			out << lines << "\t" << stages << "\t" << report.atomic_models << "\t" << report.seconds*1000 << "\t" <<
+				report.memory_bytes/1024 << endl;
+		}
+	}
+
+	cout << "Model builder test " << ((passed) ? "passed" : "FAILED") << endl;
+	return (passed) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,278 @@
+//Cadmium Simulator headers
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+//Time class header
+#include <NDTime.hpp>
+
+//Messages structures
+#include "../data_structures/message.hpp"
+#include "../data_structures/order.hpp"
+#include "../data_structures/input_schedule.hpp"
+#include "../data_structures/rng.hpp"
+#include "../data_structures/timing.hpp"
+
+//Atomic model headers
+#include "../atomics/control.hpp"
+#include "../atomics/storage.hpp"
+#include "../atomics/handling.hpp"
+#include "../atomics/schedule_reader.hpp"
+
+//Runner
+#include "../engine/mccs_runner.hpp"
+
+//C++ libraries
+#include <math.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//Namespaces
+using namespace std;
+using namespace cadmium;
+using TIME = NDTime;
+using LOGGER = logger::not_logger;
+
+
+/***** (1) *****/
+//ports of the TOP model
+struct top_out_mat_prepared: public out_port<int>{};
+struct top_out_end: public out_port<int>{};
+//ports for the Inventory handler
+struct ih_in_load: public in_port<Message_t>{};
+struct ih_in_prep: public in_port<Message_t>{};
+struct ih_out_loaded: public out_port<Message_t>{};
+struct ih_out_unloaded: public out_port<Message_t>{};
+
+template<typename T>
+class Shared_Reader_Int : public Schedule_Reader<int, T>{
+public:
+	Shared_Reader_Int() = default;
+	Shared_Reader_Int(shared_ptr<const Input_Schedule<int, T>> schedule) : Schedule_Reader<int, T>(schedule){}
+};
+
+template<typename T>
+class Shared_Reader_Order : public Schedule_Reader<Order_t, T>{
+public:
+	Shared_Reader_Order() = default;
+	Shared_Reader_Order(shared_ptr<const Input_Schedule<Order_t, T>> schedule) : Schedule_Reader<Order_t, T>(schedule){}
+};
+
+//Records the matPreparedOut and endOut messages of the cell
+class Output_Log : public Run_Observer<TIME>{
+public:
+	vector<string> lines;
+	TIME last_end;
+	void outputs(const TIME& t, const dynamic::message_bags& top_outbox) override{
+		record<top_out_mat_prepared>(t, top_outbox, "matPreparedOut");
+		if (record<top_out_end>(t, top_outbox, "endOut")) last_end = t;
+	}
+
+private:
+	template<typename PORT>
+	bool record(const TIME& t, const dynamic::message_bags& top_outbox, const char* name){
+		auto bag = top_outbox.find(type_index(typeid(PORT)));
+		if (bag == top_outbox.end()) return false;
+		for (int n : boost::any_cast<const message_bag<PORT>&>(bag->second).messages){
+			ostringstream os;
+			os << t << " " << name << " " << n;
+			lines.push_back(os.str());
+		}
+		return true;
+	}
+};
+
+//One cell (control, storage, handling) fed by a reader of start requests (int) or orders
+template<typename MSG>
+shared_ptr<dynamic::modeling::coupled<TIME>> build_cell(const MCCS_config& config, int sequencing,
+		shared_ptr<const Input_Schedule<MSG, TIME>> schedule, shared_ptr<Control<TIME>>& control){
+	shared_ptr<dynamic::modeling::model> reader;
+	dynamic::modeling::ICs ics;
+	if constexpr (is_same<MSG, int>::value){
+		reader = dynamic::translate::make_dynamic_atomic_model
+			<Shared_Reader_Int, TIME, shared_ptr<const Input_Schedule<int, TIME>>>("reader", move(schedule));
+		ics = {dynamic::translate::make_IC<Schedule_Reader_defs<int>::out, Control_defs::startIn>("reader", "control1")};
+	} else {
+		reader = dynamic::translate::make_dynamic_atomic_model
+			<Shared_Reader_Order, TIME, shared_ptr<const Input_Schedule<Order_t, TIME>>>("reader", move(schedule));
+		ics = {dynamic::translate::make_IC<Schedule_Reader_defs<Order_t>::out, Control_defs::orderIn>("reader", "control1")};
+	}
+	auto storage1 = dynamic::translate::make_dynamic_atomic_model<Storage, TIME, Timing, map<int, Timing>>("storage1",
+		config.storage_timing("storage1"), config.storage_product_timings("storage1"));
+	auto handling1 = dynamic::translate::make_dynamic_atomic_model<Handling, TIME, Timing, map<int, Timing>>("handling1",
+		config.handling_timing("handling1"), config.handling_product_timings("handling1"));
+	auto control1 = dynamic::translate::make_dynamic_atomic_model<Control, TIME, int, vector<double>>("control1",
+		move(sequencing), config.unit_seconds_table());
+	control = dynamic_pointer_cast<Control<TIME>>(control1);
+	auto IH = make_shared<dynamic::modeling::coupled<TIME>>("IH",
+		dynamic::modeling::Models{storage1, handling1},
+		dynamic::modeling::Ports{typeid(ih_in_load), typeid(ih_in_prep)},
+		dynamic::modeling::Ports{typeid(ih_out_loaded), typeid(ih_out_unloaded)},
+		dynamic::modeling::EICs{dynamic::translate::make_EIC<ih_in_load, Storage_defs::loadIn>("storage1"),
+			dynamic::translate::make_EIC<ih_in_prep, Handling_defs::prepIn>("handling1")},
+		dynamic::modeling::EOCs{dynamic::translate::make_EOC<Storage_defs::loadedOut, ih_out_loaded>("storage1"),
+			dynamic::translate::make_EOC<Storage_defs::unloadedOut, ih_out_unloaded>("storage1")},
+		dynamic::modeling::ICs{dynamic::translate::make_IC<Handling_defs::unloadOut, Storage_defs::unloadIn>("handling1", "storage1")});
+	ics.push_back(dynamic::translate::make_IC<Control_defs::loadOut, ih_in_load>("control1", "IH"));
+	ics.push_back(dynamic::translate::make_IC<Control_defs::prepOut, ih_in_prep>("control1", "IH"));
+	ics.push_back(dynamic::translate::make_IC<ih_out_loaded, Control_defs::loadedIn>("IH", "control1"));
+	ics.push_back(dynamic::translate::make_IC<ih_out_unloaded, Control_defs::unloadedIn>("IH", "control1"));
+	return make_shared<dynamic::modeling::coupled<TIME>>("TOP",
+		dynamic::modeling::Models{reader, control1, IH},
+		dynamic::modeling::Ports{},
+		dynamic::modeling::Ports{typeid(top_out_mat_prepared), typeid(top_out_end)},
+		dynamic::modeling::EICs{},
+		dynamic::modeling::EOCs{dynamic::translate::make_EOC<Control_defs::matPreparedOut, top_out_mat_prepared>("control1"),
+			dynamic::translate::make_EOC<Control_defs::endOut, top_out_end>("control1")},
+		ics);
+}
+
+template<typename MSG>
+shared_ptr<const Input_Schedule<MSG, TIME>> schedule_of(const vector<pair<long long, MSG>>& events){
+	auto schedule = make_shared<Input_Schedule<MSG, TIME>>();
+	for (auto& e : events){
+		schedule->times.push_back(time_from_milliseconds<TIME>(e.first));
+		schedule->messages.push_back(e.second);
+	}
+	return schedule;
+}
+
+Order_t order(int product, int quantity, double due = -1){
+	Order_t o;
+	o.product = product;
+	o.quantity = quantity;
+	o.due = due;
+	return o;
+}
+
+struct Orders_Run{
+	vector<string> lines;
+	TIME last_end;
+	long long done_in_window = 0;			//orders done by the end of the arrivals
+	long long prepared = 0;
+	long long done = 0;
+	double mean_flow_time = 0;
+	double mean_tardiness = 0;
+	long long late = 0;
+};
+
+template<typename MSG>
+Orders_Run run(const MCCS_config& config, int sequencing, const vector<pair<long long, MSG>>& events,
+		const TIME& window, const TIME& until){
+	Orders_Run p;
+	shared_ptr<Control<TIME>> control;
+	MCCS_Runner<TIME, LOGGER> r(build_cell<MSG>(config, sequencing, schedule_of<MSG>(events), control), TIME("00:00:00:000"));
+	auto log = make_shared<Output_Log>();
+	r.attach(log);
+	r.run_until(window);
+	p.done_in_window = control->state.orders_done;
+	r.run_until(until);
+	p.lines = log->lines;
+	p.last_end = log->last_end;
+	p.prepared = control->state.num_prepared;
+	p.done = control->state.orders_done;
+	p.mean_flow_time = control->mean_flow_time();
+	p.mean_tardiness = control->mean_tardiness();
+	p.late = control->state.late;
+	return p;
+}
+
+
+/***** (2) *****/
+/***** Create the main function *****/
+int main (){
+	ofstream out("../simulation_results/Orders_test_output.txt");
+	bool passed = true;
+
+	/***** Orders of product 0 without due date give the outputs of the same int start requests *****/
+	MCCS_config stochastic;
+	stochastic.seed = 42;
+	stochastic.loading.distribution = 1;
+	stochastic.loading.a = 1.5;
+	stochastic.loading.b = 2.5;
+	vector<pair<long long, int>> starts = {{5000, 2}, {10000, 1}, {20000, 3}, {200000, 2}};
+	vector<pair<long long, Order_t>> same_orders;
+	for (auto& s : starts) same_orders.push_back({s.first, order(0, s.second)});
+	TIME hour("01:00:00:000");
+	Orders_Run legacy = run<int>(stochastic, SEQUENCE_FIFO, starts, hour, hour);
+	for (int policy = SEQUENCE_FIFO; policy <= SEQUENCE_EDD; policy++){
+		Orders_Run typed = run<Order_t>(stochastic, policy, same_orders, hour, hour);
+		bool same = !legacy.lines.empty() && typed.lines == legacy.lines && typed.done == 4;
+		out << "product 0 orders, " << sequencing_policy_name(policy) << ": " << typed.lines.size() << " outputs, " <<
+			((same) ? "same as" : "DIFFERENT FROM") << " the int start requests" << endl;
+		passed = passed && same;
+	}
+
+	/***** Each product takes its own load and move times *****/
+	MCCS_config products;				//product 0: 2 + 5 s (the defaults)
+	products.product_loading[1] = Timing(1);
+	products.product_moving[1] = Timing(3);
+	products.product_loading[2] = Timing(4);
+	products.product_moving[2] = Timing(10);
+	vector<double> units = products.unit_seconds_table();
+	out << endl << "seconds per material:";
+	for (size_t p = 0; p < units.size(); p++) out << " " << units[p];
+	out << endl;
+	passed = passed && units.size() == 4 && units[0] == 7 && units[1] == 4 && units[2] == 14 && units[3] == 7;
+	for (int p = 0; p <= 2; p++){
+		Orders_Run one = run<Order_t>(products, SEQUENCE_FIFO, {{0, order(p, 5)}}, hour, hour);
+		double seconds = time_to_seconds(one.last_end);
+		out << "5 of product " << p << ": done at " << one.last_end << endl;
+		passed = passed && one.prepared == 5 && fabs(seconds - 5*units[p]) < 1e-9;
+	}
+
+	/***** The policies on the orders present at time 0 *****/
+	//a long order first, then two short ones with close due dates
+	vector<pair<long long, Order_t>> waiting = {{0, order(2, 6, 200)}, {0, order(1, 2, 100)}, {0, order(0, 3, 60)}};
+	double expected_flow[] = {(84 + 92 + 113)/3.0, (8 + 29 + 113)/3.0, (21 + 29 + 113)/3.0};
+	for (int policy = SEQUENCE_FIFO; policy <= SEQUENCE_EDD; policy++){
+		Orders_Run p = run<Order_t>(products, policy, waiting, hour, hour);
+		out << sequencing_policy_name(policy) << ", 3 orders at 0: mean flow time " << p.mean_flow_time << " s, mean tardiness " <<
+			p.mean_tardiness << " s, " << p.late << " late, all done at " << p.last_end << endl;
+		passed = passed && p.done == 3 && fabs(p.mean_flow_time - expected_flow[policy]) < 1e-9 && time_to_seconds(p.last_end) == 113;
+	}
+
+	/***** A random stream of orders of the 3 products (utilisation about 0.9) *****/
+	SplitMix64 rng(7);
+	vector<pair<long long, Order_t>> stream;
+	double work = 0;
+	long long arrival = 0;
+	TIME window("100:00:00:000");
+	while (true){
+		arrival += (long long)llround(-50000*log(1 - rng.uniform()));			//mean 50 s
+		if (arrival >= time_to_milliseconds(window)) break;
+		int product = (int)(rng.uniform()*3);
+		int quantity = 1 + (int)(rng.uniform()*10);
+		double due = (2 + 4*rng.uniform())*quantity*units[product];		//2 to 6 times the order's work
+		stream.push_back({arrival, order(product, quantity, due)});
+		work += quantity*units[product];
+	}
+	out << endl << stream.size() << " random orders in " << window << ", utilisation " << work/time_to_seconds(window) << endl;
+	TIME until("150:00:00:000");
+	Orders_Run policy_runs[3];
+	for (int policy = SEQUENCE_FIFO; policy <= SEQUENCE_EDD; policy++){
+		Orders_Run& p = policy_runs[policy];
+		p = run<Order_t>(products, policy, stream, window, until);
+		out << sequencing_policy_name(policy) << ": " << p.done << " orders done (" << p.done_in_window << " in the first " << window <<
+			", " << p.done_in_window/time_to_seconds(window)*3600 << " per hour), " << p.prepared << " materials, mean flow time " <<
+			p.mean_flow_time << " s, mean tardiness " << p.mean_tardiness << " s, " << p.late << " late" << endl;
+		passed = passed && p.done == (long long)stream.size() && p.prepared == policy_runs[SEQUENCE_FIFO].prepared;
+	}
+	const Orders_Run& fifo = policy_runs[SEQUENCE_FIFO];
+	const Orders_Run& spt = policy_runs[SEQUENCE_SPT];
+	const Orders_Run& edd = policy_runs[SEQUENCE_EDD];
+	out << "spt against fifo: mean flow time " << (1 - spt.mean_flow_time/fifo.mean_flow_time)*100 << "% lower, " <<
+		spt.done_in_window - fifo.done_in_window << " more orders done in the window" << endl;
+	out << "edd against fifo: mean tardiness " << (1 - edd.mean_tardiness/fifo.mean_tardiness)*100 << "% lower, " <<
+		fifo.late - edd.late << " fewer late orders" << endl;
+	passed = passed && spt.mean_flow_time < fifo.mean_flow_time && spt.done_in_window >= fifo.done_in_window &&
+		edd.mean_tardiness <= fifo.mean_tardiness;
+
+	cout << "Orders test " << ((passed) ? "passed" : "FAILED") << endl;
+	return (passed) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+//Cadmium Simulator headers
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+//Time class header
+#include <NDTime.hpp>
+
+//Parallel steps, plant builder, runner and statistics
+#include "../engine/parallel_step.hpp"
+#include "../engine/model_builder.hpp"
+#include "../engine/mccs_runner.hpp"
+#include "../engine/statistics.hpp"
+
+//C++ libraries
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//Namespaces
+using namespace std;
+using namespace cadmium;
+using TIME = NDTime;
+
+
+/***** (1) *****/
+//State and messages logs of a run, kept in memory to compare the runs
+static ostringstream run_log;
+struct string_sink{
+	static ostream& sink(){
+		return run_log;
+	}
+};
+using logger_all = logger::multilogger<logger::logger<logger::logger_state, dynamic::logger::formatter<TIME>, string_sink>,
+	logger::logger<logger::logger_messages, dynamic::logger::formatter<TIME>, string_sink>,
+	logger::logger<logger::logger_global_time, dynamic::logger::formatter<TIME>, string_sink>>;
+
+struct Plant_Run{
+	string log;
+	long long steps = 0;
+	long long prepared = 0;
+	long long ends = 0;
+	double seconds = 0;
+};
+
+//A plant run until until; threads = 0: the sequential runner
+template<typename LOGGER>
+Plant_Run run(const Plant_description& plant, const TIME& until, unsigned threads, size_t threshold){
+	Plant_Run p;
+	run_log.str("");
+	auto TOP = build_plant<TIME>(plant);
+	auto begin = chrono::steady_clock::now();
+	MCCS_Runner<TIME, LOGGER> r(TOP, TIME("00:00:00:000"));
+	if constexpr (is_parallel_logger<LOGGER>::value){
+		r.execute(make_shared<Parallel_Steps<TIME>>(TOP, threads, threshold));
+	}
+	auto statistics = make_shared<MCCS_Statistics<TIME>>();
+	statistics->count_port<Plant_defs::out_mat_prepared>("matPreparedOut");
+	statistics->count_port<Plant_defs::out_end>("endOut");
+	r.attach(statistics);
+	r.run_until(until);
+	p.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+	p.steps = r.steps();
+	p.prepared = statistics->messages("matPreparedOut");
+	p.ends = statistics->messages("endOut");
+	p.log = run_log.str();
+	return p;
+}
+
+
+/***** (2) *****/
+/***** Create the main function *****/
+int main (){
+	ofstream out("../simulation_results/ParallelStep_test_output.txt");
+	bool passed = true;
+
+	/***** The pool runs every task once, shares out a slow block and passes on exceptions *****/
+	Work_Stealing_Pool pool(4);
+	vector<atomic<int>> runs(20000);
+	for (auto& c : runs) c = 0;
+	pool.run(runs.size(), [&runs](size_t i){
+		if (i < 2000){
+			volatile double x = 0;
+			for (int k = 0; k < 20000; k++) x = x + k;			//the first block is slow
+		}
+		runs[i]++;
+	});
+	bool once = true;
+	for (auto& c : runs) once = once && c == 1;
+	bool thrown = false;
+	try {
+		pool.run(100, [](size_t i){ if (i == 7) throw runtime_error("task 7"); });
+	} catch (runtime_error& e){
+		thrown = string(e.what()) == "task 7";
+	}
+	long long after = 0;
+	pool.run(1000, [&runs](size_t i){ runs[i]++; });
+	for (size_t i = 0; i < 1000; i++) after += runs[i];
+	out << "pool of " << pool.threads() << " threads: every task run once " << once << ", " << pool.steals() <<
+		" tasks stolen, exception passed on " << thrown << ", usable after it " << (after == 2000) << endl;
+	passed = passed && once && pool.steals() > 0 && thrown && after == 2000;
+
+	/***** 32 lines of the example plant: the parallel steps give the logs of the sequential runner *****/
+	Plant_description plant;
+	bool read = plant.read("../input_data/MCCS_plant_example.xml");
+	plant.lines = 32;
+	TIME until("01:00:00:000");
+	Plant_Run sequential = run<logger_all>(plant, until, 0, 0);
+	out << "32 lines, sequential: " << sequential.steps << " steps, " << sequential.prepared << " prepared, " <<
+		sequential.ends << " ends, " << sequential.log.size() << " bytes of logs" << endl;
+	passed = passed && read && sequential.prepared > 0;
+	for (size_t threshold : {1, 16}){
+		for (unsigned threads : {1, 2, 4}){
+			Plant_Run parallel = run<Parallel_Logger<logger_all>>(plant, until, threads, threshold);
+			bool same = parallel.log == sequential.log && parallel.steps == sequential.steps &&
+				parallel.prepared == sequential.prepared && parallel.ends == sequential.ends;
+			out << "threshold " << threshold << ", " << threads << " threads: logs " << ((same) ? "same as" : "DIFFERENT FROM") <<
+				" the sequential run" << endl;
+			passed = passed && same;
+		}
+	}
+	{
+		auto TOP = build_plant<TIME>(plant);
+		MCCS_Runner<TIME, Parallel_Logger<logger::not_logger>> r(TOP, TIME("00:00:00:000"));
+		auto steps = make_shared<Parallel_Steps<TIME>>(TOP, 4, 16);
+		r.execute(steps);
+		r.run_until(until);
+		steps->print(out);
+	}
+
+	/***** Time without logs, 128 lines (the speed-up depends on the cores of the machine) *****/
+	plant.lines = 128;
+	until = TIME("00:10:00:000");
+	Plant_Run base = run<logger::not_logger>(plant, until, 0, 0);
+	out << endl << "128 lines, 10 min, no logs, " << thread::hardware_concurrency() << " hardware threads: sequential " <<
+		base.seconds << " s (" << base.steps << " steps)" << endl;
+	for (unsigned threads : {1, 2, 4}){
+		Plant_Run parallel = run<Parallel_Logger<logger::not_logger>>(plant, until, threads, 64);
+		out << "threshold 64, " << threads << " threads: " << parallel.seconds << " s, speed-up " << base.seconds/parallel.seconds << endl;
+		passed = passed && parallel.prepared == base.prepared && parallel.ends == base.ends;
+	}
+
+	cout << "Parallel step test " << ((passed) ? "passed" : "FAILED") << endl;
+	return (passed) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+//Time class header
+#include <NDTime.hpp>
+
+//Plant builder, runner and wall-clock pacer
+#include "../engine/model_builder.hpp"
+#include "../engine/mccs_runner.hpp"
+#include "../engine/real_time.hpp"
+
+//C++ libraries
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Namespaces
+using namespace std;
+using namespace cadmium;
+using TIME = NDTime;
+
+
+/***** (1) *****/
+//Records the matPreparedOut/endOut messages of the plant with their simulated time
+class Output_Log : public Run_Observer<TIME>{
+public:
+	vector<pair<long long, int>> messages;			//ms, 0 for matPreparedOut and 1 for endOut
+	void outputs(const TIME& t, const dynamic::message_bags& top_outbox) override{
+		record<Plant_defs::out_mat_prepared>(t, top_outbox, 0);
+		record<Plant_defs::out_end>(t, top_outbox, 1);
+	}
+
+private:
+	template<typename PORT>
+	void record(const TIME& t, const dynamic::message_bags& top_outbox, int port){
+		auto bag = top_outbox.find(type_index(typeid(PORT)));
+		if (bag == top_outbox.end()) return;
+		for (size_t i = 0; i < boost::any_cast<const message_bag<PORT>&>(bag->second).messages.size(); i++){
+			messages.push_back({time_to_milliseconds(t), port});
+		}
+	}
+};
+
+//A controller that takes too long on every step
+class Slow_Observer : public Run_Observer<TIME>{
+public:
+	void step(const TIME& t) override{
+		this_thread::sleep_for(chrono::milliseconds(3));
+	}
+};
+
+//Runs one line of the example plant, paced when scale > 0; returns its outputs and the wall-clock time in s
+vector<pair<long long, int>> run(const Plant_description& plant, double scale, bool slow, Real_Time_Report& report, double& seconds){
+	MCCS_Runner<TIME, logger::not_logger> r(build_plant<TIME>(plant), TIME("00:00:00:000"));
+	auto log = make_shared<Output_Log>();
+	r.attach(log);
+	if (slow) r.attach(make_shared<Slow_Observer>());
+	Real_Time_Options options;
+	options.scale = scale;
+	options.core = 0;
+	auto begin = chrono::steady_clock::now();
+	if (scale > 0) r.pace(make_shared<Real_Time_Pacer<TIME>>(options, &report));
+	r.run_until(TIME("01:00:00:000"));
+	seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+	return log->messages;
+}
+
+
+/***** (2) *****/
+/***** Create the main function *****/
+int main (){
+	ofstream out("../simulation_results/RealTime_test_output.txt");
+	bool passed = true;
+
+	Plant_description plant;
+	passed = passed && plant.read("../input_data/MCCS_plant_example.xml");
+	plant.lines = 1;
+
+	/***** As fast as possible: the reference outputs *****/
+	Real_Time_Report none;
+	double seconds;
+	vector<pair<long long, int>> reference = run(plant, 0, false, none, seconds);
+	double span = (reference.empty()) ? 0 : reference.back().first/1000.0;
+	out << "unpaced: " << reference.size() << " outputs over " << span << " simulated s in " << seconds*1000 << " ms" << endl;
+	passed = passed && !reference.empty() && none.steps == 0;
+
+	/***** Scaled real time: same outputs, and the wall clock follows the simulated one *****/
+	for (double scale : {1000.0, 100.0}){
+		Real_Time_Report report;
+		vector<pair<long long, int>> paced = run(plant, scale, false, report, seconds);
+		Real_Time_Options options;
+		options.scale = scale;
+		options.core = 0;
+		report.print(out, options);
+		bool same = (paced == reference);
+		bool in_time = seconds >= span/scale && report.wall_seconds <= span/scale + 0.5;
+		out << "x" << scale << ": " << ((same) ? "same outputs" : "OUTPUTS DIFFER") << ", " << seconds << " s for " <<
+			span/scale << " s of scaled time" << endl;
+		passed = passed && same && in_time && report.steps > 0 && report.jitter_ns.count() == (uint64_t)report.steps;
+	}
+
+	/***** A step slower than the gap to the next one misses its deadline, and the run catches up *****/
+	Real_Time_Report late;
+	vector<pair<long long, int>> slow = run(plant, 1000.0, true, late, seconds);
+	Real_Time_Options options;
+	options.scale = 1000.0;
+	options.core = 0;
+	late.print(out, options);
+	out << "slow controller: " << ((slow == reference) ? "same outputs" : "OUTPUTS DIFFER") << endl;
+	passed = passed && slow == reference && late.misses > 0;
+
+	cout << "Real time test " << ((passed) ? "passed" : "FAILED") << endl;
+	return (passed) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+//Time class header
+#include <NDTime.hpp>
+
+//Replication controller
+#include "../engine/replications.hpp"
+
+//C++ libraries
+#include <math.h>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+//Namespaces
+using namespace std;
+using TIME = NDTime;
+
+
+/***** (1) *****/
+//One line of the example plant, with the given moving time in every stage
+Plant_description scenario(const Plant_description& example, const string& moving_time){
+	Plant_description plant = example;
+	plant.lines = 1;
+	sweep_apply(plant, "moving_time", moving_time);
+	return plant;
+}
+
+
+/***** (2) *****/
+/***** Create the main function *****/
+int main (){
+	ofstream out("../simulation_results/Replications_test_output.txt");
+	bool passed = true;
+
+	/***** Student's t quantiles against the tables *****/
+	double tables[][3] = {{1, 0.975, 12.706}, {2, 0.975, 4.303}, {4, 0.975, 2.776}, {10, 0.975, 2.228}, {30, 0.975, 2.042},
+		{9, 0.95, 1.833}, {19, 0.995, 2.861}};
+	for (auto& row : tables){
+		double t = student_t_quantile(row[1], (long long)row[0]);
+		bool ok = fabs(t - row[2]) < 0.01;
+		out << "t(" << row[1] << ", " << row[0] << ") = " << t << ((ok) ? "" : " WRONG") << endl;
+		passed = passed && ok;
+	}
+
+	Plant_description example;
+	passed = passed && example.read("../input_data/MCCS_plant_example.xml");
+
+	/***** Deterministic timings: no variance, the minimum number of replications is enough *****/
+	Replication_Plan plan;
+	plan.until = "01:00:00:000";
+	plan.batch = 4;
+	Plant_description deterministic = scenario(example, "constant 5");
+	sweep_apply(deterministic, "loading_time", "constant 2");
+	Replication_Report report = run_replications<TIME>({deterministic}, {"deterministic"}, plan);
+	report.print(out, plan);
+	passed = passed && report.converged && report.replications == plan.min_replications &&
+		report.scenarios[0].metric.variance() == 0;
+
+	/***** No endOut within the horizon: there is no makespan to estimate *****/
+	Replication_Plan short_plan = plan;
+	short_plan.until = "00:00:01:000";
+	short_plan.set_metric("makespan");
+	Replication_Report none = run_replications<TIME>({deterministic}, {"deterministic"}, short_plan);
+	out << "makespan within " << short_plan.until << ": " << none.error << " (" << none.missing << " left out)" << endl;
+	passed = passed && !none.error.empty() && none.missing == none.replications && none.scenarios[0].metric.n == 0;
+
+	/***** Stochastic timings: replications are added until the interval is narrow enough *****/
+	plan.relative_half_width = 0.02;
+	Plant_description stochastic = scenario(example, "uniform 3 7");
+	report = run_replications<TIME>({stochastic}, {"uniform 3 7"}, plan);
+	report.print(out, plan);
+	passed = passed && report.converged && report.replications > plan.min_replications &&
+		report.scenarios[0].metric.half_width(plan.confidence) <= report.target;
+
+	/***** The result does not depend on the number of threads (same batches, one at a time) *****/
+	Replication_Report again = run_replications<TIME>({stochastic}, {"uniform 3 7"}, plan);
+	passed = passed && again.replications == report.replications && again.scenarios[0].values == report.scenarios[0].values;
+
+	/***** Comparing two scenarios: common random numbers need fewer replications *****/
+	vector<Plant_description> compared = {scenario(example, "uniform 3 7"), scenario(example, "uniform 3.2 7.2")};
+	vector<string> names = {"uniform 3 7", "uniform 3.2 7.2"};
+	plan.half_width = 0.1;				//seconds of cycle time between the two
+	plan.max_replications = 200;
+	Replication_Report crn = run_replications<TIME>(compared, names, plan);
+	crn.print(out, plan);
+	plan.common_random_numbers = false;
+	Replication_Report independent = run_replications<TIME>(compared, names, plan);
+	independent.print(out, plan);
+	out << "common random numbers: " << crn.replications << " replications, independent: " << independent.replications << endl;
+	passed = passed && crn.converged && crn.replications < independent.replications &&
+		crn.scenarios[1].difference.mean > 0;
+
+	cout << "Replications test " << ((passed) ? "passed" : "FAILED") << endl;
+	return (passed) ? 0 : 1;
+}
\ No newline at end of file
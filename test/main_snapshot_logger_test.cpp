@@ -0,0 +1,173 @@
+//Cadmium Simulator headers
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+//Time class header
+#include <NDTime.hpp>
+
+//Snapshot logger, plant builder, runner and the time lines of the logs
+#include "../engine/snapshot_logger.hpp"
+#include "../engine/model_builder.hpp"
+#include "../engine/mccs_runner.hpp"
+#include "../engine/chunked_log.hpp"
+
+//C++ libraries
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+//Namespaces
+using namespace std;
+using namespace cadmium;
+using TIME = NDTime;
+
+
+/***** (1) *****/
+//State log of the whole run, as the reference
+static ofstream state_log;
+struct state_sink{
+	static ostream& sink(){
+		return state_log;
+	}
+};
+using logger_state = logger::multilogger<logger::logger<logger::logger_state, dynamic::logger::formatter<TIME>, state_sink>,
+	logger::logger<logger::logger_global_time, dynamic::logger::formatter<TIME>, state_sink>>;
+
+//time (ms) -> model -> state text
+using Snapshot_States = map<long long, map<string, string>>;
+
+bool is_cell_model(const string& model){
+	return model.compare(0, 7, "control") == 0 || model.compare(0, 7, "storage") == 0 || model.compare(0, 8, "handling") == 0;
+}
+
+//The states of the cell models at every period before until, as the state log has them: the last state written
+//at a time <= T is the state at T
+Snapshot_States states_from_log(const string& path, long long period_ms, long long until_ms){
+	Snapshot_States states;
+	map<string, string> current;
+	string line, model;
+	long long next = 0;
+	ifstream in(path);
+	while (getline(in, line)){
+		long long t = log_time_line_ms(line.data(), line.size());
+		if (t >= 0){
+			for (; next < t; next += period_ms) states[next] = current;
+			model.clear();
+		} else if (line.compare(0, 16, "State for model ") == 0){
+			model = line.substr(16, line.find(" is ", 16) - 16);
+			if (is_cell_model(model)) current[model] = line.substr(line.find(" is ") + 4);
+			else model.clear();
+		} else if (!model.empty()){
+			current[model] += "\n" + line;
+		}
+	}
+	for (; next < until_ms; next += period_ms) states[next] = current;
+	return states;
+}
+
+//The snapshots of a snapshot log
+Snapshot_States read_snapshots(const string& path, long long& lines){
+	Snapshot_States states;
+	string line, model;
+	long long t = -1;
+	lines = 0;
+	ifstream in(path);
+	while (getline(in, line)){
+		lines++;
+		long long time = log_time_line_ms(line.data(), line.size());
+		if (time >= 0){
+			t = time;
+			states[t];
+			model.clear();
+		} else if (line.compare(0, 16, "State for model ") == 0){
+			model = line.substr(16, line.find(" is ", 16) - 16);
+			states[t][model] = line.substr(line.find(" is ") + 4);
+		} else if (!model.empty()){
+			states[t][model] += "\n" + line;
+		}
+	}
+	return states;
+}
+
+struct Snapshot_Run{
+	long long steps = 0;
+	long long snapshots = 0;
+	long long lines = 0;				//of the snapshot log
+	long long bytes = 0;
+	Snapshot_States states;
+};
+
+//A plant run for until with snapshots every period, logging every state too if LOGGER is logger_state
+template<typename LOGGER>
+Snapshot_Run run(const Plant_description& plant, const TIME& period, const TIME& until, const string& path){
+	Snapshot_Run s;
+	{
+		ofstream out(path, ios::binary);
+		auto TOP = build_plant<TIME>(plant);
+		MCCS_Runner<TIME, LOGGER> r(TOP, TIME("00:00:00:000"));
+		auto snapshots = make_shared<MCCS_Snapshots<TIME>>(out, period);
+		snapshots->watch_cells(TOP);
+		r.attach(snapshots);
+		r.run_until(until);
+		snapshots->finish(until);
+		s.steps = r.steps();
+		s.snapshots = snapshots->snapshots();
+	}
+	s.states = read_snapshots(path, s.lines);
+	ifstream in(path, ios::binary | ios::ate);
+	s.bytes = in.tellg();
+	return s;
+}
+
+long long file_size(const string& path){
+	ifstream in(path, ios::binary | ios::ate);
+	return in.tellg();
+}
+
+
+/***** (2) *****/
+/***** Create the main function *****/
+int main (){
+	ofstream out("../simulation_results/SnapshotLogger_test_output.txt");
+	bool passed = true;
+	string state_path = "../simulation_results/SnapshotLogger_test_state.txt";
+	string snapshots_path = "../simulation_results/SnapshotLogger_test_snapshots.txt";
+	TIME period("00:10:00:000");
+	long long period_ms = 600000;
+
+	/***** Two lines of the example plant for 4 hours: the snapshots are the states of the state log every 10 minutes *****/
+	Plant_description plant;
+	bool read = plant.read("../input_data/MCCS_plant_example.xml");
+	plant.lines = 2;
+	plant.generated = true;
+	plant.generator.mean_interarrival = 20;
+	state_log.open(state_path, ios::binary);
+	Snapshot_Run busy = run<logger_state>(plant, period, TIME("04:00:00:000"), snapshots_path);
+	state_log.close();
+	Snapshot_States expected = states_from_log(state_path, period_ms, 4*3600000LL);
+	bool same = read && busy.snapshots == 24 && busy.states == expected && busy.states.begin()->second.size() == 12;
+	out << "4 h, one event every 20 s on average: " << busy.steps << " steps, state log " << file_size(state_path) << " bytes, " <<
+		busy.snapshots << " snapshots of " << busy.states.begin()->second.size() << " models in " << busy.bytes << " bytes" << endl;
+	out << "snapshots " << ((same) ? "same as" : "DIFFERENT FROM") << " the states of the state log every 10 minutes" << endl;
+	passed = passed && same;
+
+	/***** The size of the snapshot log depends on the horizon, not on the events *****/
+	plant.generator.mean_interarrival = 120;
+	Snapshot_Run quiet = run<logger::not_logger>(plant, period, TIME("04:00:00:000"), snapshots_path);
+	Snapshot_Run longer = run<logger::not_logger>(plant, period, TIME("08:00:00:000"), snapshots_path);
+	out << "4 h, one event every 120 s on average: " << quiet.steps << " steps, " << quiet.snapshots << " snapshots, " <<
+		quiet.lines << " lines (" << busy.lines << " with 20 s)" << endl;
+	out << "8 h, one event every 120 s on average: " << longer.steps << " steps, " << longer.snapshots << " snapshots, " <<
+		longer.lines << " lines" << endl;
+	passed = passed && quiet.steps*3 < busy.steps && quiet.lines == busy.lines && longer.snapshots == 48 && longer.lines == 2*quiet.lines;
+
+	remove(state_path.c_str());
+	remove(snapshots_path.c_str());
+	cout << "Snapshot logger test " << ((passed) ? "passed" : "FAILED") << endl;
+	return (passed) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+//Cadmium Simulator headers
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+//Time class header
+#include <NDTime.hpp>
+
+//Steady-state detection, plant builder, runner and statistics
+#include "../engine/steady_state.hpp"
+#include "../engine/model_builder.hpp"
+#include "../engine/mccs_runner.hpp"
+#include "../engine/statistics.hpp"
+#include "../data_structures/rng.hpp"
+
+//C++ libraries
+#include <math.h>
+#include <iostream>
+#include <fstream>
+#include <string>
+
+//Namespaces
+using namespace std;
+using namespace cadmium;
+using TIME = NDTime;
+
+
+/***** (1) *****/
+/***** Create the main function *****/
+int main (){
+	ofstream out("../simulation_results/SteadyState_test_output.txt");
+	bool passed = true;
+
+	/***** A series of mean 100 with a decaying start-up transient: MSER-5 cuts the transient *****/
+	Steady_State_Estimator transient;
+	SplitMix64 rng(11);
+	long long converged_at = -1;
+	double mean_at_stop = 0;
+	for (int k = 0; k < 2000; k++){
+		transient.add(100 + 60*exp(-k/40.0) + 20*(rng.uniform() - 0.5));
+		if (converged_at < 0 && transient.converged()){
+			converged_at = k + 1;
+			mean_at_stop = transient.mean();
+		}
+	}
+	double all_mean = 0;
+	for (int k = 0; k < 2000; k++) all_mean += 100 + 60*exp(-k/40.0);
+	all_mean /= 2000;
+	out << "transient series: warm-up cut " << transient.warmup() << " values, mean " << transient.mean() << " +/- " <<
+		transient.half_width() << " (without the cut " << all_mean << "), precise enough after " << converged_at << " values (mean " << mean_at_stop << ")" << endl;
+	passed = passed && transient.warmup_detected() && transient.warmup() >= 60 && transient.warmup() <= 300 &&
+		fabs(transient.mean() - 100) < 1 && converged_at > 0 && converged_at < 2000 && fabs(mean_at_stop - 100) < 5;
+
+	/***** A constant series: no cut, exact mean, precise once there are enough values *****/
+	Steady_State_Estimator constant;
+	for (int k = 0; k < 99; k++) constant.add(42);
+	bool early = constant.converged();
+	constant.add(42);
+	out << "constant series: warm-up cut " << constant.warmup() << " values, mean " << constant.mean() << " +/- " <<
+		constant.half_width() << ", precise after 99 values: " << early << ", after 100: " << constant.converged() << endl;
+	passed = passed && constant.warmup() == 0 && constant.mean() == 42 && constant.half_width() == 0 && !early && constant.converged();
+
+	/***** A still rising series is not settled *****/
+	Steady_State_Estimator rising;
+	for (int k = 0; k < 500; k++) rising.add(k);
+	out << "rising series: settled " << rising.warmup_detected() << ", converged " << rising.converged() << endl;
+	passed = passed && !rising.warmup_detected() && !rising.converged();
+
+	/***** One line of the example plant fed by a generator: the run stops at the steady-state throughput *****/
+	Plant_description plant;
+	bool read = plant.read("../input_data/MCCS_plant_example.xml");
+	plant.lines = 1;
+	plant.generated = true;
+	plant.generator.mean_interarrival = 30;
+	TIME horizon("100:00:00:000");
+	double long_run;
+	{
+		MCCS_Runner<TIME, logger::not_logger> r(build_plant<TIME>(plant), TIME("00:00:00:000"));
+		auto statistics = make_shared<MCCS_Statistics<TIME>>();
+		statistics->count_port<Plant_defs::out_mat_prepared>("matPreparedOut");
+		r.attach(statistics);
+		r.run_until(horizon);
+		long_run = statistics->messages("matPreparedOut")/100.0;
+	}
+	Steady_State_Plan plan;
+	plan.relative_half_width = 0.05;
+	auto steady = make_shared<Steady_State_Stop<TIME, Plant_defs::out_mat_prepared>>(TIME("00:05:00:000"), plan);
+	MCCS_Runner<TIME, logger::not_logger> r(build_plant<TIME>(plant), TIME("00:00:00:000"));
+	r.run_until(horizon, steady);
+	const Steady_State_Estimator& e = steady->estimate();
+	out << endl << "plant, materials prepared per hour over 100 h: " << long_run << endl;
+	out << "stopped at " << r.last() << " (horizon " << horizon << ")" << endl;
+	steady->print(out);
+	passed = passed && read && r.stopped() && e.converged() && fabs(e.mean() - long_run) < 0.1*long_run;
+
+	/***** The same run split into run_until calls of 17 minutes (e.g. between checkpoints) stops at the same point *****/
+	auto split = make_shared<Steady_State_Stop<TIME, Plant_defs::out_mat_prepared>>(TIME("00:05:00:000"), plan);
+	MCCS_Runner<TIME, logger::not_logger> segments(build_plant<TIME>(plant), TIME("00:00:00:000"));
+	int calls = 0;
+	for (TIME until = TIME("00:17:00:000"); !segments.stopped() && until < horizon; until = until + TIME("00:17:00:000")){
+		segments.run_until(until, split);
+		calls++;
+	}
+	const Steady_State_Estimator& s = split->estimate();
+	bool same = segments.stopped() && segments.last() == r.last() && s.observations() == e.observations() &&
+		s.mean() == e.mean() && s.warmup() == e.warmup() && split->warmup_end() == steady->warmup_end();
+	out << calls << " run_until calls: stopped at " << segments.last() << ", " << s.observations() << " intervals, warm-up until " <<
+		split->warmup_end() << ((same) ? ", same as one call" : ", DIFFERENT from one call") << endl;
+	passed = passed && same;
+
+	cout << "Steady state test " << ((passed) ? "passed" : "FAILED") << endl;
+	return (passed) ? 0 : 1;
+}
\ No newline at end of file
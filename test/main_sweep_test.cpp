@@ -0,0 +1,95 @@
+//Time class header
+#include <NDTime.hpp>
+
+//Parameter sweep
+#include "../engine/sweep.hpp"
+
+//C++ libraries
+#include <dirent.h>
+#include <stdio.h>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+//Namespaces
+using namespace std;
+using TIME = NDTime;
+
+
+/***** (1) *****/
+//Removes the files of a cache directory, so that the test starts from an empty cache
+void clear_cache(const string& dir){
+	DIR* d = opendir(dir.c_str());
+	if (!d) return;
+	while (dirent* e = readdir(d)){
+		string name = e->d_name;
+		if (name != "." && name != "..") remove((dir + "/" + name).c_str());
+	}
+	closedir(d);
+}
+
+bool same_metrics(const Sweep_Result& a, const Sweep_Result& b){
+	return a.ok && b.ok && a.values == b.values && a.prepared == b.prepared && a.ends == b.ends && a.makespan == b.makespan &&
+		a.throughput == b.throughput && a.storage_utilisation == b.storage_utilisation &&
+		a.handling_utilisation == b.handling_utilisation && a.wip == b.wip && a.cycle_time == b.cycle_time;
+}
+
+size_t count_cached(const vector<Sweep_Result>& results){
+	size_t n = 0;
+	for (auto& r : results) n += (r.cached) ? 1 : 0;
+	return n;
+}
+
+
+/***** (2) *****/
+/***** Create the main function *****/
+int main (){
+	ofstream out("../simulation_results/Sweep_test_output.txt");
+	string cache_dir = "../simulation_results/sweep_test_cache";
+	clear_cache(cache_dir);
+	Sweep_Cache cache(cache_dir);
+
+	Sweep_Grid grid;
+	grid.plant_path = "../input_data/MCCS_plant_example.xml";
+	grid.axes = {{"moving_time", {"constant 4", "constant 5"}}, {"loading_time", {"constant 2", "uniform 1.5 2.5"}}, {"lines", {"1", "2"}}};
+
+	/***** First sweep: everything simulated *****/
+	vector<Sweep_Result> first = run_sweep<TIME>(grid, cache, 4);
+	bool passed = first.size() == 8 && count_cached(first) == 0;
+	for (auto& r : first){
+		passed = passed && r.ok && r.prepared == 6*stoll(r.values[2]);		//input file: batches of 2, 1 and 3 per line
+	}
+	print_sweep_csv(out, grid, first);
+	out << "first sweep: " << first.size() - count_cached(first) << " simulated" << endl;
+
+	/***** Same grid: everything from the cache, with the same figures *****/
+	vector<Sweep_Result> second = run_sweep<TIME>(grid, cache, 4);
+	bool same = second.size() == first.size() && count_cached(second) == second.size();
+	for (size_t i = 0; same && i < second.size(); i++) same = same_metrics(first[i], second[i]);
+	out << "same grid: " << count_cached(second) << " from the cache, " << ((same) ? "identical" : "DIFFERENT") << endl;
+	passed = passed && same;
+
+	/***** One more value: only the new points are simulated *****/
+	grid.axes[0].second.push_back("constant 6");
+	vector<Sweep_Result> third = run_sweep<TIME>(grid, cache, 4);
+	bool incremental = third.size() == 12 && count_cached(third) == 8;
+	out << "grid with one more moving time: " << third.size() - count_cached(third) << " simulated" << endl;
+	passed = passed && incremental;
+
+	/***** One thread without cache: the same figures *****/
+	vector<Sweep_Result> sequential = run_sweep<TIME>(grid, Sweep_Cache(""), 1);
+	same = sequential.size() == third.size() && count_cached(sequential) == 0;
+	for (size_t i = 0; same && i < sequential.size(); i++) same = same_metrics(sequential[i], third[i]);
+	out << "sequential sweep without cache: " << ((same) ? "identical" : "DIFFERENT") << endl;
+	passed = passed && same;
+
+	/***** Invalid values are reported, not simulated *****/
+	grid.axes = {{"batch_min", {"2"}}};			//the example plant reads its input from a file
+	vector<Sweep_Result> invalid = run_sweep<TIME>(grid, cache, 2);
+	passed = passed && invalid.size() == 1 && !invalid[0].ok && !invalid[0].error.empty();
+	out << "invalid point: " << invalid[0].error << endl;
+
+	cout << "Sweep test " << ((passed) ? "passed" : "FAILED") << endl;
+	return (passed) ? 0 : 1;
+}
\ No newline at end of file
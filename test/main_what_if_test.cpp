@@ -0,0 +1,199 @@
+//Cadmium Simulator headers
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+//Time class header
+#include <NDTime.hpp>
+
+//Messages structures
+#include "../data_structures/message.hpp"
+
+//Atomic model headers
+#include "../atomics/control.hpp"
+#include "../atomics/storage.hpp"
+#include "../atomics/handling.hpp"
+#include "../atomics/generator.hpp"
+
+//Runner, snapshots and branches
+#include "../engine/mccs_runner.hpp"
+#include "../engine/statistics.hpp"
+#include "../engine/what_if.hpp"
+
+//C++ libraries
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//Namespaces
+using namespace std;
+using namespace cadmium;
+using TIME = NDTime;
+using LOGGER = logger::not_logger;
+
+
+/***** (1) *****/
+//ports for the TOP model
+struct top_out_end: public out_port<int>{};
+struct top_out_mat_prepared: public out_port<int>{};
+//ports for the Inventory handler
+struct ih_in_load: public in_port<Message_t>{};
+struct ih_in_prep: public in_port<Message_t>{};
+struct ih_out_loaded: public out_port<Message_t>{};
+struct ih_out_unloaded: public out_port<Message_t>{};
+//ports for the MCCS
+struct mccs_in_start: public in_port<int>{};
+struct mccs_out_mat_prepared: public out_port<int>{};
+struct mccs_out_end: public out_port<int>{};
+
+
+/***** (2) *****/
+/***** Same MCCS as top_model/main.cpp, fed by a generator *****/
+shared_ptr<dynamic::modeling::coupled<TIME>> build_mccs(const MCCS_config& config){
+	Generator_config generator_config;
+	generator_config.arrival = 1;
+	generator_config.mean_interarrival = 20.0;
+	generator_config.batch_min = 1;
+	generator_config.batch_max = 5;
+	generator_config.seed = 42;
+	shared_ptr<dynamic::modeling::model> generator = dynamic::translate::make_dynamic_atomic_model
+					<Generator, TIME, Generator_config>("generator_main_start", move(generator_config));
+	shared_ptr<dynamic::modeling::model> handling1 = dynamic::translate::make_dynamic_atomic_model
+					<Handling, TIME, Timing>("handling1", config.handling_timing("handling1"));
+	shared_ptr<dynamic::modeling::model> storage1 = dynamic::translate::make_dynamic_atomic_model
+					<Storage, TIME, Timing>("storage1", config.storage_timing("storage1"));
+	shared_ptr<dynamic::modeling::model> control1 = dynamic::translate::make_dynamic_atomic_model<Control, TIME>("control1");
+
+	shared_ptr<dynamic::modeling::coupled<TIME>> IH = make_shared<dynamic::modeling::coupled<TIME>>("IH",
+		dynamic::modeling::Models{storage1, handling1},
+		dynamic::modeling::Ports{typeid(ih_in_load), typeid(ih_in_prep)},
+		dynamic::modeling::Ports{typeid(ih_out_loaded), typeid(ih_out_unloaded)},
+		dynamic::modeling::EICs{dynamic::translate::make_EIC<ih_in_load, Storage_defs::loadIn>("storage1"),
+			dynamic::translate::make_EIC<ih_in_prep, Handling_defs::prepIn>("handling1")},
+		dynamic::modeling::EOCs{dynamic::translate::make_EOC<Storage_defs::loadedOut, ih_out_loaded>("storage1"),
+			dynamic::translate::make_EOC<Storage_defs::unloadedOut, ih_out_unloaded>("storage1")},
+		dynamic::modeling::ICs{dynamic::translate::make_IC<Handling_defs::unloadOut, Storage_defs::unloadIn>("handling1","storage1")});
+
+	shared_ptr<dynamic::modeling::coupled<TIME>> MCCS = make_shared<dynamic::modeling::coupled<TIME>>("MCCS",
+		dynamic::modeling::Models{control1, IH},
+		dynamic::modeling::Ports{typeid(mccs_in_start)},
+		dynamic::modeling::Ports{typeid(mccs_out_mat_prepared), typeid(mccs_out_end)},
+		dynamic::modeling::EICs{dynamic::translate::make_EIC<mccs_in_start, Control_defs::startIn>("control1")},
+		dynamic::modeling::EOCs{dynamic::translate::make_EOC<Control_defs::matPreparedOut, mccs_out_mat_prepared>("control1"),
+			dynamic::translate::make_EOC<Control_defs::endOut, mccs_out_end>("control1")},
+		dynamic::modeling::ICs{dynamic::translate::make_IC<Control_defs::loadOut, ih_in_load>("control1", "IH"),
+			dynamic::translate::make_IC<Control_defs::prepOut, ih_in_prep>("control1", "IH"),
+			dynamic::translate::make_IC<ih_out_loaded, Control_defs::loadedIn>("IH", "control1"),
+			dynamic::translate::make_IC<ih_out_unloaded, Control_defs::unloadedIn>("IH", "control1")});
+
+	return make_shared<dynamic::modeling::coupled<TIME>>("TOP",
+		dynamic::modeling::Models{MCCS, generator},
+		dynamic::modeling::Ports{},
+		dynamic::modeling::Ports{typeid(top_out_mat_prepared), typeid(top_out_end)},
+		dynamic::modeling::EICs{},
+		dynamic::modeling::EOCs{dynamic::translate::make_EOC<mccs_out_mat_prepared, top_out_mat_prepared>("MCCS"),
+			dynamic::translate::make_EOC<mccs_out_end, top_out_end>("MCCS")},
+		dynamic::modeling::ICs{dynamic::translate::make_IC<Generator_defs::startOut, mccs_in_start>("generator_main_start", "MCCS")});
+}
+
+//model of a tree with the given id
+shared_ptr<dynamic::modeling::model> find_model(shared_ptr<dynamic::modeling::model> model, const string& id){
+	if (model->get_id() == id) return model;
+	auto coupled = dynamic_pointer_cast<dynamic::modeling::coupled<TIME>>(model);
+	if (!coupled) return nullptr;
+	for (auto& m : coupled->_models){
+		auto found = find_model(m, id);
+		if (found) return found;
+	}
+	return nullptr;
+}
+
+//Records the outputs of the TOP model, to compare two runs
+class Output_Log : public Run_Observer<TIME>{
+public:
+	vector<string> lines;
+	void outputs(const TIME& t, const dynamic::message_bags& top_outbox) override{
+		auto bag = top_outbox.find(type_index(typeid(top_out_mat_prepared)));
+		if (bag == top_outbox.end()) return;
+		for (int n : boost::any_cast<const message_bag<top_out_mat_prepared>&>(bag->second).messages){
+			ostringstream os;
+			os << t << " " << n;
+			lines.push_back(os.str());
+		}
+	}
+};
+
+//Statistics of the cell, attached to a runner
+shared_ptr<MCCS_Statistics<TIME>> attach_statistics(shared_ptr<dynamic::modeling::coupled<TIME>> top, MCCS_Runner<TIME, LOGGER>& r){
+	auto statistics = make_shared<MCCS_Statistics<TIME>>();
+	statistics->watch_control(find_model(top, "control1"));
+	statistics->watch_handling(find_model(top, "handling1"));
+	statistics->count_port<top_out_mat_prepared>("matPreparedOut");
+	r.attach(statistics);
+	return statistics;
+}
+
+
+/***** (3) *****/
+/***** Create the main function *****/
+int main (){
+	TIME fork_time = TIME("01:00:00:000");
+	TIME until = TIME("03:00:00:000");
+	ofstream out("../simulation_results/WhatIf_test_output.txt");
+
+	/***** Shared prefix, simulated once *****/
+	MCCS_config base;
+	auto top = build_mccs(base);
+	MCCS_Runner<TIME, LOGGER> r(top, TIME("00:00:00:000"));
+	r.run_until(fork_time);
+	auto snapshot = Checkpointer<TIME>(top).snapshot(r.last());
+
+	//reference: the base run continued past the fork
+	auto reference = make_shared<Output_Log>();
+	r.attach(reference);
+	r.run_until(until);
+
+	/***** Branches *****/
+	MCCS_config moving_4s, moving_6s, random_times;
+	moving_4s.moving = Timing(4.0);
+	moving_6s.moving = Timing(6.0);
+	bool random_config = random_times.read("../input_data/MCCS_config_test.txt");
+	vector<MCCS_config> configs = {base, moving_4s, moving_6s, random_times};
+	vector<string> names = {"unchanged", "moving 4s", "moving 6s", "random times"};
+
+	vector<shared_ptr<Output_Log>> logs(configs.size());
+	vector<shared_ptr<MCCS_Statistics<TIME>>> statistics(configs.size());
+	vector<What_If_Branch<TIME, LOGGER>> branches(configs.size());
+	for (size_t i = 0; i < configs.size(); i++){
+		MCCS_config config = configs[i];
+		branches[i].name = names[i];
+		branches[i].build = [config](){ return build_mccs(config); };
+		branches[i].attach = [&logs, &statistics, i](shared_ptr<dynamic::modeling::coupled<TIME>> branch_top, MCCS_Runner<TIME, LOGGER>& branch_r){
+			logs[i] = make_shared<Output_Log>();
+			branch_r.attach(logs[i]);
+			statistics[i] = attach_statistics(branch_top, branch_r);
+		};
+	}
+	vector<What_If_Result> results = run_what_if<TIME, LOGGER>(snapshot, branches, until);
+
+	/***** Results *****/
+	bool passed = random_config;
+	for (size_t i = 0; i < results.size(); i++){
+		out << "branch " << results[i].name << ": " << ((results[i].ok) ? "ok" : "FAILED " + results[i].error) << endl;
+		passed = passed && results[i].ok;
+		if (!results[i].ok) continue;
+		statistics[i]->print_summary(out, time_to_seconds(until));
+		out << endl;
+	}
+	bool same = results[0].ok && logs[0]->lines == reference->lines;
+	out << "unchanged branch " << ((same) ? "identical to" : "DIFFERENT from") << " the continued base run (" <<
+		reference->lines.size() << " materials prepared after the fork)" << endl;
+	passed = passed && same;
+
+	cout << "What-if test " << ((passed) ? "passed" : "FAILED") << endl;
+	return (passed) ? 0 : 1;
+}
\ No newline at end of file
@@ -3,7 +3,6 @@
 #include <cadmium/modeling/dynamic_model.hpp>
 #include <cadmium/modeling/dynamic_coupled.hpp>
 #include <cadmium/modeling/dynamic_model_translator.hpp>
-#include <cadmium/engine/pdevs_dynamic_runner.hpp>
 #include <cadmium/logger/common_loggers.hpp>
 
 //Time class header
@@ -11,16 +10,37 @@
 
 //Messages structures
 #include "../data_structures/message.hpp"
+#include "../data_structures/order.hpp"
 
 //Atomic model headers
 #include "../atomics/control.hpp"
 #include "../atomics/storage.hpp"
 #include "../atomics/handling.hpp"
+#include "../atomics/generator.hpp"					//Atomic model for generated inputs
 #include <cadmium/basic_model/pdevs/iestream.hpp> 	//Atomic model for inputs
 
+//Runner and online statistics
+#include "../engine/mccs_runner.hpp"
+#include "../engine/statistics.hpp"
+#include "../engine/cycle_times.hpp"
+#include "../engine/profiler.hpp"					//no-op unless built with -DMCCS_PROFILING
+#include "../engine/checkpoint.hpp"
+#include "../engine/stop_conditions.hpp"
+#include "../engine/real_time.hpp"
+#include "../engine/chunked_log.hpp"
+#include "../engine/analytic.hpp"
+#include "../engine/log_profiles.hpp"
+#include "../engine/snapshot_logger.hpp"
+#include "../engine/steady_state.hpp"
+
 //C++ libraries
+#include <chrono>
 #include <iostream>
+#include <fstream>
 #include <string>
+#include <vector>
+#include <limits>
+#include <map>
 
 //Namespaces
 using namespace std;
@@ -40,6 +60,7 @@ struct ih_out_loaded: public out_port<Message_t>{};
 struct ih_out_unloaded: public out_port<Message_t>{};
 //ports for the MCCS
 struct mccs_in_start: public in_port<int>{};
+struct mccs_in_order: public in_port<Order_t>{};
 struct mccs_out_mat_prepared: public out_port<int>{};
 struct mccs_out_end: public out_port<int>{};
 
@@ -60,34 +81,176 @@ class InputReader_Int : public iestream_input<int,T> {
         InputReader_Int () = default;
         InputReader_Int (const char* file_path) : iestream_input<int,T>(file_path) {}
 };
+template<typename T>
+class InputReader_Order_t : public iestream_input<Order_t,T> {
+    public:
+        InputReader_Order_t () = default;
+        InputReader_Order_t (const char* file_path) : iestream_input<Order_t,T>(file_path) {}
+};
 
 /***** (3) *****/
 /***** Create the main function *****/
 int main (int argc, char **argv){
-	if (argc < 2) {
+	vector<string> args(argv, argv + argc);
+	//removes the option "name" (followed by n_values values) from args; false if it is not there
+	auto take_option = [&args](const string& name, size_t n_values, vector<string>& values){
+		for (size_t i = 1; i + n_values < args.size(); i++){
+			if (args[i] == name){
+				values.assign(args.begin() + i + 1, args.begin() + i + 1 + n_values);
+				args.erase(args.begin() + i, args.begin() + i + 1 + n_values);
+				return true;
+			}
+		}
+		return false;
+	};
+	vector<string> values;
+	
+	//optional "--config path": processing times of the cell (see data_structures/timing.hpp)
+	MCCS_config mccs_config;
+	if (take_option("--config", 1, values) && !mccs_config.read(values[0].c_str())){
+		cout << "Invalid configuration file " << values[0] << endl;
+		return 1;
+	}
+	//optional "--stats": utilisation, WIP, throughput and cycle times collected during the run
+	//(see engine/statistics.hpp and engine/cycle_times.hpp)
+	bool stats = take_option("--stats", 0, values);
+	//optional "--until hh:mm:ss:mmm": simulation horizon
+	NDTime horizon = NDTime("05:00:00:000");
+	if (take_option("--until", 1, values)) horizon = NDTime(values[0]);
+	//optional "--checkpoint path", "--checkpoint-every hh:mm:ss:mmm" and "--restore path" (see engine/checkpoint.hpp)
+	string checkpoint_path, restore_path;
+	NDTime checkpoint_period = numeric_limits<NDTime>::infinity();
+	if (take_option("--checkpoint", 1, values)) checkpoint_path = values[0];
+	if (take_option("--checkpoint-every", 1, values)) checkpoint_period = NDTime(values[0]);
+	if (take_option("--restore", 1, values)) restore_path = values[0];
+	//optional "--stop-after-end K", "--stop-after-prepared N" and "--stop-when-idle": the run ends before the horizon
+	//as soon as one of them holds (see engine/stop_conditions.hpp)
+	long long stop_after_end = -1, stop_after_prepared = -1;
+	if (take_option("--stop-after-end", 1, values)) stop_after_end = stoll(values[0]);
+	if (take_option("--stop-after-prepared", 1, values)) stop_after_prepared = stoll(values[0]);
+	bool stop_when_idle = take_option("--stop-when-idle", 0, values);
+	//optional "--analytic" or "--analytic-check": with deterministic timings, the matPreparedOut and endOut times are
+	//computed in closed form instead of running the models, and compared with the models' (see engine/analytic.hpp)
+	int analytic = -1;
+	if (take_option("--analytic", 0, values)) analytic = ANALYTIC_AUTO;
+	if (take_option("--analytic-check", 0, values)) analytic = ANALYTIC_CHECK;
+	//optional "--real-time X [--core N]": the steps follow the wall clock, X simulated seconds per second, and the
+	//deadline misses and wake-up jitter are reported (see engine/real_time.hpp)
+	Real_Time_Options pacing;
+	bool real_time = take_option("--real-time", 1, values);
+	if (real_time) pacing.scale = stod(values[0]);
+	if (take_option("--core", 1, values)) pacing.core = stoi(values[0]);
+	//optional "--compressed-logs": the logs are written as zlib-compressed chunks with a time index, to be read with
+	//MCCS_LOG (see engine/chunked_log.hpp)
+	bool compressed_logs = take_option("--compressed-logs", 0, values);
+	//optional "--log-profile full|messages|summary|none": which logs are written (see engine/log_profiles.hpp);
+	//summary writes no logs and prints the statistics of "--stats"
+	int log_profile = LOG_FULL;
+	if (take_option("--log-profile", 1, values) && !read_log_profile(values[0], log_profile)){
+		cout << "Invalid log profile " << values[0] << " (full, messages, summary or none)" << endl;
+		return 1;
+	}
+	stats = stats || log_profile == LOG_SUMMARY;
+	//optional "--snapshot-every hh:mm:ss:mmm": the full states of control, storage and handling every period of
+	//simulated time, whatever the log profile (see engine/snapshot_logger.hpp)
+	NDTime snapshot_period;
+	bool snapshots = take_option("--snapshot-every", 1, values);
+	if (snapshots) snapshot_period = NDTime(values[0]);
+	//optional "--steady-state X [--steady-interval hh:mm:ss:mmm]": the matPreparedOut messages per interval (5 minutes
+	//by default) are a series whose warm-up is cut automatically; the run stops once the half width of the steady-state
+	//mean is within X of it, e.g. 0.05 (see engine/steady_state.hpp)
+	Steady_State_Plan steady_plan;
+	NDTime steady_interval = NDTime("00:05:00:000");
+	bool steady_state = take_option("--steady-state", 1, values);
+	if (steady_state) steady_plan.relative_half_width = stod(values[0]);
+	if (take_option("--steady-interval", 1, values)) steady_interval = NDTime(values[0]);
+	//optional "--orders [--sequencing fifo|spt|edd]": the input file holds typed start orders "product quantity due"
+	//(see data_structures/order.hpp), prepared in the order chosen by the sequencing policy (see atomics/control.hpp)
+	bool orders = take_option("--orders", 0, values);
+	int sequencing = SEQUENCE_FIFO;
+	if (take_option("--sequencing", 1, values) && !read_sequencing_policy(values[0], sequencing)){
+		cout << "Invalid sequencing policy " << values[0] << " (fifo, spt or edd)" << endl;
+		return 1;
+	}
+	
+	bool generate = (args.size() >= 2 && args[1] == "--generate");
+	if (args.size() < 2 || (generate && args.size() < 7)) {
         cout << "Wrong parameters. The program must be invoked as: ";
-        cout << argv[0] << " path to the input file " << endl;
+        cout << argv[0] << " path to the input file [--config path to the configuration file] [--stats] [--until hh:mm:ss:mmm]" << endl;
+        cout << "                 [--checkpoint path [--checkpoint-every hh:mm:ss:mmm]] [--restore path]" << endl;
+        cout << "                 [--stop-after-end K] [--stop-after-prepared N] [--stop-when-idle] [--analytic | --analytic-check]" << endl;
+        cout << "                 [--real-time X [--core N]] [--compressed-logs] [--log-profile full|messages|summary|none]" << endl;
+        cout << "                 [--snapshot-every hh:mm:ss:mmm] [--steady-state X [--steady-interval hh:mm:ss:mmm]]" << endl;
+        cout << "                 [--orders [--sequencing fifo|spt|edd]]" << endl;
+        cout << "or, to generate the start requests on the fly: " << endl;
+        cout << argv[0] << " --generate deterministic|poisson|bursty mean_interarrival_seconds batch_min batch_max seed [max_batches]" << endl;
         return 1; 
     }
+	if (orders && (generate || analytic >= 0)){
+		cout << "--orders reads the orders from the input file, without --generate, --analytic or --analytic-check" << endl;
+		return 1;
+	}
 	
-	/****** Input Reader atomic model instantiation ******/
-	string input = argv[1];
+	/****** Analytic evaluation: outputs only, without logs ******/
+	if (analytic >= 0 && !generate){
+		Analytic_Report report;
+		vector<Batch_Output<TIME>> outputs = evaluate_mccs<TIME>(args[1].c_str(), mccs_config, horizon, analytic, &report);
+		ofstream out_analytic("../simulation_results/MCCS_analytic_outputs.txt");
+		for (auto& o : outputs){
+			out_analytic << o.time << " " << ((o.port == BATCH_END) ? "endOut" : "matPreparedOut") << " " << o.value << endl;
+		}
+		report.print(cout);
+		cout << outputs.size() << " outputs written to MCCS_analytic_outputs.txt" << endl;
+		return (report.checked && !report.matched) ? 1 : 0;
+	}
+
+	/****** Input Reader (or Generator) atomic model instantiation ******/
+	string input = args[1];
 	const char *i_input_data_main_start = input.c_str();
 	//create a shared pointer to hold the instantiation
-	shared_ptr<dynamic::modeling::model> input_reader_main_start = dynamic::translate::make_dynamic_atomic_model
-					<InputReader_Int, TIME, const char*>("input_reader_main_start", move(i_input_data_main_start));
+	shared_ptr<dynamic::modeling::model> input_reader_main_start;
+	if (orders){
+		input_reader_main_start = dynamic::translate::make_dynamic_atomic_model
+					<MCCS_PROFILED(InputReader_Order_t), TIME, const char*>("input_reader_main_start", move(i_input_data_main_start));
+	} else if (!generate){
+		input_reader_main_start = dynamic::translate::make_dynamic_atomic_model
+					<MCCS_PROFILED(InputReader_Int), TIME, const char*>("input_reader_main_start", move(i_input_data_main_start));
+	} else {
+		Generator_config config;
+		string arrival = args[2];
+		if (arrival == "deterministic"){
+			config.arrival = 0;
+		} else if (arrival == "poisson"){
+			config.arrival = 1;
+		} else if (arrival == "bursty"){
+			config.arrival = 2;
+		} else {
+			cout << "Unknown arrival process " << arrival << endl;
+			return 1;
+		}
+		config.mean_interarrival = stod(args[3]);
+		config.batch_min = stoi(args[4]);
+		config.batch_max = stoi(args[5]);
+		config.seed = stoull(args[6]);
+		config.max_batches = (args.size() > 7) ? stoll(args[7]) : 0;
+		input_reader_main_start = dynamic::translate::make_dynamic_atomic_model
+					<MCCS_PROFILED(Generator), TIME, Generator_config>("generator_main_start", move(config));
+	}
 					
 					
 	/***** (4) *****/
 	/***** Handling atomic model instantiation *****/
 	shared_ptr<dynamic::modeling::model> handling1;
-	handling1 = dynamic::translate::make_dynamic_atomic_model<Handling, TIME>("handling1");
+	handling1 = dynamic::translate::make_dynamic_atomic_model<MCCS_PROFILED(Handling), TIME, Timing, map<int, Timing>>("handling1",
+					mccs_config.handling_timing("handling1"), mccs_config.handling_product_timings("handling1"));
 	/***** Storage atomic model instantiation *****/
 	shared_ptr<dynamic::modeling::model> storage1;
-	storage1 = dynamic::translate::make_dynamic_atomic_model<Storage, TIME>("storage1");
+	storage1 = dynamic::translate::make_dynamic_atomic_model<MCCS_PROFILED(Storage), TIME, Timing, map<int, Timing>>("storage1",
+					mccs_config.storage_timing("storage1"), mccs_config.storage_product_timings("storage1"));
 	/***** Control atomic model instantiation *****/
 	shared_ptr<dynamic::modeling::model> control1;
-	control1 = dynamic::translate::make_dynamic_atomic_model<Control, TIME>("control1");
+	control1 = dynamic::translate::make_dynamic_atomic_model<MCCS_PROFILED(Control), TIME, int, vector<double>>("control1",
+					move(sequencing), mccs_config.unit_seconds_table());
 	
 	
 	/***** (5) *****/
@@ -115,12 +278,14 @@ int main (int argc, char **argv){
 	/*******MCCS COUPLED MODEL********/
 	//input ports
 	dynamic::modeling::Ports iports_MCCS = {typeid(mccs_in_start)};	
+	if (orders) iports_MCCS.push_back(typeid(mccs_in_order));
 	//output ports
 	dynamic::modeling::Ports oports_MCCS = {typeid(mccs_out_mat_prepared), typeid(mccs_out_end)};
 	//Submodels
 	dynamic::modeling::Models submodels_MCCS = {control1, IH};
 	//EICs
 	dynamic::modeling::EICs eics_MCCS = {dynamic::translate::make_EIC<mccs_in_start, Control_defs::startIn>("control1")};			//no external input
+	if (orders) eics_MCCS.push_back(dynamic::translate::make_EIC<mccs_in_order, Control_defs::orderIn>("control1"));
 	//EOCs
 	dynamic::modeling::EOCs eocs_MCCS = {dynamic::translate::make_EOC<Control_defs::matPreparedOut, mccs_out_mat_prepared>("control1"),
 			dynamic::translate::make_EOC<Control_defs::endOut, mccs_out_end>("control1")};
@@ -152,7 +317,14 @@ int main (int argc, char **argv){
 	dynamic::modeling::EOCs eocs_TOP = {dynamic::translate::make_EOC<mccs_out_mat_prepared, top_out_mat_prepared>("MCCS"),
 			dynamic::translate::make_EOC<mccs_out_end, top_out_end>("MCCS")};
 	//ICs
-	dynamic::modeling::ICs ics_TOP = {dynamic::translate::make_IC<iestream_input_defs<int>::out, mccs_in_start>("input_reader_main_start", "MCCS")};
+	dynamic::modeling::ICs ics_TOP;
+	if (orders){
+		ics_TOP = {dynamic::translate::make_IC<iestream_input_defs<Order_t>::out, mccs_in_order>("input_reader_main_start", "MCCS")};
+	} else if (!generate){
+		ics_TOP = {dynamic::translate::make_IC<iestream_input_defs<int>::out, mccs_in_start>("input_reader_main_start", "MCCS")};
+	} else {
+		ics_TOP = {dynamic::translate::make_IC<Generator_defs::startOut, mccs_in_start>("generator_main_start", "MCCS")};
+	}
 	/***** Create an instance of the TOP model *****/
 	/* The parameters of the method are the name of the coupled model (i.e. “TOP”), and all the components 
 	 * we have defined in the following order: submodels_TOP, iports_TOP, oports_TOP, eics_TOP, eocs_TOP, ics_TOP
@@ -164,16 +336,24 @@ int main (int argc, char **argv){
 	
 	/***** (6) *****/
 	/*************** Loggers *******************/
-	static ofstream out_messages("../simulation_results/MCCS_main_test_output_messages.txt");//the output file to log messages
+	static unique_ptr<ostream> out_messages, out_state, out_snapshots;		//the output files to log messages, states and snapshots
+	if (compressed_logs){
+		if (log_profile <= LOG_MESSAGES) out_messages.reset(new Chunked_Log_Stream("../simulation_results/MCCS_main_test_output_messages.mclog"));
+		if (log_profile == LOG_FULL) out_state.reset(new Chunked_Log_Stream("../simulation_results/MCCS_main_test_output_state.mclog"));
+		if (snapshots) out_snapshots.reset(new Chunked_Log_Stream("../simulation_results/MCCS_main_test_output_snapshots.mclog"));
+	} else {
+		if (log_profile <= LOG_MESSAGES) out_messages.reset(new ofstream("../simulation_results/MCCS_main_test_output_messages.txt"));
+		if (log_profile == LOG_FULL) out_state.reset(new ofstream("../simulation_results/MCCS_main_test_output_state.txt"));
+		if (snapshots) out_snapshots.reset(new ofstream("../simulation_results/MCCS_main_test_output_snapshots.txt"));
+	}
 	struct oss_sink_messages{
 		static ostream& sink(){
-			return out_messages;
+			return *out_messages;
 		}
 	};
-	static ofstream out_state("../simulation_results/MCCS_main_test_output_state.txt");//the output file to log states
 		struct oss_sink_state{
 			static ostream& sink(){
-				return out_state;
+				return *out_state;
 		}
 	};
 	
@@ -185,13 +365,113 @@ int main (int argc, char **argv){
 	dynamic::logger::formatter<TIME>, oss_sink_messages>;
 	using global_time_sta = logger::logger<logger::logger_global_time,
 	dynamic::logger::formatter<TIME>, oss_sink_state>;
-	using logger_top = logger::multilogger<state, log_messages, global_time_mes,
+	using logger_all = logger::multilogger<state, log_messages, global_time_mes,
 	global_time_sta>;
+	using logger_top = MCCS_PROFILED_LOGGER(logger_all);
+	using logger_messages = logger::multilogger<log_messages, global_time_mes>;
+	using logger_messages_only = Profile_Logger<MCCS_PROFILED_LOGGER(logger_messages), false, true>;
 	
 	
 	/***** (7) *****/
 	/************** Runner call ************************/
-	dynamic::engine::runner<NDTime, logger_top> r(TOP, {0});	// Name of the TOP model, initial time ("TOP", 0)
-	r.run_until(NDTime("05:00:00:000"));			//alternatively, run_until_passivate();
-	return 0;
+	//the run is instantiated with the logger of each profile, so that the profiles without logs build no log strings
+	auto simulate = [&](auto logger_type) -> int{
+		using logger_run = typename decltype(logger_type)::type;
+		NDTime start = NDTime("00:00:00:000");
+		Checkpointer<TIME> checkpointer(TOP);
+		if (!restore_path.empty() && !checkpointer.restore(restore_path, start)){		//continue from the checkpoint time
+			cout << "Invalid checkpoint " << restore_path << " for this model and input" << endl;
+			return 1;
+		}
+		MCCS_Runner<NDTime, logger_run> r(TOP, start);	// Name of the TOP model, initial time ("TOP", 0)
+		Real_Time_Report pacing_report;
+		if (real_time) r.pace(make_shared<Real_Time_Pacer<TIME>>(pacing, &pacing_report));
+		shared_ptr<MCCS_Statistics<TIME>> statistics;
+		shared_ptr<MCCS_Cycle_Times<TIME>> cycle_times;
+		if (stats){
+			statistics = make_shared<MCCS_Statistics<TIME>>();
+			statistics->watch_control(control1);
+			statistics->watch_storage(storage1);
+			statistics->watch_handling(handling1);
+			statistics->count_port<top_out_mat_prepared>("matPreparedOut");
+			statistics->count_port<top_out_end>("endOut");
+			r.attach(statistics);
+			cycle_times = make_shared<MCCS_Cycle_Times<TIME>>();
+			cycle_times->watch_control(control1);
+			r.attach(cycle_times);
+		}
+		shared_ptr<MCCS_Snapshots<TIME>> snapshot_log;
+		if (snapshots){
+			snapshot_log = make_shared<MCCS_Snapshots<TIME>>(*out_snapshots, snapshot_period);
+			snapshot_log->watch_cells(TOP);
+			r.attach(snapshot_log);
+		}
+		vector<shared_ptr<Stop_Condition<TIME>>> stop_conditions;
+		if (stop_after_end >= 0) stop_conditions.push_back(make_shared<Stop_After_Messages<TIME, top_out_end>>(stop_after_end));
+		if (stop_after_prepared >= 0){
+			auto control = dynamic_pointer_cast<Control<TIME>>(control1);
+			stop_conditions.push_back(make_shared<Stop_When<TIME>>([control, stop_after_prepared](){
+				return control->state.num_prepared >= stop_after_prepared; }));
+		}
+		if (stop_when_idle) stop_conditions.push_back(make_shared<Stop_When_Idle<TIME>>());
+		shared_ptr<Steady_State_Stop<TIME, top_out_mat_prepared>> steady;
+		if (steady_state){
+			steady = make_shared<Steady_State_Stop<TIME, top_out_mat_prepared>>(steady_interval, steady_plan);
+			stop_conditions.push_back(steady);
+		}
+		shared_ptr<Stop_Condition<TIME>> stop = (stop_conditions.empty()) ? nullptr : Stop_Any<TIME>(stop_conditions);
+		auto run_begin = chrono::steady_clock::now();
+		if (!checkpoint_path.empty()){
+			//a full checkpoint, then the models changed in each period, then the final states
+			for (NDTime next = start + checkpoint_period; next < horizon && !r.stopped(); next = next + checkpoint_period){
+				r.run_until(next, stop);
+				checkpointer.save(checkpoint_path, r.last());
+			}
+		}
+		if (!r.stopped()) r.run_until(horizon, stop);			//alternatively, run_until_passivate();
+		double run_seconds = chrono::duration<double>(chrono::steady_clock::now() - run_begin).count();
+		NDTime end = (r.stopped()) ? r.last() : horizon;		//statistics up to the stop
+		if (r.stopped()) cout << "Stopped at " << end << endl;
+		if (snapshots) snapshot_log->finish((r.stopped()) ? r.next() : horizon);
+		if (real_time) pacing_report.print(cout, pacing);
+		if (steady_state) steady->print(cout);
+		if (orders){
+			auto control = dynamic_pointer_cast<Control<TIME>>(control1);
+			cout << "Orders (" << sequencing_policy_name(sequencing) << "): " << control->state.orders_done << " done, " <<
+				control->state.orders.size() << " waiting, mean flow time " << control->mean_flow_time() << " s, mean tardiness " <<
+				control->mean_tardiness() << " s, " << control->state.late << " late" << endl;
+		}
+		if (!checkpoint_path.empty() && !checkpointer.save(checkpoint_path, r.last())){
+			cout << "Could not write the checkpoint " << checkpoint_path << endl;
+			return 1;
+		}
+	
+		if (log_profile == LOG_SUMMARY){
+			cout << r.steps() << " steps in " << run_seconds << " s (" << ((run_seconds > 0) ? r.steps()/run_seconds : 0.0) <<
+				" steps per second)" << endl;
+		}
+		if (stats){
+			statistics->print_summary(cout, time_to_seconds(end));
+			ofstream out_statistics("../simulation_results/MCCS_main_statistics.json");
+			statistics->print_json(out_statistics, time_to_seconds(end));
+			cycle_times->print_summary(cout);
+			ofstream out_cycle_times("../simulation_results/MCCS_main_cycle_times.json");
+			cycle_times->print_json(out_cycle_times);
+		}
+#ifdef MCCS_PROFILING
+		Profiler::instance().name_instances<TIME>(TOP);
+		Profiler::instance().print_report(cout);
+		ofstream out_trace("../simulation_results/MCCS_main_profile_trace.json");
+		Profiler::instance().print_trace(out_trace);
+#endif
+		return 0;
+	};
+	switch (log_profile){
+	case LOG_FULL:
+		return simulate(Logger_Type<logger_top>());
+	case LOG_MESSAGES:
+		return simulate(Logger_Type<logger_messages_only>());
+	default:
+		return simulate(Logger_Type<Quiet_Logger>());
+	}
 }
\ No newline at end of file
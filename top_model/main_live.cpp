@@ -0,0 +1,195 @@
+//Cadmium Simulator headers
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+//Time class header
+#include <NDTime.hpp>
+
+//Atomic model headers
+#include "../atomics/control.hpp"
+#include "../atomics/storage.hpp"
+#include "../atomics/handling.hpp"
+#include "../atomics/live_input.hpp"
+
+//Runner fed by a live producer, and online statistics
+#include "../engine/live_ingestion.hpp"
+#include "../engine/mccs_runner.hpp"
+#include "../engine/real_time.hpp"
+#include "../engine/statistics.hpp"
+
+#include "../data_structures/timing.hpp"
+
+//C++ libraries
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Namespaces
+using namespace std;
+using namespace cadmium;
+using TIME = NDTime;
+
+
+/***** (1) *****/
+//ports for the TOP model
+struct top_out_end: public out_port<int>{};
+struct top_out_mat_prepared: public out_port<int>{};
+//ports for the Inventory handler
+struct ih_in_load: public in_port<Message_t>{};
+struct ih_in_prep: public in_port<Message_t>{};
+struct ih_out_loaded: public out_port<Message_t>{};
+struct ih_out_unloaded: public out_port<Message_t>{};
+//ports for the MCCS
+struct mccs_in_start: public in_port<int>{};
+struct mccs_out_mat_prepared: public out_port<int>{};
+struct mccs_out_end: public out_port<int>{};
+
+//Prints the outputs of the cell as they happen
+class Live_Printer : public Run_Observer<TIME>{
+public:
+	void outputs(const TIME& t, const dynamic::message_bags& top_outbox) override{
+		print<top_out_mat_prepared>(t, top_outbox, "matPreparedOut");
+		print<top_out_end>(t, top_outbox, "endOut");
+	}
+
+private:
+	template<typename PORT>
+	void print(const TIME& t, const dynamic::message_bags& top_outbox, const char* name){
+		auto bag = top_outbox.find(type_index(typeid(PORT)));
+		if (bag == top_outbox.end()) return;
+		for (int m : boost::any_cast<const message_bag<PORT>&>(bag->second).messages){
+			cout << t << " " << name << " " << m << endl;
+		}
+	}
+};
+
+
+/***** (2) *****/
+/***** Create the main function *****/
+//Runs the MCCS cell in step with the wall clock, fed by start requests from a live producer (see engine/live_ingestion.hpp)
+int main (int argc, char **argv){
+	vector<string> args(argv, argv + argc);
+	//removes the option "name" (followed by n_values values) from args; false if it is not there
+	auto take_option = [&args](const string& name, size_t n_values, vector<string>& values){
+		for (size_t i = 1; i + n_values < args.size(); i++){
+			if (args[i] == name){
+				values.assign(args.begin() + i + 1, args.begin() + i + 1 + n_values);
+				args.erase(args.begin() + i, args.begin() + i + 1 + n_values);
+				return true;
+			}
+		}
+		return false;
+	};
+	vector<string> values;
+
+	//optional "--config path": processing times of the cell (see data_structures/timing.hpp)
+	MCCS_config mccs_config;
+	if (take_option("--config", 1, values) && !mccs_config.read(values[0].c_str())){
+		cout << "Invalid configuration file " << values[0] << endl;
+		return 1;
+	}
+	//optional "--poll hh:mm:ss:mmm": simulated time between two looks at the queue (100 ms by default)
+	TIME poll = TIME("00:00:00:100");
+	if (take_option("--poll", 1, values)) poll = TIME(values[0]);
+	//optional "--until hh:mm:ss:mmm": the run also ends when the producer closes the pipe
+	TIME horizon = TIME("05:00:00:000");
+	if (take_option("--until", 1, values)) horizon = TIME(values[0]);
+	//optional "--scale X" and "--core N": simulated seconds per wall-clock second, core of the simulation thread
+	//(see engine/real_time.hpp)
+	Real_Time_Options pacing;
+	if (take_option("--scale", 1, values)) pacing.scale = stod(values[0]);
+	if (take_option("--core", 1, values)) pacing.core = stoi(values[0]);
+	//source: "--socket path" (Unix socket), "--pipe path" (named pipe) or standard input
+	string socket_path, pipe_path = "-";
+	if (take_option("--socket", 1, values)) socket_path = values[0];
+	if (take_option("--pipe", 1, values)) pipe_path = values[0];
+
+	if (args.size() != 1){
+		cout << "Wrong parameters. The program must be invoked as: ";
+		cout << argv[0] << " [--socket path | --pipe path] [--poll hh:mm:ss:mmm] [--until hh:mm:ss:mmm]" << endl;
+		cout << "                 [--scale X] [--core N] [--config path]" << endl;
+		cout << "Start requests are read one per line (the batch size) from standard input by default" << endl;
+		return 1;
+	}
+
+
+	/***** (3) *****/
+	/***** Live feed and its ingestion thread *****/
+	auto feed = make_shared<Live_Feed>();
+	Live_Ingestion ingestion(feed);
+	bool started = (socket_path.empty()) ? ingestion.start_stream(pipe_path) : ingestion.start_socket(socket_path);
+	if (!started){
+		cout << "Cannot open " << ((socket_path.empty()) ? pipe_path : socket_path) << endl;
+		return 1;
+	}
+
+
+	/***** (4) *****/
+	/***** MCCS cell fed by the live input *****/
+	shared_ptr<dynamic::modeling::model> live_input = dynamic::translate::make_dynamic_atomic_model
+		<Live_Input, TIME, shared_ptr<Live_Feed>, TIME>("live_input", shared_ptr<Live_Feed>(feed), TIME(poll));
+	shared_ptr<dynamic::modeling::model> handling1 = dynamic::translate::make_dynamic_atomic_model
+		<Handling, TIME, Timing, map<int, Timing>>("handling1", mccs_config.handling_timing("handling1"),
+		mccs_config.handling_product_timings("handling1"));
+	shared_ptr<dynamic::modeling::model> storage1 = dynamic::translate::make_dynamic_atomic_model
+		<Storage, TIME, Timing, map<int, Timing>>("storage1", mccs_config.storage_timing("storage1"),
+		mccs_config.storage_product_timings("storage1"));
+	shared_ptr<dynamic::modeling::model> control1 = dynamic::translate::make_dynamic_atomic_model<Control, TIME>("control1");
+
+	shared_ptr<dynamic::modeling::coupled<TIME>> IH = make_shared<dynamic::modeling::coupled<TIME>>("IH",
+		dynamic::modeling::Models{storage1, handling1},
+		dynamic::modeling::Ports{typeid(ih_in_load), typeid(ih_in_prep)},
+		dynamic::modeling::Ports{typeid(ih_out_loaded), typeid(ih_out_unloaded)},
+		dynamic::modeling::EICs{dynamic::translate::make_EIC<ih_in_load, Storage_defs::loadIn>("storage1"),
+			dynamic::translate::make_EIC<ih_in_prep, Handling_defs::prepIn>("handling1")},
+		dynamic::modeling::EOCs{dynamic::translate::make_EOC<Storage_defs::loadedOut, ih_out_loaded>("storage1"),
+			dynamic::translate::make_EOC<Storage_defs::unloadedOut, ih_out_unloaded>("storage1")},
+		dynamic::modeling::ICs{dynamic::translate::make_IC<Handling_defs::unloadOut, Storage_defs::unloadIn>("handling1", "storage1")});
+
+	shared_ptr<dynamic::modeling::coupled<TIME>> MCCS = make_shared<dynamic::modeling::coupled<TIME>>("MCCS",
+		dynamic::modeling::Models{control1, IH},
+		dynamic::modeling::Ports{typeid(mccs_in_start)},
+		dynamic::modeling::Ports{typeid(mccs_out_mat_prepared), typeid(mccs_out_end)},
+		dynamic::modeling::EICs{dynamic::translate::make_EIC<mccs_in_start, Control_defs::startIn>("control1")},
+		dynamic::modeling::EOCs{dynamic::translate::make_EOC<Control_defs::matPreparedOut, mccs_out_mat_prepared>("control1"),
+			dynamic::translate::make_EOC<Control_defs::endOut, mccs_out_end>("control1")},
+		dynamic::modeling::ICs{dynamic::translate::make_IC<Control_defs::loadOut, ih_in_load>("control1", "IH"),
+			dynamic::translate::make_IC<Control_defs::prepOut, ih_in_prep>("control1", "IH"),
+			dynamic::translate::make_IC<ih_out_loaded, Control_defs::loadedIn>("IH", "control1"),
+			dynamic::translate::make_IC<ih_out_unloaded, Control_defs::unloadedIn>("IH", "control1")});
+
+	shared_ptr<dynamic::modeling::coupled<TIME>> TOP = make_shared<dynamic::modeling::coupled<TIME>>("TOP",
+		dynamic::modeling::Models{MCCS, live_input},
+		dynamic::modeling::Ports{},
+		dynamic::modeling::Ports{typeid(top_out_mat_prepared), typeid(top_out_end)},
+		dynamic::modeling::EICs{},
+		dynamic::modeling::EOCs{dynamic::translate::make_EOC<mccs_out_mat_prepared, top_out_mat_prepared>("MCCS"),
+			dynamic::translate::make_EOC<mccs_out_end, top_out_end>("MCCS")},
+		dynamic::modeling::ICs{dynamic::translate::make_IC<Live_Input_defs::startOut, mccs_in_start>("live_input", "MCCS")});
+
+
+	/***** (5) *****/
+	/***** Run in step with the wall clock *****/
+	MCCS_Runner<TIME, logger::not_logger> r(TOP, TIME("00:00:00:000"));
+	Real_Time_Report pacing_report;
+	r.pace(make_shared<Real_Time_Pacer<TIME>>(pacing, &pacing_report));
+	auto statistics = make_shared<MCCS_Statistics<TIME>>();
+	statistics->watch_control(control1);
+	statistics->watch_storage(storage1);
+	statistics->watch_handling(handling1);
+	statistics->count_port<top_out_mat_prepared>("matPreparedOut");
+	statistics->count_port<top_out_end>("endOut");
+	r.attach(statistics);
+	r.attach(make_shared<Live_Printer>());
+	r.run_until(horizon);				//or until the producer has closed the input and the cell is idle
+	ingestion.stop();
+
+	cout << "Ended at " << r.last() << endl;
+	print_live_latency(cout, *feed);
+	pacing_report.print(cout, pacing);
+	statistics->print_summary(cout, time_to_seconds(r.last()));
+	return 0;
+}
\ No newline at end of file
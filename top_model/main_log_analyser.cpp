@@ -0,0 +1,61 @@
+//Log analyser
+#include "../engine/log_analyser.hpp"
+
+//C++ libraries
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Namespaces
+using namespace std;
+
+
+/***** (1) *****/
+/***** Create the main function *****/
+//Prints the per-port message counts, loadOut -> unloadedIn times and phase residencies of the logs of a run
+int main (int argc, char **argv){
+	vector<string> args(argv, argv + argc);
+	//removes the option "name" (followed by n_values values) from args; false if it is not there
+	auto take_option = [&args](const string& name, size_t n_values, vector<string>& values){
+		for (size_t i = 1; i + n_values < args.size(); i++){
+			if (args[i] == name){
+				values.assign(args.begin() + i + 1, args.begin() + i + 1 + n_values);
+				args.erase(args.begin() + i, args.begin() + i + 1 + n_values);
+				return true;
+			}
+		}
+		return false;
+	};
+	vector<string> values;
+
+	//optional "--threads N": all the cores by default
+	int threads = (int)thread::hardware_concurrency();
+	if (take_option("--threads", 1, values)) threads = atoi(values[0].c_str());
+	//optional "--json path": also saves the aggregates as JSON
+	string json_path;
+	if (take_option("--json", 1, values)) json_path = values[0];
+
+	if (args.size() < 2 || threads < 1){
+		cout << "Wrong parameters. The program must be invoked as: ";
+		cout << argv[0] << " paths to the messages and/or state logs (.txt or .mclog) [--threads N] [--json path]" << endl;
+		return 1;
+	}
+	Log_Analysis a = analyse_logs(vector<string>(args.begin() + 1, args.end()), (unsigned)threads);
+	if (!a.error.empty()){
+		cerr << a.error << endl;
+		return 1;
+	}
+
+
+	/***** (2) *****/
+	/***** Aggregates *****/
+	a.print(cout);
+	if (!json_path.empty()){
+		ofstream json(json_path);
+		a.print_json(json);
+		cout << "JSON saved in " << json_path << endl;
+	}
+	return 0;
+}
\ No newline at end of file
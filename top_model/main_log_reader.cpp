@@ -0,0 +1,68 @@
+//Chunked log reader
+#include "../engine/chunked_log.hpp"
+
+//C++ libraries
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+//Namespaces
+using namespace std;
+
+
+/***** (1) *****/
+/***** Create the main function *****/
+//Prints the steps of a chunked log (written with "./MCCS ... --compressed-logs") in a range of simulated times
+int main (int argc, char **argv){
+	vector<string> args(argv, argv + argc);
+	//removes the option "name" (followed by n_values values) from args; false if it is not there
+	auto take_option = [&args](const string& name, size_t n_values, vector<string>& values){
+		for (size_t i = 1; i + n_values < args.size(); i++){
+			if (args[i] == name){
+				values.assign(args.begin() + i + 1, args.begin() + i + 1 + n_values);
+				args.erase(args.begin() + i, args.begin() + i + 1 + n_values);
+				return true;
+			}
+		}
+		return false;
+	};
+	vector<string> values;
+
+	//optional "--from hh:mm:ss:mmm" and "--to hh:mm:ss:mmm": the whole log by default
+	long long from = 0, to = numeric_limits<long long>::max();
+	if (take_option("--from", 1, values)) from = log_time_line_ms(values[0].data(), values[0].size());
+	if (take_option("--to", 1, values)) to = log_time_line_ms(values[0].data(), values[0].size());
+	//optional "--index": lists the chunks instead
+	bool list = take_option("--index", 0, values);
+
+	if (args.size() != 2 || from < 0 || to < 0){
+		cout << "Wrong parameters. The program must be invoked as: ";
+		cout << argv[0] << " path to the .mclog file [--from hh:mm:ss:mmm] [--to hh:mm:ss:mmm] [--index]" << endl;
+		return 1;
+	}
+	Chunked_Log_Reader reader;
+	if (!reader.open(args[1])){
+		cerr << reader.error << endl;
+		return 1;
+	}
+
+
+	/***** (2) *****/
+	/***** Index or steps of the range (the figures of the query go to the error output) *****/
+	if (list){
+		long long raw = 0, compressed = 0;
+		cout << "first_ms last_ms offset compressed_bytes raw_bytes" << endl;
+		for (auto& e : reader.index){
+			cout << e.first_ms << " " << e.last_ms << " " << e.offset << " " << e.compressed_bytes << " " << e.raw_bytes << endl;
+			raw += e.raw_bytes;
+			compressed += e.compressed_bytes;
+		}
+		cout << reader.index.size() << " chunks, " << raw/1024 << " KiB of text in " << compressed/1024 << " KiB" << endl;
+		return 0;
+	}
+	Log_Query_Report report = reader.read_range(from, to, cout);
+	cout.flush();
+	report.print(cerr, reader.index.size());
+	return 0;
+}
\ No newline at end of file
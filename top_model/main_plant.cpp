@@ -0,0 +1,148 @@
+//Cadmium Simulator headers
+#include <cadmium/modeling/dynamic_model.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+
+//Time class header
+#include <NDTime.hpp>
+
+//Plant built from its description, runner and online statistics
+#include "../engine/model_builder.hpp"
+#include "../engine/mccs_runner.hpp"
+#include "../engine/statistics.hpp"
+#include "../engine/snapshot_logger.hpp"
+#include "../engine/parallel_step.hpp"
+
+//C++ libraries
+#include <iostream>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+//Namespaces
+using namespace std;
+using namespace cadmium;
+using TIME = NDTime;
+
+
+/***** (1) *****/
+/***** Create the main function *****/
+//Builds the plant described by an XML file (see engine/model_builder.hpp) and runs it without logs
+int main (int argc, char **argv){
+	vector<string> args(argv, argv + argc);
+	//removes the option "name" (followed by n_values values) from args; false if it is not there
+	auto take_option = [&args](const string& name, size_t n_values, vector<string>& values){
+		for (size_t i = 1; i + n_values < args.size(); i++){
+			if (args[i] == name){
+				values.assign(args.begin() + i + 1, args.begin() + i + 1 + n_values);
+				args.erase(args.begin() + i, args.begin() + i + 1 + n_values);
+				return true;
+			}
+		}
+		return false;
+	};
+	vector<string> values;
+
+	//optional "--lines N": overrides the number of lines of the description
+	long long lines = 0;
+	if (take_option("--lines", 1, values)) lines = stoll(values[0]);
+	//optional "--dispatch none|round_robin|least_wip|earliest_completion": overrides the dispatcher of the description
+	string dispatch;
+	if (take_option("--dispatch", 1, values)) dispatch = values[0];
+	//optional "--until hh:mm:ss:mmm": simulation horizon
+	TIME horizon = TIME("05:00:00:000");
+	if (take_option("--until", 1, values)) horizon = TIME(values[0]);
+	//optional "--stats": utilisation of every Storage/Handling and WIP of every Control (cost grows with the plant)
+	bool stats = take_option("--stats", 0, values);
+	//optional "--snapshot-every hh:mm:ss:mmm": the full states of every control, storage and handling each period of
+	//simulated time, in simulation_results/MCCS_plant_snapshots.txt (see engine/snapshot_logger.hpp)
+	TIME snapshot_period;
+	bool snapshots = take_option("--snapshot-every", 1, values);
+	if (snapshots) snapshot_period = TIME(values[0]);
+	//optional "--parallel N [--parallel-threshold K]": the output and transition functions of the steps with at least
+	//K imminent models (64 by default) run on N threads, with the results of the sequential run (see engine/parallel_step.hpp)
+	unsigned parallel_threads = 0;
+	size_t parallel_threshold = 64;
+	if (take_option("--parallel", 1, values)) parallel_threads = stoul(values[0]);
+	if (take_option("--parallel-threshold", 1, values)) parallel_threshold = stoull(values[0]);
+
+	if (args.size() != 2){
+		cout << "Wrong parameters. The program must be invoked as: ";
+		cout << argv[0] << " path to the plant description [--lines N] [--dispatch policy] [--until hh:mm:ss:mmm] [--stats]";
+		cout << " [--snapshot-every hh:mm:ss:mmm] [--parallel N [--parallel-threshold K]]" << endl;
+		return 1;
+	}
+	Plant_description plant;
+	if (!plant.read(args[1].c_str())){
+		cout << "Invalid plant description " << args[1] << ": " << plant.error << endl;
+		return 1;
+	}
+	if (lines > 0) plant.lines = lines;
+	if (!dispatch.empty() && !read_dispatch_policy(dispatch, plant.dispatch)){
+		cout << "Unknown dispatch policy " << dispatch << endl;
+		return 1;
+	}
+
+
+	/***** (2) *****/
+	/***** Build *****/
+	Plant_build_report report;
+	shared_ptr<dynamic::modeling::coupled<TIME>> TOP = build_plant<TIME>(plant, &report);
+	cout << "Plant " << plant.name << ": " << plant.lines << " lines of " << plant.stages.size() << " stages";
+	if (plant.dispatch != DISPATCH_NONE) cout << ", dispatch " << dispatch_policy_name(plant.dispatch);
+	cout << endl;
+	report.print(cout);
+
+
+	/***** (3) *****/
+	/***** Run *****/
+	//the parallel run has its own simulators, picked by the logger type
+	auto simulate = [&](auto logger_type){
+		using logger_run = typename decltype(logger_type)::type;
+		auto begin = chrono::steady_clock::now();
+		MCCS_Runner<TIME, logger_run> r(TOP, TIME("00:00:00:000"));
+		shared_ptr<Parallel_Steps<TIME>> parallel;
+		if constexpr (is_parallel_logger<logger_run>::value){
+			parallel = make_shared<Parallel_Steps<TIME>>(TOP, parallel_threads, parallel_threshold);
+			r.execute(parallel);
+		}
+		auto statistics = make_shared<MCCS_Statistics<TIME>>();
+		statistics->count_port<Plant_defs::out_mat_prepared>("matPreparedOut");
+		statistics->count_port<Plant_defs::out_end>("endOut");
+		if (stats){
+			function<void(shared_ptr<dynamic::modeling::model>)> watch = [&](shared_ptr<dynamic::modeling::model> model){
+				auto coupled = dynamic_pointer_cast<dynamic::modeling::coupled<TIME>>(model);
+				if (coupled){
+					for (auto& m : coupled->_models) watch(m);
+				} else if (dynamic_pointer_cast<Control<TIME>>(model)){
+					statistics->watch_control(model);
+				} else if (dynamic_pointer_cast<Storage<TIME>>(model)){
+					statistics->watch_storage(model);
+				} else if (dynamic_pointer_cast<Handling<TIME>>(model)){
+					statistics->watch_handling(model);
+				}
+			};
+			watch(TOP);
+		}
+		r.attach(statistics);
+		ofstream out_snapshots;
+		shared_ptr<MCCS_Snapshots<TIME>> snapshot_log;
+		if (snapshots){
+			out_snapshots.open("../simulation_results/MCCS_plant_snapshots.txt");
+			snapshot_log = make_shared<MCCS_Snapshots<TIME>>(out_snapshots, snapshot_period);
+			snapshot_log->watch_cells(TOP);
+			r.attach(snapshot_log);
+		}
+		r.run_until(horizon);
+		if (snapshots) snapshot_log->finish(horizon);
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		cout << "Simulated in " << seconds << " s" << endl;
+		if (parallel) parallel->print(cout);
+		statistics->print_summary(cout, time_to_seconds(horizon));
+	};
+	if (parallel_threads > 0) simulate(Logger_Type<Parallel_Logger<logger::not_logger>>());
+	else simulate(Logger_Type<logger::not_logger>());
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+//Time class header
+#include <NDTime.hpp>
+
+//Replications of plants built from their description
+#include "../engine/replications.hpp"
+
+//C++ libraries
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Namespaces
+using namespace std;
+using TIME = NDTime;
+
+
+/***** (1) *****/
+/***** Create the main function *****/
+//Replicates one or more scenarios until the confidence interval of a metric is narrow enough (see engine/replications.hpp).
+//A scenario is a plant description (.xml), or every point of a parameter grid (see engine/sweep.hpp).
+int main (int argc, char **argv){
+	vector<string> args(argv, argv + argc);
+	//removes the option "name" (followed by n_values values) from args; false if it is not there
+	auto take_option = [&args](const string& name, size_t n_values, vector<string>& values){
+		for (size_t i = 1; i + n_values < args.size(); i++){
+			if (args[i] == name){
+				values.assign(args.begin() + i + 1, args.begin() + i + 1 + n_values);
+				args.erase(args.begin() + i, args.begin() + i + 1 + n_values);
+				return true;
+			}
+		}
+		return false;
+	};
+	vector<string> values;
+
+	Replication_Plan plan;
+	bool valid = true;
+	if (take_option("--metric", 1, values)) valid = plan.set_metric(values[0]);
+	if (take_option("--half-width", 1, values)) plan.half_width = stod(values[0]);
+	if (take_option("--relative", 1, values)) plan.relative_half_width = stod(values[0]);
+	if (take_option("--confidence", 1, values)) plan.confidence = stod(values[0]);
+	if (take_option("--min", 1, values)) plan.min_replications = stoll(values[0]);
+	if (take_option("--max", 1, values)) plan.max_replications = stoll(values[0]);
+	if (take_option("--batch", 1, values)) plan.batch = stoul(values[0]);
+	if (take_option("--until", 1, values)) plan.until = values[0];
+	if (take_option("--independent", 0, values)) plan.common_random_numbers = false;
+	valid = valid && plan.confidence > 0 && plan.confidence < 1 && plan.min_replications >= 2 &&
+		plan.max_replications >= plan.min_replications;
+
+	if (args.size() < 2 || !valid){
+		cout << "Wrong parameters. The program must be invoked as: ";
+		cout << argv[0] << " plant description or parameter grid... [--metric makespan|cycle_time|throughput|wip]" <<
+			" [--half-width X | --relative X] [--confidence C] [--min N] [--max N] [--batch N] [--until hh:mm:ss:mmm]" <<
+			" [--independent]" << endl;
+		return 1;
+	}
+
+	vector<Plant_description> scenarios;
+	vector<string> names;
+	for (size_t a = 1; a < args.size(); a++){
+		const string& path = args[a];
+		if (path.size() > 4 && path.compare(path.size() - 4, 4, ".xml") == 0){
+			Plant_description plant;
+			if (!plant.read(path.c_str())){
+				cout << "Invalid plant description " << path << ": " << plant.error << endl;
+				return 1;
+			}
+			scenarios.push_back(plant);
+			names.push_back(plant.name);
+			continue;
+		}
+		Sweep_Grid grid;
+		Plant_description base;
+		if (!grid.read(path.c_str()) || !base.read(grid.plant_path.c_str())){
+			cout << "Invalid parameter grid " << path << ": " << ((grid.error.empty()) ? base.error : grid.error) << endl;
+			return 1;
+		}
+		for (auto& point : grid.points()){
+			Plant_description plant = base;
+			string name;
+			for (size_t i = 0; i < grid.axes.size(); i++){
+				if (!sweep_apply(plant, grid.axes[i].first, point[i])){
+					cout << "Invalid " << grid.axes[i].first << " " << point[i] << " in " << path << endl;
+					return 1;
+				}
+				name += ((i) ? "," : "") + grid.axes[i].first + "=" + point[i];
+			}
+			scenarios.push_back(plant);
+			names.push_back((name.empty()) ? plant.name : name);
+		}
+	}
+
+
+	/***** (2) *****/
+	/***** Replicate *****/
+	Replication_Report report = run_replications<TIME>(scenarios, names, plan);
+	if (!report.error.empty()){
+		cout << "Replication failed: " << report.error << endl;
+		return 1;
+	}
+	report.print(cout, plan);
+	return (report.converged) ? 0 : 2;
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+//Time class header
+#include <NDTime.hpp>
+
+//Parameter sweep over plants built from their description
+#include "../engine/sweep.hpp"
+
+//C++ libraries
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Namespaces
+using namespace std;
+using TIME = NDTime;
+
+
+/***** (1) *****/
+/***** Create the main function *****/
+//Runs every point of a parameter grid (see engine/sweep.hpp), reusing the results cached by previous sweeps
+int main (int argc, char **argv){
+	vector<string> args(argv, argv + argc);
+	//removes the option "name" (followed by n_values values) from args; false if it is not there
+	auto take_option = [&args](const string& name, size_t n_values, vector<string>& values){
+		for (size_t i = 1; i + n_values < args.size(); i++){
+			if (args[i] == name){
+				values.assign(args.begin() + i + 1, args.begin() + i + 1 + n_values);
+				args.erase(args.begin() + i, args.begin() + i + 1 + n_values);
+				return true;
+			}
+		}
+		return false;
+	};
+	vector<string> values;
+
+	//optional "--threads N": size of the pool (all the cores by default)
+	unsigned threads = thread::hardware_concurrency();
+	if (take_option("--threads", 1, values)) threads = stoul(values[0]);
+	//optional "--cache dir" (empty to disable) and "--out prefix" of the .csv and .json tables
+	string cache_dir = "../simulation_results/sweep_cache";
+	string out_prefix = "../simulation_results/MCCS_sweep";
+	if (take_option("--cache", 1, values)) cache_dir = values[0];
+	if (take_option("--no-cache", 0, values)) cache_dir = "";
+	if (take_option("--out", 1, values)) out_prefix = values[0];
+
+	if (args.size() != 2){
+		cout << "Wrong parameters. The program must be invoked as: ";
+		cout << argv[0] << " path to the parameter grid [--threads N] [--cache dir | --no-cache] [--out prefix]" << endl;
+		return 1;
+	}
+	Sweep_Grid grid;
+	if (!grid.read(args[1].c_str())){
+		cout << "Invalid parameter grid " << args[1] << ": " << grid.error << endl;
+		return 1;
+	}
+
+	auto begin = chrono::steady_clock::now();
+	vector<Sweep_Result> results = run_sweep<TIME>(grid, Sweep_Cache(cache_dir), threads);
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+	size_t cached = 0, failed = 0;
+	for (auto& r : results){
+		if (r.cached) cached++;
+		if (!r.ok) failed++;
+	}
+	cout << results.size() << " points: " << results.size() - cached - failed << " simulated, " << cached << " from the cache, " <<
+		failed << " failed, in " << seconds << " s" << endl;
+	ofstream csv(out_prefix + ".csv");
+	print_sweep_csv(csv, grid, results);
+	ofstream json(out_prefix + ".json");
+	print_sweep_json(json, grid, results);
+	print_sweep_csv(cout, grid, results);
+	return (failed) ? 1 : 0;
+}
\ No newline at end of file